@@ -12,6 +12,7 @@
 #include <cstring>
 #include <filesystem>
 #include <algorithm>
+#include <cmath>
 
 #include "util.hpp"
 #include "keyboard_input.hpp"
@@ -28,6 +29,7 @@
 #include "graphics_pipeline.hpp"
 #include "command_buffer.hpp"
 #include "buffer.hpp"
+#include "memory.hpp"
 #include "config.hpp"
 #include "config_serializer.hpp"
 #include "settings_manager.hpp"
@@ -35,10 +37,16 @@
 #include "renderpass.hpp"
 #include "format.hpp"
 #include "logger.hpp"
+#include "present_latency.hpp"
+#include "chain_profiler.hpp"
+#include "frame_timeline.hpp"
+#include "proc_table.hpp"
+#include "reshade_uniforms.hpp"
 
 #include "effects/effect.hpp"
 #include "effects/effect_reshade.hpp"
 #include "effects/effect_transfer.hpp"
+#include "effects/effect_upscale.hpp"
 #include "effects/builtin/builtin_effects.hpp"
 #include "imgui_overlay.hpp"
 #include "effects/effect_registry.hpp"
@@ -66,7 +74,12 @@ namespace vkBasalt
     std::unordered_map<void*, std::shared_ptr<LogicalDevice>>             deviceMap;
     std::unordered_map<VkSwapchainKHR, std::shared_ptr<LogicalSwapchain>> swapchainMap;
 
+    // next layer's GetProcAddr by dispatch key, read without globalLock, written under it
+    ProcAddrCache<PFN_vkGetInstanceProcAddr> instanceProcAddrCache;
+    ProcAddrCache<PFN_vkGetDeviceProcAddr>   deviceProcAddrCache;
+
     std::mutex globalLock;
+    std::once_flag configsInitFlag;
 #ifdef _GCC_
     using scoped_lock __attribute__((unused)) = std::lock_guard<std::mutex>;
 #else
@@ -87,6 +100,7 @@ namespace vkBasalt
         std::map<std::string, std::string> effectPaths;
         std::string configPath;
         bool initialized = false;
+        uint64_t version = 0;  // Bumped on every rescan, the overlay only copies the lists when it changed
     };
     CachedEffectsData cachedEffects;
 
@@ -109,6 +123,9 @@ namespace vkBasalt
     ResizeDebounceState resizeDebounce;
     constexpr int64_t RESIZE_DEBOUNCE_MS = 200;
 
+    // Effects on/off, starts from enableOnLaunch and is flipped by the toggle key or the overlay
+    bool presentEffect = true;
+
     // Helper for key press with debounce - returns true on key-down edge
     bool handleKeyPress(uint32_t keySymbol, bool& wasPressed)
     {
@@ -174,7 +191,7 @@ namespace vkBasalt
         pLogicalSwapchain->commandBuffersEffect = allocateCommandBuffer(pLogicalDevice, pLogicalSwapchain->imageCount);
         writeCommandBuffers(pLogicalDevice, pLogicalSwapchain->effects,
                            depth.image, depth.imageView, depth.format,
-                           pLogicalSwapchain->commandBuffersEffect);
+                           pLogicalSwapchain->commandBuffersEffect, pLogicalSwapchain->linearDepth.get());
 
         // Allocate and write no-effect command buffers
         pLogicalSwapchain->commandBuffersNoEffect = allocateCommandBuffer(pLogicalDevice, pLogicalSwapchain->imageCount);
@@ -183,18 +200,6 @@ namespace vkBasalt
                            pLogicalSwapchain->commandBuffersNoEffect);
     }
 
-    // Apply modified parameters from overlay to config
-    void applyOverlayParams(LogicalDevice* pLogicalDevice)
-    {
-        // Parameters are already in EffectRegistry (the single source of truth)
-        // Effects read directly from the registry when recreated
-        // This function just logs for debugging
-        if (!pLogicalDevice->imguiOverlay)
-            return;
-
-        Logger::info("Applying parameters from overlay - effects will read from EffectRegistry");
-    }
-
     // Initialize configs: base (vkBasalt.conf) + current (from env/default_config)
     void initConfigs()
     {
@@ -206,6 +211,7 @@ namespace vkBasalt
 
         // Initialize settings manager (single source of truth for settings)
         settingsManager.initialize();
+        presentEffect = settingsManager.getEnableOnLaunch();
 
         // Load base config (vkBasalt.conf) - used for paths, effect definitions
         pBaseConfig = std::make_shared<Config>();
@@ -272,23 +278,16 @@ namespace vkBasalt
     }
 
     // Helper function to get available effects separated by source (uses cache)
-    void getAvailableEffects(Config* pConfig,
-                             std::vector<std::string>& currentConfigEffects,
-                             std::vector<std::string>& defaultConfigEffects,
-                             std::map<std::string, std::string>& effectPaths)
+    // Rescans the available effects into cachedEffects if the config changed or a rescan was requested
+    void refreshAvailableEffects(Config* pConfig)
     {
         // Use cache if available and config hasn't changed
         if (cachedEffects.initialized && cachedEffects.configPath == pConfig->getConfigFilePath())
-        {
-            currentConfigEffects = cachedEffects.currentConfigEffects;
-            defaultConfigEffects = cachedEffects.defaultConfigEffects;
-            effectPaths = cachedEffects.effectPaths;
             return;
-        }
 
-        currentConfigEffects.clear();
-        defaultConfigEffects.clear();
-        effectPaths.clear();
+        std::vector<std::string> currentConfigEffects;
+        std::vector<std::string> defaultConfigEffects;
+        std::map<std::string, std::string> effectPaths;
 
         // Collect all known effect names (to avoid duplicates)
         std::set<std::string> knownEffects;
@@ -354,11 +353,211 @@ namespace vkBasalt
         std::sort(defaultConfigEffects.begin(), defaultConfigEffects.end());
 
         // Update cache
-        cachedEffects.currentConfigEffects = currentConfigEffects;
-        cachedEffects.defaultConfigEffects = defaultConfigEffects;
-        cachedEffects.effectPaths = effectPaths;
+        cachedEffects.currentConfigEffects = std::move(currentConfigEffects);
+        cachedEffects.defaultConfigEffects = std::move(defaultConfigEffects);
+        cachedEffects.effectPaths = std::move(effectPaths);
         cachedEffects.configPath = pConfig->getConfigFilePath();
         cachedEffects.initialized = true;
+        cachedEffects.version++;
+    }
+
+    // Returns why the layer's allocations break the configured VRAM policy, empty if they don't
+    std::string checkVramBudget(LogicalDevice* pLogicalDevice)
+    {
+        VkDeviceSize layerBytes = pLogicalDevice->memoryTracker.getTotalBytes();
+        int          limitMB    = settingsManager.getVramLimitMB();
+        if (limitMB > 0 && layerBytes > static_cast<VkDeviceSize>(limitMB) * 1024 * 1024)
+            return "vkBasalt VRAM limit exceeded (" + std::to_string(layerBytes >> 20) + " MB > " + std::to_string(limitMB) + " MB)";
+
+        VkDeviceSize usage, budget;
+        if (settingsManager.getRespectMemoryBudget() && getDeviceLocalBudget(pLogicalDevice, usage, budget) && usage > budget)
+            return "device memory budget exceeded (" + std::to_string(usage >> 20) + " MB > " + std::to_string(budget >> 20) + " MB)";
+
+        return "";
+    }
+
+    // renderScale < 1 makes the application render at a lower resolution, the final pass upscales to the surface
+    float getRenderScale()
+    {
+        if (!pConfig)
+            return 1.0f;
+        return std::clamp(pConfig->getOption<float>("renderScale", 1.0f), 0.25f, 1.0f);
+    }
+
+    VkExtent2D scaleExtent(VkExtent2D extent, float scale)
+    {
+        return {std::max(1u, (uint32_t) std::lround(extent.width * scale)), std::max(1u, (uint32_t) std::lround(extent.height * scale))};
+    }
+
+    bool isUpscaled(LogicalSwapchain* pLogicalSwapchain)
+    {
+        return pLogicalSwapchain->imageExtent.width != pLogicalSwapchain->outputExtent.width
+               || pLogicalSwapchain->imageExtent.height != pLogicalSwapchain->outputExtent.height;
+    }
+
+    // the effects can't write the swapchain images themselves, the last fake images get copied or upscaled
+    bool needsFinalImages(LogicalDevice* pLogicalDevice, LogicalSwapchain* pLogicalSwapchain)
+    {
+        return !pLogicalDevice->supportsMutableFormat || isUpscaled(pLogicalSwapchain);
+    }
+
+    // copies inputImages into the swapchain images, upscaling them if the application renders at a lower resolution
+    std::shared_ptr<Effect> createFinalPass(LogicalDevice*              pLogicalDevice,
+                                            LogicalSwapchain*           pLogicalSwapchain,
+                                            const std::vector<VkImage>& inputImages,
+                                            Config*                     pConfig)
+    {
+        if (isUpscaled(pLogicalSwapchain))
+        {
+            MemoryOwnerScope memoryOwner("Upscaling");
+            VkFormat format = pLogicalDevice->supportsMutableFormat ? convertToUNORM(pLogicalSwapchain->format) : pLogicalSwapchain->format;
+            return std::shared_ptr<Effect>(new UpscaleEffect(
+                pLogicalDevice, format, pLogicalSwapchain->outputExtent, inputImages, pLogicalSwapchain->images, pConfig));
+        }
+        return std::shared_ptr<Effect>(new TransferEffect(
+            pLogicalDevice, pLogicalSwapchain->format, pLogicalSwapchain->imageExtent, inputImages, pLogicalSwapchain->images, pConfig));
+    }
+
+    // Input and output images of the effect in slot index of a chain with effectCount effects
+    void getEffectImages(LogicalDevice*        pLogicalDevice,
+                         LogicalSwapchain*     pLogicalSwapchain,
+                         uint32_t              index,
+                         size_t                effectCount,
+                         std::vector<VkImage>& firstImages,
+                         std::vector<VkImage>& secondImages)
+    {
+        firstImages = std::vector<VkImage>(pLogicalSwapchain->fakeImages.begin() + pLogicalSwapchain->imageCount * index,
+                                           pLogicalSwapchain->fakeImages.begin() + pLogicalSwapchain->imageCount * (index + 1));
+
+        // Last effect writes to swapchain or final fake images
+        if (index == effectCount - 1)
+        {
+            secondImages = !needsFinalImages(pLogicalDevice, pLogicalSwapchain)
+                ? pLogicalSwapchain->images
+                : std::vector<VkImage>(pLogicalSwapchain->fakeImages.end() - pLogicalSwapchain->imageCount,
+                                       pLogicalSwapchain->fakeImages.end());
+        }
+        else
+        {
+            secondImages = std::vector<VkImage>(pLogicalSwapchain->fakeImages.begin() + pLogicalSwapchain->imageCount * (index + 1),
+                                                pLogicalSwapchain->fakeImages.begin() + pLogicalSwapchain->imageCount * (index + 2));
+        }
+    }
+
+    // Creates one effect of the chain, disabled, failed or refused effects become a pass-through
+    std::shared_ptr<Effect> createEffect(LogicalSwapchain*           pLogicalSwapchain,
+                                         LogicalDevice*              pLogicalDevice,
+                                         Config*                     pConfig,
+                                         const std::string&          effectName,
+                                         const std::vector<VkImage>& firstImages,
+                                         const std::vector<VkImage>& secondImages,
+                                         bool                        checkEnabledState)
+    {
+        auto createPassThrough = [&]() {
+            return std::shared_ptr<Effect>(new TransferEffect(
+                pLogicalDevice, pLogicalSwapchain->format, pLogicalSwapchain->imageExtent, firstImages, secondImages, pConfig));
+        };
+
+        // Check if effect should be skipped (disabled or failed)
+        bool effectFailed = effectRegistry.hasEffectFailed(effectName);
+        bool effectDisabled = checkEnabledState && !effectRegistry.isEffectEnabled(effectName);
+
+        if (effectFailed || effectDisabled)
+        {
+            Logger::debug("effect " + std::string(effectFailed ? "failed" : "disabled") + ", using pass-through: " + effectName);
+            return createPassThrough();
+        }
+
+        // Get effect type from registry (handles instance names like "cas.2")
+        std::string effectType = effectRegistry.getEffectType(effectName);
+        if (effectType.empty())
+            effectType = effectName;
+
+        // Attribute everything the effect allocates to its instance name
+        MemoryOwnerScope memoryOwner(effectName);
+        std::shared_ptr<Effect> effect;
+
+        // Create the appropriate effect type
+        const auto* def = BuiltInEffects::instance().getDef(effectType);
+        if (def)
+        {
+            // Built-in effects read their values from the config, values edited in the overlay are handed over as overrides
+            for (EffectParam* param : effectRegistry.getParametersForEffect(effectName))
+            {
+                if (effectRegistry.getParameterVersion(effectRegistry.getParameterHandle(effectName, param->name)) == 0)
+                    continue;
+                for (const auto& [key, value] : param->serialize())
+                    pConfig->setOverride(key.empty() ? param->name : key, value);
+            }
+
+            // Wrap built-in effect creation in try-catch to handle failures gracefully
+            try
+            {
+                VkFormat format = def->usesSrgbFormat ? convertToSRGB(pLogicalSwapchain->format) : convertToUNORM(pLogicalSwapchain->format);
+                effect = def->factory(pLogicalDevice, format, pLogicalSwapchain->imageExtent, firstImages, secondImages, pConfig);
+            }
+            catch (const std::exception& e)
+            {
+                Logger::err("Failed to create built-in effect " + effectName + ": " + e.what());
+                effectRegistry.setEffectError(effectName, e.what());
+            }
+
+            // Overrides are per instance, "cas.2" must not see the values of "cas"
+            pConfig->clearOverrides();
+        }
+        else
+        {
+            // ReShade effect - wrap in try-catch to handle compilation failures gracefully
+            std::string effectPath = effectRegistry.getEffectFilePath(effectName);
+            auto customDefs = effectRegistry.getPreprocessorDefs(effectName);
+            try
+            {
+                effect = std::shared_ptr<Effect>(new ReshadeEffect(
+                    pLogicalDevice, pLogicalSwapchain->format, pLogicalSwapchain->imageExtent,
+                    firstImages, secondImages, pLogicalSwapchain->scratchImages.get(), &effectRegistry, effectName, effectPath, customDefs));
+            }
+            catch (const std::exception& e)
+            {
+                Logger::err("Failed to create ReshadeEffect " + effectName + ": " + e.what());
+                effectRegistry.setEffectError(effectName, e.what());
+            }
+        }
+
+        if (!effect)
+            return createPassThrough();
+
+        // Refuse the effect if it pushed us over the VRAM limit, its memory is freed with it
+        std::string budgetError = checkVramBudget(pLogicalDevice);
+        if (!budgetError.empty())
+        {
+            Logger::warn("Refusing effect " + effectName + ": " + budgetError);
+            effectRegistry.setEffectError(effectName, budgetError);
+            // Its texture uploads may still run on the GPU
+            pLogicalDevice->frameTimeline->waitSubmitted();
+            effect.reset();
+            return createPassThrough();
+        }
+
+        // Only render inside the configured regions, the rest of the image passes through
+        EffectRegions regions = getEffectRegions(pConfig, effectName, pLogicalSwapchain->imageExtent);
+        if (regions.isActive() && !effect->setRegions(regions))
+            Logger::warn(effectName + " can't be limited to regions, it covers the whole image");
+
+        return effect;
+    }
+
+    // One linear depth image shared by every effect that samples depth
+    void updateLinearDepth(LogicalSwapchain* pLogicalSwapchain, LogicalDevice* pLogicalDevice, Config* pConfig)
+    {
+        pLogicalSwapchain->linearDepth.reset();
+
+        bool anyUsesDepth = std::any_of(pLogicalSwapchain->effects.begin(), pLogicalSwapchain->effects.end(),
+                                        [](const std::shared_ptr<Effect>& effect) { return effect->usesDepth(); });
+        if (anyUsesDepth && settingsManager.getLinearDepthPrepass())
+        {
+            MemoryOwnerScope memoryOwner("Linear depth");
+            pLogicalSwapchain->linearDepth = std::make_unique<LinearDepthPass>(pLogicalDevice, pLogicalSwapchain->imageExtent, pConfig);
+        }
     }
 
     // Helper function to create effects for a swapchain
@@ -370,17 +569,23 @@ namespace vkBasalt
         const std::vector<std::string>& effectStrings,
         bool checkEnabledState = true)
     {
-        VkFormat unormFormat = convertToUNORM(pLogicalSwapchain->format);
-        VkFormat srgbFormat = convertToSRGB(pLogicalSwapchain->format);
+        pLogicalSwapchain->linearDepth.reset();
+
+        // Nothing is allocated until an effect asks for it
+        pLogicalSwapchain->scratchImages.reset();
+        pLogicalSwapchain->scratchImages = std::make_unique<ScratchImages>(
+            pLogicalDevice, pLogicalSwapchain->format, pLogicalSwapchain->imageExtent, pLogicalSwapchain->imageCount);
+
+        // The whole chain is rebuilt from the registry, pending parameter changes are part of it
+        effectRegistry.takeDirtyEffects();
+        pLogicalSwapchain->effectNames = effectStrings;
 
         // If no effects, add pass-through so rendering still works
         if (effectStrings.empty())
         {
             std::vector<VkImage> firstImages(pLogicalSwapchain->fakeImages.begin(),
                                              pLogicalSwapchain->fakeImages.begin() + pLogicalSwapchain->imageCount);
-            pLogicalSwapchain->effects.push_back(std::shared_ptr<Effect>(new TransferEffect(
-                pLogicalDevice, pLogicalSwapchain->format, pLogicalSwapchain->imageExtent,
-                firstImages, pLogicalSwapchain->images, pConfig)));
+            pLogicalSwapchain->effects.push_back(createFinalPass(pLogicalDevice, pLogicalSwapchain, firstImages, pConfig));
             return;
         }
 
@@ -388,89 +593,21 @@ namespace vkBasalt
         {
             Logger::debug("creating effect " + std::to_string(i) + ": " + effectStrings[i]);
 
-            // Calculate input images for this effect
-            std::vector<VkImage> firstImages(pLogicalSwapchain->fakeImages.begin() + pLogicalSwapchain->imageCount * i,
-                                             pLogicalSwapchain->fakeImages.begin() + pLogicalSwapchain->imageCount * (i + 1));
-
-            // Calculate output images - last effect writes to swapchain or final fake images
-            std::vector<VkImage> secondImages;
-            if (i == effectStrings.size() - 1)
-            {
-                secondImages = pLogicalDevice->supportsMutableFormat
-                    ? pLogicalSwapchain->images
-                    : std::vector<VkImage>(pLogicalSwapchain->fakeImages.end() - pLogicalSwapchain->imageCount,
-                                           pLogicalSwapchain->fakeImages.end());
-            }
-            else
-            {
-                secondImages = std::vector<VkImage>(pLogicalSwapchain->fakeImages.begin() + pLogicalSwapchain->imageCount * (i + 1),
-                                                    pLogicalSwapchain->fakeImages.begin() + pLogicalSwapchain->imageCount * (i + 2));
-            }
-
-            // Check if effect should be skipped (disabled or failed)
-            bool effectFailed = effectRegistry.hasEffectFailed(effectStrings[i]);
-            bool effectDisabled = checkEnabledState && !effectRegistry.isEffectEnabled(effectStrings[i]);
-
-            if (effectFailed || effectDisabled)
-            {
-                Logger::debug("effect " + std::string(effectFailed ? "failed" : "disabled") + ", using pass-through: " + effectStrings[i]);
-                pLogicalSwapchain->effects.push_back(std::shared_ptr<Effect>(
-                    new TransferEffect(pLogicalDevice, pLogicalSwapchain->format, pLogicalSwapchain->imageExtent, firstImages, secondImages, pConfig)));
-                continue;
-            }
-
-            // Get effect type from registry (handles instance names like "cas.2")
-            std::string effectType = effectRegistry.getEffectType(effectStrings[i]);
-            if (effectType.empty())
-                effectType = effectStrings[i];
-
-            // Create the appropriate effect type
-            const auto* def = BuiltInEffects::instance().getDef(effectType);
-            if (def)
-            {
-                // Wrap built-in effect creation in try-catch to handle failures gracefully
-                try
-                {
-                    VkFormat format = def->usesSrgbFormat ? srgbFormat : unormFormat;
-                    pLogicalSwapchain->effects.push_back(
-                        def->factory(pLogicalDevice, format, pLogicalSwapchain->imageExtent, firstImages, secondImages, pConfig));
-                }
-                catch (const std::exception& e)
-                {
-                    Logger::err("Failed to create built-in effect " + effectStrings[i] + ": " + e.what());
-                    effectRegistry.setEffectError(effectStrings[i], e.what());
-                    pLogicalSwapchain->effects.push_back(std::shared_ptr<Effect>(
-                        new TransferEffect(pLogicalDevice, pLogicalSwapchain->format, pLogicalSwapchain->imageExtent, firstImages, secondImages, pConfig)));
-                }
-            }
-            else
-            {
-                // ReShade effect - wrap in try-catch to handle compilation failures gracefully
-                std::string effectPath = effectRegistry.getEffectFilePath(effectStrings[i]);
-                auto customDefs = effectRegistry.getPreprocessorDefs(effectStrings[i]);
-                try
-                {
-                    pLogicalSwapchain->effects.push_back(std::shared_ptr<Effect>(new ReshadeEffect(
-                        pLogicalDevice, pLogicalSwapchain->format, pLogicalSwapchain->imageExtent,
-                        firstImages, secondImages, &effectRegistry, effectStrings[i], effectPath, customDefs)));
-                }
-                catch (const std::exception& e)
-                {
-                    Logger::err("Failed to create ReshadeEffect " + effectStrings[i] + ": " + e.what());
-                    effectRegistry.setEffectError(effectStrings[i], e.what());
-                    pLogicalSwapchain->effects.push_back(std::shared_ptr<Effect>(
-                        new TransferEffect(pLogicalDevice, pLogicalSwapchain->format, pLogicalSwapchain->imageExtent, firstImages, secondImages, pConfig)));
-                }
-            }
+            std::vector<VkImage> firstImages, secondImages;
+            getEffectImages(pLogicalDevice, pLogicalSwapchain, i, effectStrings.size(), firstImages, secondImages);
+            pLogicalSwapchain->effects.push_back(
+                createEffect(pLogicalSwapchain, pLogicalDevice, pConfig, effectStrings[i], firstImages, secondImages, checkEnabledState));
         }
 
-        // If device doesn't support mutable format, add final transfer to swapchain
-        if (!pLogicalDevice->supportsMutableFormat)
+        updateLinearDepth(pLogicalSwapchain, pLogicalDevice, pConfig);
+
+        // If device doesn't support mutable format or the image gets upscaled, add final pass to swapchain
+        if (needsFinalImages(pLogicalDevice, pLogicalSwapchain))
         {
-            pLogicalSwapchain->effects.push_back(std::shared_ptr<Effect>(new TransferEffect(
-                pLogicalDevice, pLogicalSwapchain->format, pLogicalSwapchain->imageExtent,
+            pLogicalSwapchain->effects.push_back(createFinalPass(
+                pLogicalDevice, pLogicalSwapchain,
                 std::vector<VkImage>(pLogicalSwapchain->fakeImages.end() - pLogicalSwapchain->imageCount, pLogicalSwapchain->fakeImages.end()),
-                pLogicalSwapchain->images, pConfig)));
+                pConfig));
         }
     }
 
@@ -480,8 +617,8 @@ namespace vkBasalt
     {
         LogicalDevice* pLogicalDevice = pLogicalSwapchain->pLogicalDevice;
 
-        // Wait for GPU to finish
-        pLogicalDevice->vkd.QueueWaitIdle(pLogicalDevice->queue);
+        // Wait for the effects' last submission, the application's own work on the queue can keep running
+        pLogicalDevice->frameTimeline->waitSubmitted();
 
         // Clear effects (command buffers will be freed by reallocateCommandBuffers)
         pLogicalSwapchain->effects.clear();
@@ -507,13 +644,11 @@ namespace vkBasalt
         createEffectsForSwapchain(pLogicalSwapchain, pLogicalDevice, pConfig, effectStrings, true);
 
         // Create default transfer effect (needed for no-effect command buffers)
-        pLogicalSwapchain->defaultTransfer = std::shared_ptr<Effect>(new TransferEffect(
+        pLogicalSwapchain->defaultTransfer = createFinalPass(
             pLogicalDevice,
-            pLogicalSwapchain->format,
-            pLogicalSwapchain->imageExtent,
+            pLogicalSwapchain,
             std::vector<VkImage>(pLogicalSwapchain->fakeImages.begin(), pLogicalSwapchain->fakeImages.begin() + pLogicalSwapchain->imageCount),
-            pLogicalSwapchain->images,
-            pConfig));
+            pConfig);
 
         // Free old command buffers and allocate/write new ones
         DepthState depth = getDepthState(pLogicalDevice);
@@ -532,6 +667,66 @@ namespace vkBasalt
         }
     }
 
+    // Apply parameter changes from the overlay by recreating only the effects whose values changed.
+    // Returns false if the chain itself changed (effects added, removed, reordered or toggled) and needs a full reload
+    bool applyOverlayParams(LogicalDevice* pLogicalDevice)
+    {
+        if (!pLogicalDevice->imguiOverlay || resizeDebounce.pending)
+            return false;
+
+        std::vector<std::string> activeEffects = pLogicalDevice->imguiOverlay->getActiveEffects();
+        for (auto& [_, pLogicalSwapchain] : swapchainMap)
+        {
+            if (pLogicalSwapchain->fakeImages.empty())
+                continue;
+
+            std::vector<std::string> effectStrings = activeEffects;
+            if (effectStrings.size() > pLogicalSwapchain->maxEffectSlots)
+                effectStrings.resize(pLogicalSwapchain->maxEffectSlots);
+            if (pLogicalSwapchain->effectNames != effectStrings)
+                return false;
+        }
+
+        std::vector<std::string> dirtyEffects = effectRegistry.takeDirtyEffects();
+        if (dirtyEffects.empty())
+            return true;
+
+        Logger::info("applying parameters, recreating " + std::to_string(dirtyEffects.size()) + " effects");
+
+        for (auto& [_, pLogicalSwapchain] : swapchainMap)
+        {
+            if (pLogicalSwapchain->fakeImages.empty())
+                continue;
+
+            LogicalDevice* pSwapchainDevice = pLogicalSwapchain->pLogicalDevice;
+            const auto&    effectNames      = pLogicalSwapchain->effectNames;
+            bool           recreated        = false;
+            for (uint32_t i = 0; i < effectNames.size(); i++)
+            {
+                if (std::find(dirtyEffects.begin(), dirtyEffects.end(), effectNames[i]) == dirtyEffects.end())
+                    continue;
+
+                if (!recreated)
+                    pSwapchainDevice->frameTimeline->waitSubmitted();
+                recreated = true;
+
+                // Free the old effect first so the VRAM budget check sees the new one alone
+                std::vector<VkImage> firstImages, secondImages;
+                getEffectImages(pSwapchainDevice, pLogicalSwapchain.get(), i, effectNames.size(), firstImages, secondImages);
+                pLogicalSwapchain->effects[i].reset();
+                pLogicalSwapchain->effects[i] = createEffect(
+                    pLogicalSwapchain.get(), pSwapchainDevice, pConfig.get(), effectNames[i], firstImages, secondImages, true);
+            }
+
+            if (!recreated)
+                continue;
+
+            updateLinearDepth(pLogicalSwapchain.get(), pSwapchainDevice, pConfig.get());
+            reallocateCommandBuffers(pSwapchainDevice, pLogicalSwapchain.get(), getDepthState(pSwapchainDevice));
+        }
+        return true;
+    }
+
     // Build and update overlay state for rendering
     void updateOverlayState(LogicalDevice* pLogicalDevice, bool effectsEnabled)
     {
@@ -544,8 +739,15 @@ namespace vkBasalt
         // No fallback to config - registry is the single source of truth
         // (initialized from config at first swapchain creation)
 
-        getAvailableEffects(pConfig.get(), overlayState.currentConfigEffects,
-                            overlayState.defaultConfigEffects, overlayState.effectPaths);
+        // The overlay keeps its copy of the lists until they change
+        refreshAvailableEffects(pConfig.get());
+        overlayState.catalogVersion = cachedEffects.version;
+        if (pLogicalDevice->imguiOverlay->getCatalogVersion() != cachedEffects.version)
+        {
+            overlayState.currentConfigEffects = cachedEffects.currentConfigEffects;
+            overlayState.defaultConfigEffects = cachedEffects.defaultConfigEffects;
+            overlayState.effectPaths = cachedEffects.effectPaths;
+        }
         overlayState.configPath = pConfig->getConfigFilePath();
         overlayState.configName = std::filesystem::path(overlayState.configPath).filename().string();
         overlayState.effectsEnabled = effectsEnabled;
@@ -555,8 +757,8 @@ namespace vkBasalt
         {
             if (effectRegistry.hasEffect(effectName))
                 continue;
-            auto pathIt = overlayState.effectPaths.find(effectName);
-            std::string effectPath = (pathIt != overlayState.effectPaths.end()) ? pathIt->second : "";
+            auto pathIt = cachedEffects.effectPaths.find(effectName);
+            std::string effectPath = (pathIt != cachedEffects.effectPaths.end()) ? pathIt->second : "";
             effectRegistry.ensureEffect(effectName, effectPath);
         }
 
@@ -564,28 +766,52 @@ namespace vkBasalt
         pLogicalDevice->imguiOverlay->updateState(std::move(overlayState));
     }
 
-    // Submit overlay command buffer if visible, returns semaphore to wait on
-    VkResult submitOverlayFrame(LogicalDevice* pLogicalDevice, LogicalSwapchain* pSwapchain,
-                                uint32_t index, VkSemaphore& outSemaphore)
+    // Create ImGui overlay at device level (if not already created)
+    // This survives swapchain recreation during resize. ImGui itself is only set up when the overlay is first shown
+    void createOverlay(LogicalDevice* pLogicalDevice, LogicalSwapchain* pLogicalSwapchain)
     {
-        outSemaphore = pSwapchain->semaphores[index];  // Default: wait on effects semaphore
+        if (pLogicalDevice->imguiOverlay)
+            return;
+
+        if (!pLogicalDevice->overlayPersistentState)
+            pLogicalDevice->overlayPersistentState = std::make_unique<OverlayPersistentState>();
+        pLogicalDevice->imguiOverlay = std::make_unique<ImGuiOverlay>(
+            pLogicalDevice, pLogicalSwapchain->format, pLogicalSwapchain->imageCount,
+            pLogicalDevice->overlayPersistentState.get());
+        // Set the effect registry pointer (single source of truth for enabled states)
+        pLogicalDevice->imguiOverlay->setEffectRegistry(&effectRegistry);
+
+        // Initialize input blocking (grabs all input when overlay is visible)
+        static bool inputBlockerInited = false;
+        if (!inputBlockerInited)
+        {
+            initInputBlocker(settingsManager.getOverlayBlockInput());
+            inputBlockerInited = true;
+        }
+    }
+
+    // outSemaphore stays VK_NULL_HANDLE when the overlay had nothing to draw
+    VkResult submitOverlayFrame(LogicalDevice* pLogicalDevice, LogicalSwapchain* pSwapchain, uint32_t index,
+                                uint32_t waitSemaphoreCount, const VkSemaphore* pWaitSemaphores, VkSemaphore& outSemaphore)
+    {
+        outSemaphore = VK_NULL_HANDLE;
 
         if (!pLogicalDevice->imguiOverlay)
             return VK_SUCCESS;
 
         VkCommandBuffer overlayCmd = pLogicalDevice->imguiOverlay->recordFrame(
             index, pSwapchain->imageViews[index],
-            pSwapchain->imageExtent.width, pSwapchain->imageExtent.height);
+            pSwapchain->outputExtent.width, pSwapchain->outputExtent.height);
 
         if (overlayCmd == VK_NULL_HANDLE)
             return VK_SUCCESS;
 
-        VkPipelineStageFlags overlayWaitStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        std::vector<VkPipelineStageFlags> overlayWaitStages(waitSemaphoreCount, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
         VkSubmitInfo overlaySubmit = {};
         overlaySubmit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        overlaySubmit.waitSemaphoreCount = 1;
-        overlaySubmit.pWaitSemaphores = &pSwapchain->semaphores[index];
-        overlaySubmit.pWaitDstStageMask = &overlayWaitStage;
+        overlaySubmit.waitSemaphoreCount = waitSemaphoreCount;
+        overlaySubmit.pWaitSemaphores = pWaitSemaphores;
+        overlaySubmit.pWaitDstStageMask = overlayWaitStages.data();
         overlaySubmit.commandBufferCount = 1;
         overlaySubmit.pCommandBuffers = &overlayCmd;
         overlaySubmit.signalSemaphoreCount = 1;
@@ -661,6 +887,7 @@ namespace vkBasalt
             instanceDispatchMap[GetKey(*pInstance)] = dispatchTable;
             instanceMap[GetKey(*pInstance)]         = *pInstance;
             instanceVersionMap[GetKey(*pInstance)]  = modifiedCreateInfo.pApplicationInfo->apiVersion;
+            instanceProcAddrCache.insert(GetKey(*pInstance), dispatchTable.GetInstanceProcAddr);
         }
 
         return ret;
@@ -679,6 +906,7 @@ namespace vkBasalt
 
         dispatchTable.DestroyInstance(instance, pAllocator);
 
+        instanceProcAddrCache.erase(GetKey(instance));
         instanceDispatchMap.erase(GetKey(instance));
         instanceMap.erase(GetKey(instance));
         instanceVersionMap.erase(GetKey(instance));
@@ -721,14 +949,47 @@ namespace vkBasalt
         instanceDispatchMap[GetKey(physicalDevice)].EnumerateDeviceExtensionProperties(
             physicalDevice, nullptr, &extensionCount, extensionProperties.data());
 
-        bool supportsMutableFormat = false;
+        bool supportsMutableFormat  = false;
+        bool supportsMemoryBudget   = false;
+        bool supportsFloat16Int8Ext = false;
+        bool supportsPresentIdExt   = false;
+        bool supportsPresentWaitExt = false;
+        bool supportsPushDescriptor = false;
+        bool supportsTimelineExt    = false;
         for (VkExtensionProperties properties : extensionProperties)
         {
             if (properties.extensionName == std::string("VK_KHR_swapchain_mutable_format"))
             {
                 Logger::debug("device supports VK_KHR_swapchain_mutable_format");
                 supportsMutableFormat = true;
-                break;
+            }
+            else if (properties.extensionName == std::string("VK_EXT_memory_budget"))
+            {
+                Logger::debug("device supports VK_EXT_memory_budget");
+                supportsMemoryBudget = true;
+            }
+            else if (properties.extensionName == std::string("VK_KHR_shader_float16_int8"))
+            {
+                Logger::debug("device supports VK_KHR_shader_float16_int8");
+                supportsFloat16Int8Ext = true;
+            }
+            else if (properties.extensionName == std::string("VK_KHR_push_descriptor"))
+            {
+                Logger::debug("device supports VK_KHR_push_descriptor");
+                supportsPushDescriptor = true;
+            }
+            else if (properties.extensionName == std::string("VK_KHR_timeline_semaphore"))
+            {
+                Logger::debug("device supports VK_KHR_timeline_semaphore");
+                supportsTimelineExt = true;
+            }
+            else if (properties.extensionName == std::string("VK_KHR_present_id"))
+            {
+                supportsPresentIdExt = true;
+            }
+            else if (properties.extensionName == std::string("VK_KHR_present_wait"))
+            {
+                supportsPresentWaitExt = true;
             }
         }
 
@@ -748,10 +1009,167 @@ namespace vkBasalt
             Logger::debug("activating mutable_format");
             addUniqueCString(enabledExtensionNames, "VK_KHR_swapchain_mutable_format");
         }
-        if (deviceProps.apiVersion < VK_API_VERSION_1_2 || instanceVersionMap[GetKey(physicalDevice)] < VK_API_VERSION_1_2)
+        if (supportsMemoryBudget)
+        {
+            addUniqueCString(enabledExtensionNames, "VK_EXT_memory_budget");
+        }
+        if (supportsPushDescriptor)
+        {
+            addUniqueCString(enabledExtensionNames, "VK_KHR_push_descriptor");
+        }
+        bool isVulkan12 = deviceProps.apiVersion >= VK_API_VERSION_1_2 && instanceVersionMap[GetKey(physicalDevice)] >= VK_API_VERSION_1_2;
+        if (!isVulkan12)
         {
             addUniqueCString(enabledExtensionNames, "VK_KHR_image_format_list");
         }
+
+        // shaderFloat16 for the FP16 built-in shaders
+        bool supportsFloat16 = false;
+        auto getFeatures2    = instanceDispatchMap[GetKey(physicalDevice)].GetPhysicalDeviceFeatures2;
+        if ((isVulkan12 || supportsFloat16Int8Ext) && getFeatures2)
+        {
+            VkPhysicalDeviceShaderFloat16Int8Features float16Features = {};
+            float16Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_FLOAT16_INT8_FEATURES;
+
+            VkPhysicalDeviceFeatures2 features2 = {};
+            features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+            features2.pNext = &float16Features;
+            getFeatures2(physicalDevice, &features2);
+            supportsFloat16 = float16Features.shaderFloat16;
+        }
+
+        // If the application already chains a struct holding shaderFloat16, go with what it enabled,
+        // adding a second one would be invalid
+        VkPhysicalDeviceShaderFloat16Int8Features float16Enable = {};
+        bool appSetsFloat16 = false;
+        for (auto* pNext = static_cast<const VkBaseInStructure*>(pCreateInfo->pNext); pNext; pNext = pNext->pNext)
+        {
+            if (pNext->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES)
+            {
+                supportsFloat16 = supportsFloat16 && reinterpret_cast<const VkPhysicalDeviceVulkan12Features*>(pNext)->shaderFloat16;
+                appSetsFloat16  = true;
+            }
+            else if (pNext->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_FLOAT16_INT8_FEATURES)
+            {
+                supportsFloat16 = supportsFloat16 && reinterpret_cast<const VkPhysicalDeviceShaderFloat16Int8Features*>(pNext)->shaderFloat16;
+                appSetsFloat16  = true;
+            }
+        }
+        if (supportsFloat16 && !appSetsFloat16)
+        {
+            Logger::debug("activating shaderFloat16");
+            float16Enable.sType         = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_FLOAT16_INT8_FEATURES;
+            float16Enable.pNext         = const_cast<void*>(modifiedCreateInfo.pNext);
+            float16Enable.shaderFloat16 = VK_TRUE;
+            modifiedCreateInfo.pNext    = &float16Enable;
+            if (!isVulkan12)
+                addUniqueCString(enabledExtensionNames, "VK_KHR_shader_float16_int8");
+        }
+
+        // Timeline semaphores track which of vkBasalt's submissions finished.
+        // The KHR entry points are used, so the extension gets enabled even where 1.2 has it in core
+        bool supportsTimelineSemaphore = false;
+        if (supportsTimelineExt && getFeatures2)
+        {
+            VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineFeatures = {};
+            timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+
+            VkPhysicalDeviceFeatures2 features2 = {};
+            features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+            features2.pNext = &timelineFeatures;
+            getFeatures2(physicalDevice, &features2);
+            supportsTimelineSemaphore = timelineFeatures.timelineSemaphore;
+        }
+
+        // Same as with shaderFloat16, structs the application chains itself decide
+        VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineEnable = {};
+        bool appSetsTimeline = false;
+        for (auto* pNext = static_cast<const VkBaseInStructure*>(pCreateInfo->pNext); pNext; pNext = pNext->pNext)
+        {
+            if (pNext->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES)
+            {
+                supportsTimelineSemaphore =
+                    supportsTimelineSemaphore && reinterpret_cast<const VkPhysicalDeviceVulkan12Features*>(pNext)->timelineSemaphore;
+                appSetsTimeline = true;
+            }
+            else if (pNext->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR)
+            {
+                supportsTimelineSemaphore =
+                    supportsTimelineSemaphore && reinterpret_cast<const VkPhysicalDeviceTimelineSemaphoreFeaturesKHR*>(pNext)->timelineSemaphore;
+                appSetsTimeline = true;
+            }
+        }
+        if (supportsTimelineSemaphore)
+        {
+            Logger::debug("activating timelineSemaphore");
+            if (!appSetsTimeline)
+            {
+                timelineEnable.sType             = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+                timelineEnable.pNext             = const_cast<void*>(modifiedCreateInfo.pNext);
+                timelineEnable.timelineSemaphore = VK_TRUE;
+                modifiedCreateInfo.pNext         = &timelineEnable;
+            }
+            addUniqueCString(enabledExtensionNames, "VK_KHR_timeline_semaphore");
+        }
+
+        // presentId and presentWait tag presents and wait for them to be shown, for the latency stats
+        bool presentLatencyStats = settingsManager.getPresentLatencyStats();
+        bool supportsPresentWait = false;
+        if (presentLatencyStats && supportsPresentIdExt && supportsPresentWaitExt && getFeatures2)
+        {
+            VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures = {};
+            presentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+
+            VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures = {};
+            presentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+            presentIdFeatures.pNext = &presentWaitFeatures;
+
+            VkPhysicalDeviceFeatures2 features2 = {};
+            features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+            features2.pNext = &presentIdFeatures;
+            getFeatures2(physicalDevice, &features2);
+            supportsPresentWait = presentIdFeatures.presentId && presentWaitFeatures.presentWait;
+        }
+
+        // Same as with shaderFloat16, structs the application chains itself decide
+        VkPhysicalDevicePresentIdFeaturesKHR   presentIdEnable   = {};
+        VkPhysicalDevicePresentWaitFeaturesKHR presentWaitEnable = {};
+        bool appSetsPresentId   = false;
+        bool appSetsPresentWait = false;
+        for (auto* pNext = static_cast<const VkBaseInStructure*>(pCreateInfo->pNext); pNext && supportsPresentWait; pNext = pNext->pNext)
+        {
+            if (pNext->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR)
+            {
+                supportsPresentWait = reinterpret_cast<const VkPhysicalDevicePresentIdFeaturesKHR*>(pNext)->presentId;
+                appSetsPresentId    = true;
+            }
+            else if (pNext->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR)
+            {
+                supportsPresentWait = reinterpret_cast<const VkPhysicalDevicePresentWaitFeaturesKHR*>(pNext)->presentWait;
+                appSetsPresentWait  = true;
+            }
+        }
+        if (supportsPresentWait)
+        {
+            Logger::debug("activating presentId and presentWait");
+            if (!appSetsPresentId)
+            {
+                presentIdEnable.sType     = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+                presentIdEnable.pNext     = const_cast<void*>(modifiedCreateInfo.pNext);
+                presentIdEnable.presentId = VK_TRUE;
+                modifiedCreateInfo.pNext  = &presentIdEnable;
+            }
+            if (!appSetsPresentWait)
+            {
+                presentWaitEnable.sType       = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+                presentWaitEnable.pNext       = const_cast<void*>(modifiedCreateInfo.pNext);
+                presentWaitEnable.presentWait = VK_TRUE;
+                modifiedCreateInfo.pNext      = &presentWaitEnable;
+            }
+            addUniqueCString(enabledExtensionNames, "VK_KHR_present_id");
+            addUniqueCString(enabledExtensionNames, "VK_KHR_present_wait");
+        }
+
         modifiedCreateInfo.ppEnabledExtensionNames = enabledExtensionNames.data();
         modifiedCreateInfo.enabledExtensionCount   = enabledExtensionNames.size();
 
@@ -764,30 +1182,62 @@ namespace vkBasalt
         deviceFeatures.shaderImageGatherExtended = VK_TRUE;
         modifiedCreateInfo.pEnabledFeatures      = &deviceFeatures;
 
+        uint32_t familyCount = 0;
+        instanceDispatchMap[GetKey(physicalDevice)].GetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> queueProperties(familyCount);
+        instanceDispatchMap[GetKey(physicalDevice)].GetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, queueProperties.data());
+
+        // Optionally ask for one more queue of the graphics family the application uses, so effects and
+        // overlay do not get serialized behind the game's next frame on its queue.
+        // Same family means no ownership transfers, the present semaphores already order the work.
+        std::vector<VkDeviceQueueCreateInfo> queueCreateInfos(pCreateInfo->pQueueCreateInfos,
+                                                              pCreateInfo->pQueueCreateInfos + pCreateInfo->queueCreateInfoCount);
+        std::vector<float> queuePriorities;
+        int32_t            effectQueueIndex = -1;
+        if (settingsManager.getDedicatedEffectQueue())
+        {
+            for (auto& queueInfo : queueCreateInfos)
+            {
+                if (!(queueProperties[queueInfo.queueFamilyIndex].queueFlags & VK_QUEUE_GRAPHICS_BIT))
+                    continue;
+                if (queueInfo.flags == 0 && queueInfo.queueCount < queueProperties[queueInfo.queueFamilyIndex].queueCount)
+                {
+                    queuePriorities.assign(queueInfo.pQueuePriorities, queueInfo.pQueuePriorities + queueInfo.queueCount);
+                    queuePriorities.push_back(queuePriorities[0]);
+                    effectQueueIndex           = queueInfo.queueCount;
+                    queueInfo.queueCount       = queuePriorities.size();
+                    queueInfo.pQueuePriorities = queuePriorities.data();
+                }
+                else
+                {
+                    Logger::info("graphics queue family has no spare queue, effects stay on the application's queue");
+                }
+                break;
+            }
+            modifiedCreateInfo.pQueueCreateInfos = queueCreateInfos.data();
+        }
+
         VkResult ret = createFunc(physicalDevice, &modifiedCreateInfo, pAllocator, pDevice);
 
         if (ret != VK_SUCCESS)
             return ret;
 
         std::shared_ptr<LogicalDevice> pLogicalDevice(new LogicalDevice());
-        pLogicalDevice->vki                   = instanceDispatchMap[GetKey(physicalDevice)];
-        pLogicalDevice->device                = *pDevice;
-        pLogicalDevice->physicalDevice        = physicalDevice;
-        pLogicalDevice->instance              = instanceMap[GetKey(physicalDevice)];
-        pLogicalDevice->queue                 = VK_NULL_HANDLE;
-        pLogicalDevice->queueFamilyIndex      = 0;
-        pLogicalDevice->commandPool           = VK_NULL_HANDLE;
-        pLogicalDevice->supportsMutableFormat = supportsMutableFormat;
+        pLogicalDevice->vki                    = instanceDispatchMap[GetKey(physicalDevice)];
+        pLogicalDevice->device                 = *pDevice;
+        pLogicalDevice->physicalDevice         = physicalDevice;
+        pLogicalDevice->instance               = instanceMap[GetKey(physicalDevice)];
+        pLogicalDevice->queue                  = VK_NULL_HANDLE;
+        pLogicalDevice->queueFamilyIndex       = 0;
+        pLogicalDevice->commandPool            = VK_NULL_HANDLE;
+        pLogicalDevice->supportsMutableFormat  = supportsMutableFormat;
+        pLogicalDevice->supportsMemoryBudget   = supportsMemoryBudget;
+        pLogicalDevice->supportsFloat16        = supportsFloat16;
+        pLogicalDevice->supportsPushDescriptor = supportsPushDescriptor;
+        pLogicalDevice->supportsTimelineSemaphore = supportsTimelineSemaphore;
 
         fillDispatchTableDevice(*pDevice, gdpa, &pLogicalDevice->vkd);
 
-        uint32_t count;
-
-        pLogicalDevice->vki.GetPhysicalDeviceQueueFamilyProperties(pLogicalDevice->physicalDevice, &count, nullptr);
-
-        std::vector<VkQueueFamilyProperties> queueProperties(count);
-
-        pLogicalDevice->vki.GetPhysicalDeviceQueueFamilyProperties(pLogicalDevice->physicalDevice, &count, queueProperties.data());
         for (uint32_t i = 0; i < pCreateInfo->queueCreateInfoCount; i++)
         {
             auto& queueInfo = pCreateInfo->pQueueCreateInfos[i];
@@ -807,14 +1257,39 @@ namespace vkBasalt
 
                 initializeDispatchTable(pLogicalDevice->queue, pLogicalDevice->device);
 
+                if (effectQueueIndex >= 0)
+                {
+                    pLogicalDevice->vkd.GetDeviceQueue(pLogicalDevice->device, queueInfo.queueFamilyIndex, effectQueueIndex, &pLogicalDevice->queue);
+                    initializeDispatchTable(pLogicalDevice->queue, pLogicalDevice->device);
+
+                    VkSemaphoreCreateInfo semaphoreCreateInfo = {};
+                    semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+                    VkResult result = pLogicalDevice->vkd.CreateSemaphore(pLogicalDevice->device, &semaphoreCreateInfo, nullptr,
+                                                                          &pLogicalDevice->queueHandoffSemaphore);
+                    ASSERT_VULKAN(result);
+
+                    pLogicalDevice->dedicatedQueue = true;
+                    Logger::info("using dedicated queue " + std::to_string(effectQueueIndex) + " of family "
+                                 + std::to_string(queueInfo.queueFamilyIndex) + " for effects");
+                }
+
                 break;
             }
         }
 
         if (!pLogicalDevice->queue)
+        {
             Logger::err("Did not find a graphics queue!");
+        }
+        else
+        {
+            pLogicalDevice->frameTimeline = std::make_unique<FrameTimeline>(pLogicalDevice.get());
+            if (presentLatencyStats)
+                pLogicalDevice->presentLatency = std::make_unique<PresentLatencyTracker>(pLogicalDevice.get(), supportsPresentWait);
+        }
 
         deviceMap[GetKey(*pDevice)] = pLogicalDevice;
+        deviceProcAddrCache.insert(GetKey(*pDevice), pLogicalDevice->vkd.GetDeviceProcAddr);
 
         return VK_SUCCESS;
     }
@@ -832,6 +1307,12 @@ namespace vkBasalt
 
         // Destroy ImGui overlay before device (it uses device resources)
         pLogicalDevice->imguiOverlay.reset();
+        pLogicalDevice->presentLatency.reset();
+        pLogicalDevice->chainProfiler.reset();
+        pLogicalDevice->frameTimeline.reset();  // runs the destroys still waiting on the GPU
+
+        if (pLogicalDevice->queueHandoffSemaphore != VK_NULL_HANDLE)
+            pLogicalDevice->vkd.DestroySemaphore(device, pLogicalDevice->queueHandoffSemaphore, pAllocator);
 
         if (pLogicalDevice->commandPool != VK_NULL_HANDLE)
         {
@@ -841,6 +1322,7 @@ namespace vkBasalt
 
         pLogicalDevice->vkd.DestroyDevice(device, pAllocator);
 
+        deviceProcAddrCache.erase(GetKey(device));
         deviceMap.erase(GetKey(device));
     }
 
@@ -883,11 +1365,41 @@ namespace vkBasalt
 
         modifiedCreateInfo.imageUsage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
 
+        // The application renders at a reduced extent, the swapchain keeps the size of the surface.
+        // Only done when the surface has a fixed size, so the reduced extent must have come from our capabilities
+        float renderScale = getRenderScale();
+        if (renderScale < 1.0f && pLogicalDevice->vki.GetPhysicalDeviceSurfaceCapabilitiesKHR)
+        {
+            VkSurfaceCapabilitiesKHR capabilities;
+            if (pLogicalDevice->vki.GetPhysicalDeviceSurfaceCapabilitiesKHR(pLogicalDevice->physicalDevice, pCreateInfo->surface, &capabilities)
+                    == VK_SUCCESS
+                && capabilities.currentExtent.width != 0xFFFFFFFF)
+            {
+                VkExtent2D scaled = scaleExtent(capabilities.currentExtent, renderScale);
+                if (scaled.width == pCreateInfo->imageExtent.width && scaled.height == pCreateInfo->imageExtent.height)
+                    modifiedCreateInfo.imageExtent = capabilities.currentExtent;
+            }
+        }
+        bool upscaled = modifiedCreateInfo.imageExtent.width != pCreateInfo->imageExtent.width
+                        || modifiedCreateInfo.imageExtent.height != pCreateInfo->imageExtent.height;
+        if (upscaled)
+            Logger::info("rendering at " + std::to_string(pCreateInfo->imageExtent.width) + "x" + std::to_string(pCreateInfo->imageExtent.height)
+                         + ", upscaling to " + std::to_string(modifiedCreateInfo.imageExtent.width) + "x"
+                         + std::to_string(modifiedCreateInfo.imageExtent.height));
+
+        // With effects off the application can render into the swapchain itself, it then needs its own usage flags
+        // An upscaled swapchain never does, the application image is smaller than the swapchain
+        bool bypass = settingsManager.getBypassWhenDisabled() && !presentEffect && !upscaled;
+        if (bypass)
+            modifiedCreateInfo.imageUsage |= pCreateInfo->imageUsage;
+
         Logger::debug("format " + std::to_string(modifiedCreateInfo.imageFormat));
         std::shared_ptr<LogicalSwapchain> pLogicalSwapchain(new LogicalSwapchain());
+        pLogicalSwapchain->bypass              = bypass;
         pLogicalSwapchain->pLogicalDevice      = pLogicalDevice;
         pLogicalSwapchain->swapchainCreateInfo = *pCreateInfo;
-        pLogicalSwapchain->imageExtent         = modifiedCreateInfo.imageExtent;
+        pLogicalSwapchain->imageExtent         = pCreateInfo->imageExtent;
+        pLogicalSwapchain->outputExtent        = modifiedCreateInfo.imageExtent;
         pLogicalSwapchain->format              = modifiedCreateInfo.imageFormat;
         pLogicalSwapchain->imageCount          = 0;
 
@@ -916,10 +1428,11 @@ namespace vkBasalt
         LogicalSwapchain* pLogicalSwapchain = swapchainMap[swapchain].get();
 
         // If the images got already requested once, return them again instead of creating new images
-        if (pLogicalSwapchain->fakeImages.size())
+        const std::vector<VkImage>& applicationImages = pLogicalSwapchain->bypass ? pLogicalSwapchain->images : pLogicalSwapchain->fakeImages;
+        if (applicationImages.size())
         {
             *pCount = std::min<uint32_t>(*pCount, pLogicalSwapchain->imageCount);
-            std::memcpy(pSwapchainImages, pLogicalSwapchain->fakeImages.data(), sizeof(VkImage) * (*pCount));
+            std::memcpy(pSwapchainImages, applicationImages.data(), sizeof(VkImage) * (*pCount));
             return *pCount < pLogicalSwapchain->imageCount ? VK_INCOMPLETE : VK_SUCCESS;
         }
 
@@ -949,6 +1462,19 @@ namespace vkBasalt
         if (isFirstRun)
             effectRegistry.initializeSelectedEffectsFromConfig();
 
+        if (pLogicalSwapchain->bypass)
+        {
+            // Nothing to copy, the application renders into the swapchain and only the overlay draws on top
+            Logger::info("effects are off, handing the swapchain images to the application");
+            pLogicalSwapchain->semaphores        = createSemaphores(pLogicalDevice, pLogicalSwapchain->imageCount);
+            pLogicalSwapchain->overlaySemaphores = createSemaphores(pLogicalDevice, pLogicalSwapchain->imageCount);
+            createOverlay(pLogicalDevice, pLogicalSwapchain);
+
+            *pCount = std::min<uint32_t>(*pCount, pLogicalSwapchain->imageCount);
+            std::memcpy(pSwapchainImages, pLogicalSwapchain->images.data(), sizeof(VkImage) * (*pCount));
+            return *pCount < pLogicalSwapchain->imageCount ? VK_INCOMPLETE : VK_SUCCESS;
+        }
+
         const auto& selectedEffects = effectRegistry.getSelectedEffects();
 
         // Allow dynamic effect loading by allocating for more effects than configured
@@ -958,10 +1484,13 @@ namespace vkBasalt
         pLogicalSwapchain->maxEffectSlots = effectSlots;
 
         // create 1 more set of images when we can't use the swapchain it self
-        uint32_t fakeImageCount = pLogicalSwapchain->imageCount * (effectSlots + !pLogicalDevice->supportsMutableFormat);
+        uint32_t fakeImageCount = pLogicalSwapchain->imageCount * (effectSlots + needsFinalImages(pLogicalDevice, pLogicalSwapchain));
 
-        pLogicalSwapchain->fakeImages =
-            createFakeSwapchainImages(pLogicalDevice, pLogicalSwapchain->swapchainCreateInfo, fakeImageCount, pLogicalSwapchain->fakeImageMemory);
+        {
+            MemoryOwnerScope memoryOwner("Swapchain images");
+            pLogicalSwapchain->fakeImages = createFakeSwapchainImages(
+                pLogicalDevice, pLogicalSwapchain->swapchainCreateInfo, fakeImageCount, pLogicalSwapchain->fakeImageMemory);
+        }
         Logger::debug("created fake swapchain images");
 
         if (!isFirstRun && !selectedEffects.empty())
@@ -970,9 +1499,7 @@ namespace vkBasalt
             Logger::debug("using pass-through during resize, will restore effects after debounce");
             std::vector<VkImage> firstImages(pLogicalSwapchain->fakeImages.begin(),
                                              pLogicalSwapchain->fakeImages.begin() + pLogicalSwapchain->imageCount);
-            pLogicalSwapchain->effects.push_back(std::shared_ptr<Effect>(new TransferEffect(
-                pLogicalDevice, pLogicalSwapchain->format, pLogicalSwapchain->imageExtent,
-                firstImages, pLogicalSwapchain->images, pConfig.get())));
+            pLogicalSwapchain->effects.push_back(createFinalPass(pLogicalDevice, pLogicalSwapchain, firstImages, pConfig.get()));
 
             resizeDebounce.pending = true;
             resizeDebounce.lastResizeTime = std::chrono::steady_clock::now();
@@ -992,12 +1519,18 @@ namespace vkBasalt
         Logger::debug("allocated ComandBuffers " + std::to_string(pLogicalSwapchain->commandBuffersEffect.size()) + " for swapchain "
                       + convertToString(swapchain));
 
-        writeCommandBuffers(
-            pLogicalDevice, pLogicalSwapchain->effects, depth.image, depth.imageView, depth.format, pLogicalSwapchain->commandBuffersEffect);
+        writeCommandBuffers(pLogicalDevice,
+                            pLogicalSwapchain->effects,
+                            depth.image,
+                            depth.imageView,
+                            depth.format,
+                            pLogicalSwapchain->commandBuffersEffect,
+                            pLogicalSwapchain->linearDepth.get());
         Logger::debug("wrote CommandBuffers");
 
         pLogicalSwapchain->semaphores = createSemaphores(pLogicalDevice, pLogicalSwapchain->imageCount);
         pLogicalSwapchain->overlaySemaphores = createSemaphores(pLogicalDevice, pLogicalSwapchain->imageCount);
+        pLogicalSwapchain->frameValues.assign(pLogicalSwapchain->imageCount, 0);
         Logger::debug("created semaphores");
         for (unsigned int i = 0; i < pLogicalSwapchain->imageCount; i++)
         {
@@ -1005,13 +1538,11 @@ namespace vkBasalt
         }
         Logger::trace("vkGetSwapchainImagesKHR");
 
-        pLogicalSwapchain->defaultTransfer = std::shared_ptr<Effect>(new TransferEffect(
+        pLogicalSwapchain->defaultTransfer = createFinalPass(
             pLogicalDevice,
-            pLogicalSwapchain->format,
-            pLogicalSwapchain->imageExtent,
+            pLogicalSwapchain,
             std::vector<VkImage>(pLogicalSwapchain->fakeImages.begin(), pLogicalSwapchain->fakeImages.begin() + pLogicalSwapchain->imageCount),
-            pLogicalSwapchain->images,
-            pConfig.get()));
+            pConfig.get());
 
         pLogicalSwapchain->commandBuffersNoEffect = allocateCommandBuffer(pLogicalDevice, pLogicalSwapchain->imageCount);
 
@@ -1027,26 +1558,7 @@ namespace vkBasalt
             Logger::debug(std::to_string(i) + " written commandbuffer " + convertToString(pLogicalSwapchain->commandBuffersNoEffect[i]));
         }
 
-        // Create ImGui overlay at device level (if not already created)
-        // This survives swapchain recreation during resize
-        if (!pLogicalDevice->imguiOverlay)
-        {
-            if (!pLogicalDevice->overlayPersistentState)
-                pLogicalDevice->overlayPersistentState = std::make_unique<OverlayPersistentState>();
-            pLogicalDevice->imguiOverlay = std::make_unique<ImGuiOverlay>(
-                pLogicalDevice, pLogicalSwapchain->format, pLogicalSwapchain->imageCount,
-                pLogicalDevice->overlayPersistentState.get());
-            // Set the effect registry pointer (single source of truth for enabled states)
-            pLogicalDevice->imguiOverlay->setEffectRegistry(&effectRegistry);
-
-            // Initialize input blocking (grabs all input when overlay is visible)
-            static bool inputBlockerInited = false;
-            if (!inputBlockerInited)
-            {
-                initInputBlocker(settingsManager.getOverlayBlockInput());
-                inputBlockerInited = true;
-            }
-        }
+        createOverlay(pLogicalDevice, pLogicalSwapchain);
 
         *pCount = std::min<uint32_t>(*pCount, pLogicalSwapchain->imageCount);
         std::memcpy(pSwapchainImages, pLogicalSwapchain->fakeImages.data(), sizeof(VkImage) * (*pCount));
@@ -1064,7 +1576,6 @@ namespace vkBasalt
         static bool initLogged = false;
 
         static bool pressed       = false;
-        static bool presentEffect = settingsManager.getEnableOnLaunch();
         static bool reloadPressed = false;
         static bool overlayPressed = false;
 
@@ -1133,11 +1644,11 @@ namespace vkBasalt
         if (pLogicalDevice->imguiOverlay && pLogicalDevice->imguiOverlay->hasModifiedParams())
         {
             // If we're loading a new config, don't apply old params - just trigger reload
-            if (!pLogicalDevice->imguiOverlay->hasPendingConfig())
-                applyOverlayParams(pLogicalDevice);
+            bool applied = !shouldReload && !pLogicalDevice->imguiOverlay->hasPendingConfig() && applyOverlayParams(pLogicalDevice);
 
             pLogicalDevice->imguiOverlay->clearApplyRequest();
-            shouldReload = true;
+            if (!applied)
+                shouldReload = true;
         }
 
         if (shouldReload)
@@ -1147,6 +1658,13 @@ namespace vkBasalt
             // Check if overlay wants to load a different config
             if (pLogicalDevice->imguiOverlay && pLogicalDevice->imguiOverlay->hasPendingConfig())
             {
+                // Latency stats are kept per config, so presets can be compared in the log
+                if (pLogicalDevice->presentLatency)
+                {
+                    pLogicalDevice->presentLatency->logSummary(pConfig->getConfigFilePath());
+                    pLogicalDevice->presentLatency->reset();
+                }
+
                 std::string newConfigPath = pLogicalDevice->imguiOverlay->getPendingConfigPath();
                 switchConfig(newConfigPath);
                 // Update overlay with effects from the new config
@@ -1189,54 +1707,257 @@ namespace vkBasalt
             }
         }
 
+        // Time, input and date for ReShade uniforms, sampled once so every effect sees the same frame
+        updateFrameUniforms(!pLogicalDevice->depthImageViews.empty());
+
         std::vector<VkSemaphore> presentSemaphores;
         presentSemaphores.reserve(pPresentInfo->swapchainCount);
 
-        std::vector<VkPipelineStageFlags> waitStages(pPresentInfo->waitSemaphoreCount, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+        uint32_t           waitSemaphoreCount = pPresentInfo->waitSemaphoreCount;
+        const VkSemaphore* pWaitSemaphores    = pPresentInfo->pWaitSemaphores;
+
+        // A present without wait semaphores relies on the order of the application's queue,
+        // carry that over to the dedicated queue with a semaphore
+        if (waitSemaphoreCount == 0 && queue != pLogicalDevice->queue && pLogicalDevice->dedicatedQueue)
+        {
+            VkSubmitInfo handoffSubmit         = {};
+            handoffSubmit.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            handoffSubmit.signalSemaphoreCount = 1;
+            handoffSubmit.pSignalSemaphores    = &pLogicalDevice->queueHandoffSemaphore;
+
+            VkResult vr = pLogicalDevice->vkd.QueueSubmit(queue, 1, &handoffSubmit, VK_NULL_HANDLE);
+            if (vr != VK_SUCCESS)
+                return vr;
+
+            waitSemaphoreCount = 1;
+            pWaitSemaphores    = &pLogicalDevice->queueHandoffSemaphore;
+        }
+
+        // The overlay on a bypassed swapchain may be the first thing waiting on these
+        std::vector<VkPipelineStageFlags> waitStages(
+            waitSemaphoreCount, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+
+        // The application's semaphores are waited on by the first effect batch only, a wait orders nothing but its own batch.
+        // The overlay on a bypassed image waits on them or on the semaphore of the batch that took them.
+        // If every swapchain is bypassed and the overlay is hidden the present waits on them itself
+        uint32_t pendingWaitCount = waitSemaphoreCount;
+        int32_t  appWaitSwapchain = -1;  // the swapchain whose effect batch waits on the application's semaphores
+
+        bool wantBypass = settingsManager.getBypassWhenDisabled() && !presentEffect;
+        std::vector<bool> needsRecreate(pPresentInfo->swapchainCount, false);
+
+        // Frame level work, the overlay state does not depend on the swapchain
+        updateOverlayState(pLogicalDevice, presentEffect);
+
+        // Destroys what earlier submissions left behind once the GPU is done with it
+        pLogicalDevice->frameTimeline->collect();
+
+        // -1 if latency stats are off or every slot is still in flight
+        PresentLatencyTracker* pLatency    = pLogicalDevice->presentLatency.get();
+        int32_t                latencySlot = pLatency ? pLatency->beginFrame() : -1;
+
+        ChainProfiler* pProfiler = pLogicalDevice->chainProfiler.get();
+        bool           profiling = false;
+
+        // One batch per swapchain, all submitted at once
+        std::vector<VkSubmitInfo> effectSubmits;
+        effectSubmits.reserve(pPresentInfo->swapchainCount);
 
         for (unsigned int i = 0; i < pPresentInfo->swapchainCount; i++)
         {
             uint32_t          index             = pPresentInfo->pImageIndices[i];
-            VkSwapchainKHR    swapchain         = pPresentInfo->pSwapchains[i];
-            LogicalSwapchain* pLogicalSwapchain = swapchainMap[swapchain].get();
+            LogicalSwapchain* pLogicalSwapchain = swapchainMap[pPresentInfo->pSwapchains[i]].get();
+
+            needsRecreate[i] = pLogicalSwapchain->bypass != (wantBypass && !isUpscaled(pLogicalSwapchain));
+            if (pLogicalSwapchain->bypass)
+            {
+                presentSemaphores.push_back(VK_NULL_HANDLE);
+                continue;
+            }
 
-            // Update all effects for this frame
-            for (auto& effect : pLogicalSwapchain->effects)
-                effect->updateEffect();
+            // A requested profile replaces the effect command buffer of one swapchain for this frame.
+            // It may swap in saved uniforms, so it's recorded before the effects copy them
+            VkCommandBuffer profileCommandBuffer = VK_NULL_HANDLE;
+            if (presentEffect && pProfiler && pProfiler->hasRequest() && !profiling)
+            {
+                DepthState depth     = getDepthState(pLogicalDevice);
+                profileCommandBuffer = pProfiler->record(pLogicalSwapchain, index, depth.image, depth.imageView, depth.format);
+                profiling            = profileCommandBuffer != VK_NULL_HANDLE;
+            }
+
+            // Uniforms are only read by the effect command buffers, each image has its own copy.
+            // Its last frame has almost always finished when the application got the image again
+            if (presentEffect)
+            {
+                pLogicalDevice->frameTimeline->wait(pLogicalSwapchain->frameValues[index]);
+                for (auto& effect : pLogicalSwapchain->effects)
+                    effect->updateEffect(index);
+            }
 
-            // Submit effect command buffer
             VkSubmitInfo submitInfo = {};
             submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-            submitInfo.waitSemaphoreCount = i == 0 ? pPresentInfo->waitSemaphoreCount : 0;
-            submitInfo.pWaitSemaphores    = i == 0 ? pPresentInfo->pWaitSemaphores : nullptr;
-            submitInfo.pWaitDstStageMask  = i == 0 ? waitStages.data() : nullptr;
+            submitInfo.waitSemaphoreCount = pendingWaitCount;
+            submitInfo.pWaitSemaphores    = pendingWaitCount ? pWaitSemaphores : nullptr;
+            submitInfo.pWaitDstStageMask  = pendingWaitCount ? waitStages.data() : nullptr;
             submitInfo.commandBufferCount = 1;
-            submitInfo.pCommandBuffers    = presentEffect
-                ? &pLogicalSwapchain->commandBuffersEffect[index]
+            submitInfo.pCommandBuffers    = profileCommandBuffer ? pProfiler->getCommandBufferPointer()
+                : presentEffect ? &pLogicalSwapchain->commandBuffersEffect[index]
                 : &pLogicalSwapchain->commandBuffersNoEffect[index];
             submitInfo.signalSemaphoreCount = 1;
             submitInfo.pSignalSemaphores    = &pLogicalSwapchain->semaphores[index];
+            effectSubmits.push_back(submitInfo);
+            if (pendingWaitCount)
+                appWaitSwapchain = i;
+            pendingWaitCount = 0;
+
+            presentSemaphores.push_back(pLogicalSwapchain->semaphores[index]);
+        }
 
-            VkResult vr = pLogicalDevice->vkd.QueueSubmit(pLogicalDevice->queue, 1, &submitInfo, VK_NULL_HANDLE);
+        // The start timestamp goes in front of the first effect batch, after the application's semaphores
+        VkCommandBuffer latencyCommandBuffers[2];
+        bool            latencyGpuWork = latencySlot >= 0 && !effectSubmits.empty();
+        if (latencyGpuWork)
+        {
+            latencyCommandBuffers[0]            = pLatency->getBeginCommandBuffer(latencySlot);
+            latencyCommandBuffers[1]            = effectSubmits[0].pCommandBuffers[0];
+            effectSubmits[0].commandBufferCount = 2;
+            effectSubmits[0].pCommandBuffers    = latencyCommandBuffers;
+        }
+
+        // The last batch completes after all the others, its timeline value covers the whole frame
+        if (!effectSubmits.empty())
+        {
+            uint64_t frameValue;
+            VkResult vr = pLogicalDevice->frameTimeline->submit(
+                effectSubmits.size(), effectSubmits.data(), profiling ? pProfiler->getFence() : VK_NULL_HANDLE, frameValue);
             if (vr != VK_SUCCESS)
+            {
+                if (profiling)
+                    pProfiler->abort();
+                if (latencySlot >= 0)
+                    pLatency->cancelFrame(latencySlot);
                 return vr;
+            }
 
-            // Update and render overlay
-            updateOverlayState(pLogicalDevice, presentEffect);
+            for (unsigned int i = 0; i < pPresentInfo->swapchainCount; i++)
+            {
+                LogicalSwapchain* pLogicalSwapchain = swapchainMap[pPresentInfo->pSwapchains[i]].get();
+                if (!pLogicalSwapchain->bypass)
+                    pLogicalSwapchain->frameValues[pPresentInfo->pImageIndices[i]] = frameValue;
+            }
+        }
+
+        // Stalls this one frame, the profile has to be read back before the overlay shows it
+        if (profiling)
+            pProfiler->finish();
 
-            VkSemaphore finalSemaphore;
-            vr = submitOverlayFrame(pLogicalDevice, pLogicalSwapchain, index, finalSemaphore);
+        // The overlay is a single ImGui frame, draw it on the first swapchain only
+        if (pPresentInfo->swapchainCount > 0)
+        {
+            uint32_t          index             = pPresentInfo->pImageIndices[0];
+            LogicalSwapchain* pLogicalSwapchain = swapchainMap[pPresentInfo->pSwapchains[0]].get();
+
+            uint32_t           overlayWaitCount = 1;
+            const VkSemaphore* pOverlayWaits    = &pLogicalSwapchain->semaphores[index];
+            if (pLogicalSwapchain->bypass)
+            {
+                // The image is the application's, a later swapchain's batch may have taken its semaphores.
+                // The overlay then waits on that batch and the present on the overlay instead
+                overlayWaitCount = appWaitSwapchain >= 0 ? 1 : pendingWaitCount;
+                pOverlayWaits    = appWaitSwapchain >= 0 ? &presentSemaphores[appWaitSwapchain] : pWaitSemaphores;
+            }
+
+            VkSemaphore overlaySemaphore;
+            VkResult    vr = submitOverlayFrame(pLogicalDevice, pLogicalSwapchain, index, overlayWaitCount, pOverlayWaits, overlaySemaphore);
             if (vr != VK_SUCCESS)
+            {
+                if (latencySlot >= 0)
+                    pLatency->cancelFrame(latencySlot);
                 return vr;
+            }
+
+            if (overlaySemaphore != VK_NULL_HANDLE)
+            {
+                presentSemaphores[0] = overlaySemaphore;
+                if (pLogicalSwapchain->bypass && appWaitSwapchain >= 0)
+                    presentSemaphores[appWaitSwapchain] = VK_NULL_HANDLE;
+                else if (pLogicalSwapchain->bypass)
+                    pendingWaitCount = 0;
+            }
+        }
 
-            presentSemaphores.push_back(finalSemaphore);
+        if (latencyGpuWork)
+        {
+            VkResult vr = pLatency->submitEnd(latencySlot);
+            if (vr != VK_SUCCESS)
+            {
+                pLatency->cancelFrame(latencySlot);
+                return vr;
+            }
         }
 
+        // Bypassed swapchains without overlay have nothing to wait on
+        presentSemaphores.erase(std::remove(presentSemaphores.begin(), presentSemaphores.end(), VK_NULL_HANDLE), presentSemaphores.end());
+        presentSemaphores.insert(presentSemaphores.end(), pWaitSemaphores, pWaitSemaphores + pendingWaitCount);
+
         VkPresentInfoKHR presentInfo   = *pPresentInfo;
         presentInfo.waitSemaphoreCount = presentSemaphores.size();
         presentInfo.pWaitSemaphores    = presentSemaphores.data();
 
-        return pLogicalDevice->vkd.QueuePresentKHR(queue, &presentInfo);
+        // Tag the presents so the latency thread can wait for them to be shown.
+        // If the application tags them itself its ids are used, ours continue above them
+        VkPresentIdKHR        presentIdInfo = {};
+        std::vector<uint64_t> presentIds;
+        uint64_t              latencyPresentId = 0;
+        if (latencySlot >= 0 && pLatency->supportsPresentWait())
+        {
+            const VkPresentIdKHR* pAppPresentId = nullptr;
+            for (auto* pNext = static_cast<const VkBaseInStructure*>(pPresentInfo->pNext); pNext; pNext = pNext->pNext)
+            {
+                if (pNext->sType == VK_STRUCTURE_TYPE_PRESENT_ID_KHR)
+                    pAppPresentId = reinterpret_cast<const VkPresentIdKHR*>(pNext);
+            }
+
+            for (uint32_t i = 0; i < pPresentInfo->swapchainCount; i++)
+            {
+                uint64_t& presentId = swapchainMap[pPresentInfo->pSwapchains[i]]->presentId;
+                if (pAppPresentId)
+                    presentId = std::max(presentId, pAppPresentId->pPresentIds ? pAppPresentId->pPresentIds[i] : 0);
+                else
+                    presentIds.push_back(++presentId);
+            }
+
+            if (pAppPresentId)
+            {
+                latencyPresentId = pAppPresentId->pPresentIds ? pAppPresentId->pPresentIds[0] : 0;
+            }
+            else if (!presentIds.empty())
+            {
+                presentIdInfo.sType          = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+                presentIdInfo.pNext          = presentInfo.pNext;
+                presentIdInfo.swapchainCount = presentIds.size();
+                presentIdInfo.pPresentIds    = presentIds.data();
+                presentInfo.pNext            = &presentIdInfo;
+                latencyPresentId             = presentIds[0];
+            }
+        }
+
+        VkResult result = pLogicalDevice->vkd.QueuePresentKHR(queue, &presentInfo);
+
+        if (latencySlot >= 0)
+            pLatency->submitPresent(latencySlot, pPresentInfo->pSwapchains[0], result >= 0 ? latencyPresentId : 0);
+
+        // Effects got toggled while bypassWhenDisabled is on, ask for a new swapchain in the other mode
+        for (unsigned int i = 0; i < pPresentInfo->swapchainCount; i++)
+        {
+            if (!needsRecreate[i])
+                continue;
+            if (pPresentInfo->pResults && pPresentInfo->pResults[i] == VK_SUCCESS)
+                pPresentInfo->pResults[i] = VK_SUBOPTIMAL_KHR;
+            if (result == VK_SUCCESS)
+                result = VK_SUBOPTIMAL_KHR;
+        }
+        return result;
     }
 
     VKAPI_ATTR void VKAPI_CALL vkBasalt_DestroySwapchainKHR(VkDevice device, VkSwapchainKHR swapchain, const VkAllocationCallbacks* pAllocator)
@@ -1252,6 +1973,9 @@ namespace vkBasalt
         swapchainMap.erase(swapchain);
         LogicalDevice* pLogicalDevice = deviceMap[GetKey(device)].get();
 
+        if (pLogicalDevice->presentLatency)
+            pLogicalDevice->presentLatency->forgetSwapchain(swapchain);
+
         pLogicalDevice->vkd.DestroySwapchainKHR(device, swapchain, pAllocator);
     }
 
@@ -1393,6 +2117,27 @@ namespace vkBasalt
         return vkBasalt_EnumerateInstanceLayerProperties(pPropertyCount, pProperties);
     }
 
+    VKAPI_ATTR VkResult VKAPI_CALL vkBasalt_GetPhysicalDeviceSurfaceCapabilitiesKHR(VkPhysicalDevice          physicalDevice,
+                                                                                    VkSurfaceKHR              surface,
+                                                                                    VkSurfaceCapabilitiesKHR* pSurfaceCapabilities)
+    {
+        scoped_lock l(globalLock);
+
+        VkResult result =
+            instanceDispatchMap[GetKey(physicalDevice)].GetPhysicalDeviceSurfaceCapabilitiesKHR(physicalDevice, surface, pSurfaceCapabilities);
+
+        // Report the reduced render extent, CreateSwapchainKHR swaps it back for the real one
+        float renderScale = getRenderScale();
+        if (result == VK_SUCCESS && renderScale < 1.0f && pSurfaceCapabilities->currentExtent.width != 0xFFFFFFFF)
+        {
+            VkExtent2D scaled = scaleExtent(pSurfaceCapabilities->currentExtent, renderScale);
+            pSurfaceCapabilities->currentExtent  = scaled;
+            pSurfaceCapabilities->minImageExtent = {std::min(pSurfaceCapabilities->minImageExtent.width, scaled.width),
+                                                    std::min(pSurfaceCapabilities->minImageExtent.height, scaled.height)};
+        }
+        return result;
+    }
+
     VkResult VKAPI_CALL vkBasalt_EnumerateInstanceExtensionProperties(const char*            pLayerName,
                                                                       uint32_t*              pPropertyCount,
                                                                       VkExtensionProperties* pProperties)
@@ -1443,48 +2188,80 @@ extern "C"
     VK_BASALT_EXPORT PFN_vkVoidFunction VKAPI_CALL vkBasalt_GetDeviceProcAddr(VkDevice device, const char* pName);
     VK_BASALT_EXPORT PFN_vkVoidFunction VKAPI_CALL vkBasalt_GetInstanceProcAddr(VkInstance instance, const char* pName);
 
-#define GETPROCADDR(func) \
-    if (!std::strcmp(pName, "vk" #func)) \
-        return (PFN_vkVoidFunction) &vkBasalt::vkBasalt_##func;
-    /*
-    Return our funktions for the funktions we want to intercept
-    the macro takes the name and returns our vkBasalt_##func, if the name is equal
-    */
+} // extern "C"
 
-    // vkGetDeviceProcAddr needs to behave like vkGetInstanceProcAddr thanks to some games
+namespace vkBasalt
+{
+    // vkGetDeviceProcAddr needs to behave like vkGetInstanceProcAddr thanks to some games,
+    // so both look up the same table
 #define INTERCEPT_CALLS \
     /* instance chain functions we intercept */ \
-    if (!std::strcmp(pName, "vkGetInstanceProcAddr")) \
-        return (PFN_vkVoidFunction) &vkBasalt_GetInstanceProcAddr; \
-    GETPROCADDR(EnumerateInstanceLayerProperties); \
-    GETPROCADDR(EnumerateInstanceExtensionProperties); \
-    GETPROCADDR(CreateInstance); \
-    GETPROCADDR(DestroyInstance); \
+    INTERCEPT(GetInstanceProcAddr) \
+    INTERCEPT(EnumerateInstanceLayerProperties) \
+    INTERCEPT(EnumerateInstanceExtensionProperties) \
+    INTERCEPT(CreateInstance) \
+    INTERCEPT(DestroyInstance) \
+    INTERCEPT(GetPhysicalDeviceSurfaceCapabilitiesKHR) \
 \
     /* device chain functions we intercept*/ \
-    if (!std::strcmp(pName, "vkGetDeviceProcAddr")) \
-        return (PFN_vkVoidFunction) &vkBasalt_GetDeviceProcAddr; \
-    GETPROCADDR(EnumerateDeviceLayerProperties); \
-    GETPROCADDR(EnumerateDeviceExtensionProperties); \
-    GETPROCADDR(CreateDevice); \
-    GETPROCADDR(DestroyDevice); \
-    GETPROCADDR(CreateSwapchainKHR); \
-    GETPROCADDR(GetSwapchainImagesKHR); \
-    GETPROCADDR(QueuePresentKHR); \
-    GETPROCADDR(DestroySwapchainKHR); \
-\
-    if (vkBasalt::settingsManager.getDepthCapture()) \
-    { \
-        GETPROCADDR(CreateImage); \
-        GETPROCADDR(DestroyImage); \
-        GETPROCADDR(BindImageMemory); \
-    }
+    INTERCEPT(GetDeviceProcAddr) \
+    INTERCEPT(EnumerateDeviceLayerProperties) \
+    INTERCEPT(EnumerateDeviceExtensionProperties) \
+    INTERCEPT(CreateDevice) \
+    INTERCEPT(DestroyDevice) \
+    INTERCEPT(CreateSwapchainKHR) \
+    INTERCEPT(GetSwapchainImagesKHR) \
+    INTERCEPT(QueuePresentKHR) \
+    INTERCEPT(DestroySwapchainKHR)
+
+    // only intercepted while depthCapture is on, must stay at the end of the table
+#define INTERCEPT_DEPTH_CALLS \
+    INTERCEPT(CreateImage) \
+    INTERCEPT(DestroyImage) \
+    INTERCEPT(BindImageMemory)
+
+    namespace
+    {
+#define INTERCEPT(func) "vk" #func,
+        constexpr std::string_view interceptNames[] = {INTERCEPT_CALLS INTERCEPT_DEPTH_CALLS};
+#undef INTERCEPT
 
+#define INTERCEPT(func) reinterpret_cast<PFN_vkVoidFunction>(&vkBasalt_##func),
+        const PFN_vkVoidFunction interceptFuncs[] = {INTERCEPT_CALLS INTERCEPT_DEPTH_CALLS};
+#undef INTERCEPT
+
+#define INTERCEPT(func) +1
+        constexpr size_t depthInterceptCount = 0 INTERCEPT_DEPTH_CALLS;
+#undef INTERCEPT
+
+        constexpr size_t interceptCount = std::size(interceptNames);
+        constexpr auto   interceptTable = makePerfectHashTable<64>(interceptNames);
+        static_assert(interceptTable.found, "no collision free seed for the intercepted function names");
+
+        // Return our functions for the functions we want to intercept, nullptr for everything else
+        PFN_vkVoidFunction findIntercept(const char* pName)
+        {
+            int32_t index = interceptTable.find(interceptNames, pName);
+            if (index < 0)
+                return nullptr;
+            if ((size_t) index >= interceptCount - depthInterceptCount && !settingsManager.getDepthCapture())
+                return nullptr;
+            return interceptFuncs[index];
+        }
+    } // namespace
+} // namespace vkBasalt
+
+extern "C"
+{
     VK_BASALT_EXPORT PFN_vkVoidFunction VKAPI_CALL vkBasalt_GetDeviceProcAddr(VkDevice device, const char* pName)
     {
-        vkBasalt::initConfigs();
+        std::call_once(vkBasalt::configsInitFlag, vkBasalt::initConfigs);
 
-        INTERCEPT_CALLS
+        if (PFN_vkVoidFunction intercepted = vkBasalt::findIntercept(pName))
+            return intercepted;
+
+        if (PFN_vkGetDeviceProcAddr next = vkBasalt::deviceProcAddrCache.find(vkBasalt::GetKey(device)))
+            return next(device, pName);
 
         {
             vkBasalt::scoped_lock l(vkBasalt::globalLock);
@@ -1494,9 +2271,13 @@ extern "C"
 
     VK_BASALT_EXPORT PFN_vkVoidFunction VKAPI_CALL vkBasalt_GetInstanceProcAddr(VkInstance instance, const char* pName)
     {
-        vkBasalt::initConfigs();
+        std::call_once(vkBasalt::configsInitFlag, vkBasalt::initConfigs);
+
+        if (PFN_vkVoidFunction intercepted = vkBasalt::findIntercept(pName))
+            return intercepted;
 
-        INTERCEPT_CALLS
+        if (PFN_vkGetInstanceProcAddr next = vkBasalt::instanceProcAddrCache.find(vkBasalt::GetKey(instance)))
+            return next(instance, pName);
 
         {
             vkBasalt::scoped_lock l(vkBasalt::globalLock);
@@ -0,0 +1,230 @@
+// Times the CPU load paths that run without a GPU: config parsing and lookup, a 65^3 lut cube,
+// the uniforms of an effect with 200 "source" uniforms and the shader directory scan over 5000 files.
+// Every case has a limit, the benchmark exits with 1 if one is over it. Run it with `meson test --benchmark`,
+// which turns the log down to errors so the config echo is not timed
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "config.hpp"
+#include "config_serializer.hpp"
+#include "lut_cube.hpp"
+#include "reshade_uniforms.hpp"
+
+namespace vkBasalt
+{
+    // basalt.cpp, which defines it for the layer, is not part of the benchmark
+    Logger Logger::s_instance;
+
+    namespace
+    {
+        constexpr int runCount = 9;
+
+        bool failed = false;
+
+        // Median of runCount runs, setup runs before each of them and is not timed
+        double medianMs(const std::function<void()>& setup, const std::function<void()>& run)
+        {
+            std::vector<double> times;
+            for (int i = 0; i < runCount; i++)
+            {
+                setup();
+                auto start = std::chrono::steady_clock::now();
+                run();
+                times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+            }
+            std::nth_element(times.begin(), times.begin() + times.size() / 2, times.end());
+            return times[times.size() / 2];
+        }
+
+        void report(const char* name, double ms, double limitMs, bool valid = true)
+        {
+            bool pass = valid && ms <= limitMs;
+            std::printf("%-40s %9.3f ms  (limit %7.1f ms)  %s\n", name, ms, limitMs, pass ? "ok" : valid ? "FAIL" : "FAIL (wrong result)");
+            failed |= !pass;
+        }
+
+        void benchConfig(const std::filesystem::path& dir)
+        {
+            constexpr int effectCount = 100;
+            constexpr int paramCount  = 20;
+
+            std::string   configPath = (dir / "vkBasalt.conf").string();
+            std::ofstream out(configPath);
+            out << "# generated by the load benchmark\n";
+            out << "effects = ";
+            for (int e = 0; e < effectCount; e++)
+                out << (e ? ":" : "") << "effect" << e;
+            out << "\n";
+            for (int e = 0; e < effectCount; e++)
+            {
+                out << "effect" << e << " = \"/usr/share/reshade/Shaders/Effect" << e << ".fx\"\n";
+                for (int p = 0; p < paramCount; p++)
+                    out << "effect" << e << ".param" << p << " = " << e * 0.01f + p << "   # comment\n";
+            }
+            out.close();
+
+            std::unique_ptr<Config> pConfig;
+            double parseMs = medianMs([&] { pConfig.reset(); }, [&] { pConfig = std::make_unique<Config>(configPath); });
+            report("config parse (2100 lines)", parseMs, 20.0);
+
+            float sum      = 0.0f;
+            double lookupMs = medianMs([&] { sum = 0.0f; },
+                                       [&] {
+                                           for (int e = 0; e < effectCount; e++)
+                                           {
+                                               std::string effectName = "effect" + std::to_string(e);
+                                               for (int p = 0; p < paramCount; p++)
+                                                   sum += pConfig->getInstanceOption<float>(effectName, "param" + std::to_string(p));
+                                           }
+                                       });
+            report("config getOption (2000 lookups)", lookupMs, 20.0, sum > 0.0f);
+        }
+
+        void benchLutCube(const std::filesystem::path& dir)
+        {
+            constexpr int size = 65;
+
+            std::string   cubePath = (dir / "bench.cube").string();
+            std::ofstream out(cubePath);
+            out << "TITLE \"load benchmark\"\nLUT_3D_SIZE " << size << "\n";
+            char line[64];
+            for (int b = 0; b < size; b++)
+            {
+                for (int g = 0; g < size; g++)
+                {
+                    for (int r = 0; r < size; r++)
+                    {
+                        std::snprintf(line, sizeof(line), "%.6f %.6f %.6f\n", r / (size - 1.0), g / (size - 1.0), b / (size - 1.0));
+                        out << line;
+                    }
+                }
+            }
+            out.close();
+
+            // XDG_CACHE_HOME points into dir, removing it makes every load parse the file again
+            std::filesystem::path cacheDir = dir / "cache";
+            int                   cubeSize = 0;
+
+            double parseMs = medianMs([&] { std::filesystem::remove_all(cacheDir); }, [&] { cubeSize = LutCube(cubePath).size; });
+            report("lut cube parse (65^3)", parseMs, 400.0, cubeSize == size);
+
+            double cachedMs = medianMs([&] { cubeSize = 0; }, [&] { cubeSize = LutCube(cubePath).size; });
+            report("lut cube from cache (65^3)", cachedMs, 40.0, cubeSize == size);
+        }
+
+        void benchUniforms()
+        {
+            constexpr uint32_t uniformCount  = 200;
+            constexpr uint32_t uniformStride = 16;
+
+            const char* sources[] = {"frametime", "framecount", "date", "timer", "pingpong", "random", "bufready_depth"};
+
+            reshadefx::module module;
+            for (uint32_t i = 0; i < uniformCount; i++)
+            {
+                reshadefx::annotation source;
+                source.type.base         = reshadefx::type::t_string;
+                source.name              = "source";
+                source.value.string_data = sources[i % std::size(sources)];
+
+                reshadefx::annotation max;
+                max.type.base           = reshadefx::type::t_float;
+                max.type.rows           = 1;
+                max.type.cols           = 1;
+                max.name                = "max";
+                max.value.as_float[0]   = 1.0f;
+
+                reshadefx::uniform_info uniform;
+                uniform.name        = "uniform" + std::to_string(i);
+                uniform.type.base   = reshadefx::type::t_float;
+                uniform.type.rows   = 4;
+                uniform.type.cols   = 1;
+                uniform.size        = uniformStride;
+                uniform.offset      = i * uniformStride;
+                uniform.annotations = {source, max};
+                module.uniforms.push_back(uniform);
+            }
+            module.total_uniform_size = uniformCount * uniformStride;
+
+            std::unique_ptr<ReshadeUniforms> pUniforms;
+            double createMs = medianMs([&] { pUniforms.reset(); }, [&] { pUniforms = std::make_unique<ReshadeUniforms>(module); });
+            report("uniforms create (200)", createMs, 5.0);
+
+            constexpr int         frameCount = 1000;
+            std::vector<uint8_t>  buffer(module.total_uniform_size);
+            FrameUniforms         frame;
+            double updateMs = medianMs([] {},
+                                       [&] {
+                                           for (int i = 0; i < frameCount; i++)
+                                           {
+                                               frame.frameCount = i;
+                                               frame.timer      = i * 16.6f;
+                                               pUniforms->update(buffer.data(), frame);
+                                           }
+                                       });
+            report("uniforms update (200, 1000 frames)", updateMs, 50.0);
+        }
+
+        void benchShaderScan(const std::filesystem::path& dir)
+        {
+            // 100 packages with 25 shaders and 25 textures each
+            constexpr int packageCount = 100;
+            constexpr int filesPerDir  = 25;
+
+            std::filesystem::path reshadeDir = dir / "vkBasalt-overlay" / "reshade";
+            for (int p = 0; p < packageCount; p++)
+            {
+                std::filesystem::path package = reshadeDir / ("package" + std::to_string(p));
+                std::filesystem::create_directories(package / "Shaders");
+                std::filesystem::create_directories(package / "Textures");
+                for (int f = 0; f < filesPerDir; f++)
+                {
+                    std::ofstream(package / "Shaders" / ("Effect" + std::to_string(f) + ".fx")) << "// bench\n";
+                    std::ofstream(package / "Textures" / ("Texture" + std::to_string(f) + ".png")) << "bench";
+                }
+            }
+
+            // Without shader_manager.conf the default reshade directory is scanned
+            std::filesystem::path managerConfig = dir / "vkBasalt-overlay" / "shader_manager.conf";
+            ShaderManagerConfig   config;
+
+            double scanMs = medianMs([&] { std::filesystem::remove(managerConfig); }, [&] { config = ConfigSerializer::loadShaderManagerConfig(); });
+            bool   valid  = config.discoveredShaderPaths.size() == packageCount + 1 && config.discoveredTexturePaths.size() == packageCount + 1;
+            report("shader scan (5000 files)", scanMs, 200.0, valid);
+        }
+    } // namespace
+} // namespace vkBasalt
+
+int main()
+{
+    using namespace vkBasalt;
+
+    char tempTemplate[] = "/tmp/vkbasalt-bench-XXXXXX";
+    if (!mkdtemp(tempTemplate))
+    {
+        std::perror("mkdtemp");
+        return 1;
+    }
+    std::filesystem::path dir = tempTemplate;
+
+    // Keep the caches and configs of the user untouched
+    setenv("XDG_CACHE_HOME", (dir / "cache").c_str(), 1);
+    setenv("XDG_CONFIG_HOME", dir.c_str(), 1);
+
+    benchConfig(dir);
+    benchLutCube(dir);
+    benchUniforms();
+    benchShaderScan(dir);
+
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+
+    return failed ? 1 : 0;
+}
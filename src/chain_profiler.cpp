@@ -0,0 +1,372 @@
+#include "chain_profiler.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "buffer.hpp"
+#include "command_buffer.hpp"
+#include "config_serializer.hpp"
+#include "logical_device.hpp"
+#include "logical_swapchain.hpp"
+#include "logger.hpp"
+#include "memory.hpp"
+
+namespace vkBasalt
+{
+    namespace
+    {
+        // Bumped whenever FrameUniforms changes, the header stores it as is
+        constexpr char captureMagic[8] = "VKBCAP2";
+
+        // Swapchain formats are 8 or 10 bit per channel packed into 32 bit, or 16 bit float
+        uint32_t bytesPerPixel(VkFormat format)
+        {
+            switch (format)
+            {
+                case VK_FORMAT_R16G16B16A16_SFLOAT:
+                case VK_FORMAT_R16G16B16A16_UNORM: return 8;
+                default: return 4;
+            }
+        }
+
+        const char* modeName(ChainProfileMode mode)
+        {
+            switch (mode)
+            {
+                case ChainProfileMode::SaveFrame: return "current frame, saved";
+                case ChainProfileMode::SavedFrame: return "saved frame";
+                default: return "current frame";
+            }
+        }
+    } // namespace
+
+    ChainProfiler::ChainProfiler(LogicalDevice* pLogicalDevice) : pLogicalDevice(pLogicalDevice)
+    {
+        uint32_t familyCount = 0;
+        pLogicalDevice->vki.GetPhysicalDeviceQueueFamilyProperties(pLogicalDevice->physicalDevice, &familyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> queueProperties(familyCount);
+        pLogicalDevice->vki.GetPhysicalDeviceQueueFamilyProperties(pLogicalDevice->physicalDevice, &familyCount, queueProperties.data());
+
+        VkPhysicalDeviceProperties deviceProperties;
+        pLogicalDevice->vki.GetPhysicalDeviceProperties(pLogicalDevice->physicalDevice, &deviceProperties);
+
+        uint32_t validBits = pLogicalDevice->queueFamilyIndex < familyCount ? queueProperties[pLogicalDevice->queueFamilyIndex].timestampValidBits : 0;
+        timestampMask      = validBits == 0 ? 0 : validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+        timestampPeriod    = deviceProperties.limits.timestampPeriod;
+
+        commandBuffer = allocateCommandBuffer(pLogicalDevice, 1)[0];
+
+        VkFenceCreateInfo fenceCreateInfo = {};
+        fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        VkResult result = pLogicalDevice->vkd.CreateFence(pLogicalDevice->device, &fenceCreateInfo, nullptr, &fence);
+        ASSERT_VULKAN(result);
+    }
+
+    ChainProfiler::~ChainProfiler()
+    {
+        // The application has to wait for the device before destroying it, nothing is in flight any more
+        pLogicalDevice->vkd.DestroyFence(pLogicalDevice->device, fence, nullptr);
+        pLogicalDevice->vkd.FreeCommandBuffers(pLogicalDevice->device, pLogicalDevice->commandPool, 1, &commandBuffer);
+        if (queryPool != VK_NULL_HANDLE)
+            pLogicalDevice->vkd.DestroyQueryPool(pLogicalDevice->device, queryPool, nullptr);
+        if (stagingBuffer != VK_NULL_HANDLE)
+        {
+            pLogicalDevice->vkd.DestroyBuffer(pLogicalDevice->device, stagingBuffer, nullptr);
+            freeMemory(pLogicalDevice, stagingBufferMemory);
+        }
+    }
+
+    std::string ChainProfiler::getCaptureFilePath()
+    {
+        return ConfigSerializer::getBaseConfigDir() + "/profile_frame.bin";
+    }
+
+    void ChainProfiler::request(ChainProfileMode mode)
+    {
+        this->mode = mode;
+        requested  = true;
+    }
+
+    void ChainProfiler::ensureResources(uint32_t queryCount, VkDeviceSize dataSize)
+    {
+        if (queryCount > queryPoolSize)
+        {
+            if (queryPool != VK_NULL_HANDLE)
+                pLogicalDevice->vkd.DestroyQueryPool(pLogicalDevice->device, queryPool, nullptr);
+
+            VkQueryPoolCreateInfo queryPoolCreateInfo = {};
+            queryPoolCreateInfo.sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+            queryPoolCreateInfo.queryType  = VK_QUERY_TYPE_TIMESTAMP;
+            queryPoolCreateInfo.queryCount = queryCount;
+
+            VkResult result = pLogicalDevice->vkd.CreateQueryPool(pLogicalDevice->device, &queryPoolCreateInfo, nullptr, &queryPool);
+            ASSERT_VULKAN(result);
+            queryPoolSize = queryCount;
+        }
+
+        if (dataSize > stagingBufferSize)
+        {
+            if (stagingBuffer != VK_NULL_HANDLE)
+            {
+                pLogicalDevice->vkd.DestroyBuffer(pLogicalDevice->device, stagingBuffer, nullptr);
+                freeMemory(pLogicalDevice, stagingBufferMemory);
+            }
+
+            MemoryOwnerScope memoryOwner("Chain profiler");
+            createBuffer(pLogicalDevice,
+                         dataSize,
+                         VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                         stagingBuffer,
+                         stagingBufferMemory);
+            stagingBufferSize = dataSize;
+        }
+    }
+
+    bool ChainProfiler::loadCapture(LogicalSwapchain* pLogicalSwapchain, VkDeviceSize dataSize, CaptureHeader& header)
+    {
+        std::string   path = getCaptureFilePath();
+        std::ifstream file(path, std::ios::binary);
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || std::memcmp(header.magic, captureMagic, sizeof(captureMagic)) != 0)
+        {
+            Logger::warn("no saved frame to profile in " + path);
+            return false;
+        }
+
+        if (header.width != pLogicalSwapchain->imageExtent.width || header.height != pLogicalSwapchain->imageExtent.height
+            || header.format != pLogicalSwapchain->format || header.dataSize != dataSize)
+        {
+            Logger::warn("saved frame is " + std::to_string(header.width) + "x" + std::to_string(header.height) + " format "
+                         + std::to_string(header.format) + ", the swapchain does not match it");
+            return false;
+        }
+
+        void*    data;
+        VkResult result = pLogicalDevice->vkd.MapMemory(pLogicalDevice->device, stagingBufferMemory, 0, dataSize, 0, &data);
+        ASSERT_VULKAN(result);
+        bool read = static_cast<bool>(file.read(static_cast<char*>(data), dataSize));
+        pLogicalDevice->vkd.UnmapMemory(pLogicalDevice->device, stagingBufferMemory);
+
+        if (!read)
+            Logger::warn("saved frame " + path + " is truncated");
+        return read;
+    }
+
+    VkCommandBuffer ChainProfiler::record(
+        LogicalSwapchain* pLogicalSwapchain, uint32_t imageIndex, VkImage depthImage, VkImageView depthImageView, VkFormat depthFormat)
+    {
+        requested = false;
+
+        const auto& effects = pLogicalSwapchain->effects;
+        if (timestampMask == 0)
+        {
+            Logger::warn("queue family has no timestamps, the effect chain can't be profiled");
+            return VK_NULL_HANDLE;
+        }
+        if (effects.empty() || pLogicalSwapchain->fakeImages.empty())
+            return VK_NULL_HANDLE;
+
+        VkExtent2D   extent        = pLogicalSwapchain->imageExtent;
+        VkDeviceSize dataSize      = VkDeviceSize(extent.width) * extent.height * bytesPerPixel(pLogicalSwapchain->format);
+        uint32_t     queriesPerRun = static_cast<uint32_t>(effects.size()) + 2;
+        bool         copiesFrame   = mode != ChainProfileMode::CurrentFrame;
+        ensureResources(queriesPerRun * repeatCount, copiesFrame ? dataSize : 0);
+
+        if (mode == ChainProfileMode::SavedFrame)
+        {
+            if (!loadCapture(pLogicalSwapchain, dataSize, pendingHeader))
+                return VK_NULL_HANDLE;
+            liveUniforms = getFrameUniforms();
+            setFrameUniforms(pendingHeader.uniforms);
+        }
+        else
+        {
+            std::memcpy(pendingHeader.magic, captureMagic, sizeof(captureMagic));
+            pendingHeader.width    = extent.width;
+            pendingHeader.height   = extent.height;
+            pendingHeader.format   = pLogicalSwapchain->format;
+            pendingHeader.dataSize = static_cast<uint32_t>(dataSize);
+            pendingHeader.uniforms = getFrameUniforms();
+        }
+
+        VkCommandBufferBeginInfo beginInfo = {};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        VkResult result = pLogicalDevice->vkd.BeginCommandBuffer(commandBuffer, &beginInfo);
+        ASSERT_VULKAN(result);
+
+        pLogicalDevice->vkd.CmdResetQueryPool(commandBuffer, queryPool, 0, queriesPerRun * repeatCount);
+
+        // The chain input is in present layout, the effects expect it back there
+        if (copiesFrame)
+        {
+            bool upload = mode == ChainProfileMode::SavedFrame;
+
+            VkImageMemoryBarrier imageBarrier = {};
+            imageBarrier.sType                       = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            imageBarrier.srcAccessMask               = 0;
+            imageBarrier.dstAccessMask               = upload ? VK_ACCESS_TRANSFER_WRITE_BIT : VK_ACCESS_TRANSFER_READ_BIT;
+            imageBarrier.oldLayout                   = upload ? VK_IMAGE_LAYOUT_UNDEFINED : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+            imageBarrier.newLayout                   = upload ? VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL : VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+            imageBarrier.srcQueueFamilyIndex         = VK_QUEUE_FAMILY_IGNORED;
+            imageBarrier.dstQueueFamilyIndex         = VK_QUEUE_FAMILY_IGNORED;
+            imageBarrier.image                       = pLogicalSwapchain->fakeImages[imageIndex];
+            imageBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            imageBarrier.subresourceRange.levelCount = 1;
+            imageBarrier.subresourceRange.layerCount = 1;
+
+            // all commands includes the stages the application's semaphores block, so the copy waits for its frame
+            pLogicalDevice->vkd.CmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0,
+                                                   nullptr, 0, nullptr, 1, &imageBarrier);
+
+            VkBufferImageCopy region = {};
+            region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.layerCount = 1;
+            region.imageExtent                 = {extent.width, extent.height, 1};
+
+            if (upload)
+                pLogicalDevice->vkd.CmdCopyBufferToImage(
+                    commandBuffer, stagingBuffer, imageBarrier.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+            else
+                pLogicalDevice->vkd.CmdCopyImageToBuffer(
+                    commandBuffer, imageBarrier.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, stagingBuffer, 1, &region);
+
+            imageBarrier.srcAccessMask = imageBarrier.dstAccessMask;
+            imageBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+            imageBarrier.oldLayout     = imageBarrier.newLayout;
+            imageBarrier.newLayout     = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+            VkBufferMemoryBarrier bufferBarrier = {};
+            bufferBarrier.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            bufferBarrier.srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+            bufferBarrier.dstAccessMask       = VK_ACCESS_HOST_READ_BIT;
+            bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            bufferBarrier.buffer              = stagingBuffer;
+            bufferBarrier.size                = VK_WHOLE_SIZE;
+
+            pLogicalDevice->vkd.CmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                                   VK_PIPELINE_STAGE_ALL_COMMANDS_BIT | VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr,
+                                                   upload ? 0 : 1, &bufferBarrier, 1, &imageBarrier);
+        }
+
+        // The input stays untouched by the chain, every run sees the same frame
+        for (uint32_t run = 0; run < repeatCount; run++)
+        {
+            recordEffectChain(pLogicalDevice, effects, depthImage, depthImageView, depthFormat, imageIndex, commandBuffer,
+                              pLogicalSwapchain->linearDepth.get(), queryPool, run * queriesPerRun);
+        }
+
+        result = pLogicalDevice->vkd.EndCommandBuffer(commandBuffer);
+        ASSERT_VULKAN(result);
+
+        result = pLogicalDevice->vkd.ResetFences(pLogicalDevice->device, 1, &fence);
+        ASSERT_VULKAN(result);
+
+        // Pass 0 is the linear depth prepass, the effects without a name are the final copy or upscale
+        passNames = {pLogicalSwapchain->linearDepth && depthImageView ? "Linear depth" : ""};
+        for (size_t i = 0; i < effects.size(); i++)
+            passNames.push_back(i < pLogicalSwapchain->effectNames.size() ? pLogicalSwapchain->effectNames[i] : "Final pass");
+
+        recordedMode = mode;
+        inFlight     = true;
+        return commandBuffer;
+    }
+
+    void ChainProfiler::abort()
+    {
+        if (!inFlight)
+            return;
+        inFlight = false;
+
+        if (recordedMode == ChainProfileMode::SavedFrame)
+            setFrameUniforms(liveUniforms);
+        Logger::warn("chain profile dropped, its submit failed");
+    }
+
+    void ChainProfiler::finish()
+    {
+        if (!inFlight)
+            return;
+        inFlight = false;
+
+        if (recordedMode == ChainProfileMode::SavedFrame)
+            setFrameUniforms(liveUniforms);
+
+        VkResult result = pLogicalDevice->vkd.WaitForFences(pLogicalDevice->device, 1, &fence, VK_TRUE, UINT64_MAX);
+        if (result != VK_SUCCESS)
+        {
+            Logger::err("waiting for the chain profile failed: " + std::to_string(result));
+            return;
+        }
+
+        uint32_t              queriesPerRun = static_cast<uint32_t>(passNames.size()) + 1;
+        std::vector<uint64_t> timestamps(queriesPerRun * repeatCount);
+        result = pLogicalDevice->vkd.GetQueryPoolResults(pLogicalDevice->device, queryPool, 0, timestamps.size(),
+                                                         timestamps.size() * sizeof(uint64_t), timestamps.data(), sizeof(uint64_t),
+                                                         VK_QUERY_RESULT_64_BIT);
+        if (result != VK_SUCCESS)
+        {
+            Logger::err("reading the chain profile failed: " + std::to_string(result));
+            return;
+        }
+
+        auto ticksToMs = [&](uint64_t begin, uint64_t end) { return ((end - begin) & timestampMask) * timestampPeriod / 1e6; };
+        auto median    = [](std::vector<double>& values) {
+            std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+            return values[values.size() / 2];
+        };
+
+        results.clear();
+        std::vector<double> runTimes(repeatCount);
+        for (uint32_t pass = 0; pass < passNames.size(); pass++)
+        {
+            for (uint32_t run = 0; run < repeatCount; run++)
+            {
+                const uint64_t* runTimestamps = &timestamps[run * queriesPerRun];
+                runTimes[run]                 = ticksToMs(runTimestamps[pass], runTimestamps[pass + 1]);
+            }
+
+            if (!passNames[pass].empty())
+                results.push_back({passNames[pass], median(runTimes)});
+        }
+
+        for (uint32_t run = 0; run < repeatCount; run++)
+            runTimes[run] = ticksToMs(timestamps[run * queriesPerRun], timestamps[run * queriesPerRun + queriesPerRun - 1]);
+        double total = median(runTimes);
+
+        char label[128];
+        snprintf(label, sizeof(label), "%s, median of %u runs, %.3f ms total", modeName(recordedMode), repeatCount, total);
+        resultLabel = label;
+
+        std::string summary = "effect chain profile (" + resultLabel + "):";
+        for (const EffectTime& time : results)
+        {
+            char entry[160];
+            snprintf(entry, sizeof(entry), " %s %.3f ms,", time.name.c_str(), time.milliseconds);
+            summary += entry;
+        }
+        summary.pop_back();
+        Logger::info(summary);
+
+        if (recordedMode != ChainProfileMode::SaveFrame)
+            return;
+
+        std::string   path = getCaptureFilePath();
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        void*         data;
+        result = pLogicalDevice->vkd.MapMemory(pLogicalDevice->device, stagingBufferMemory, 0, pendingHeader.dataSize, 0, &data);
+        ASSERT_VULKAN(result);
+        file.write(reinterpret_cast<const char*>(&pendingHeader), sizeof(pendingHeader));
+        file.write(static_cast<const char*>(data), pendingHeader.dataSize);
+        pLogicalDevice->vkd.UnmapMemory(pLogicalDevice->device, stagingBufferMemory);
+
+        if (file.good())
+            Logger::info("saved the profiled frame to " + path);
+        else
+            Logger::err("could not write the profiled frame to " + path);
+    }
+} // namespace vkBasalt
@@ -0,0 +1,114 @@
+#ifndef CHAIN_PROFILER_HPP_INCLUDED
+#define CHAIN_PROFILER_HPP_INCLUDED
+#include <string>
+#include <vector>
+
+#include "vulkan_include.hpp"
+
+#include "reshade_uniforms.hpp"
+
+namespace vkBasalt
+{
+    struct LogicalDevice;
+    struct LogicalSwapchain;
+
+    enum class ChainProfileMode
+    {
+        CurrentFrame,  // the frame the application just rendered
+        SaveFrame,     // the same, and the frame is written to disk
+        SavedFrame     // the frame from disk, runs before and after a change see the same input
+    };
+
+    // Times every effect of the chain on one frozen frame. The chain is recorded repeatCount times into a command buffer
+    // that replaces the frame's effect command buffer, every repetition sees the same input and uniforms.
+    // The median time per effect goes to the log and stays available for the overlay
+    class ChainProfiler
+    {
+    public:
+        struct EffectTime
+        {
+            std::string name;
+            double      milliseconds;
+        };
+
+        explicit ChainProfiler(LogicalDevice* pLogicalDevice);
+        ~ChainProfiler();
+
+        ChainProfiler(const ChainProfiler&)            = delete;
+        ChainProfiler& operator=(const ChainProfiler&) = delete;
+
+        // Profiles the next frame that presents effects
+        void request(ChainProfileMode mode);
+        bool hasRequest() const { return requested; }
+
+        // Records the profile of the chain for imageIndex, VK_NULL_HANDLE if it can't be profiled (the request is dropped).
+        // With SavedFrame it also replaces the frame uniforms, call it before the effects update their uniforms
+        VkCommandBuffer record(LogicalSwapchain* pLogicalSwapchain,
+                               uint32_t          imageIndex,
+                               VkImage           depthImage,
+                               VkImageView       depthImageView,
+                               VkFormat          depthFormat);
+
+        // For VkSubmitInfo::pCommandBuffers
+        const VkCommandBuffer* getCommandBufferPointer() const { return &commandBuffer; }
+
+        // Signal it with the submit of the recorded command buffer
+        VkFence getFence() const { return fence; }
+
+        // Waits for the submitted profile, logs the times and writes the frame if requested
+        void finish();
+
+        // Drops a recorded profile whose submit failed, the frame uniforms go back to the live ones
+        void abort();
+
+        const std::vector<EffectTime>& getResults() const { return results; }
+        const std::string&             getResultLabel() const { return resultLabel; }
+
+        static std::string getCaptureFilePath();
+
+    private:
+        static constexpr uint32_t repeatCount = 16;
+
+        // Start of a saved frame, the pixels follow
+        struct CaptureHeader
+        {
+            char          magic[8];
+            uint32_t      width;
+            uint32_t      height;
+            VkFormat      format;
+            uint32_t      dataSize;
+            FrameUniforms uniforms;
+        };
+
+        bool loadCapture(LogicalSwapchain* pLogicalSwapchain, VkDeviceSize dataSize, CaptureHeader& header);
+        void ensureResources(uint32_t queryCount, VkDeviceSize dataSize);
+
+        LogicalDevice*  pLogicalDevice;
+        VkCommandBuffer commandBuffer   = VK_NULL_HANDLE;
+        VkFence         fence           = VK_NULL_HANDLE;
+        VkQueryPool     queryPool       = VK_NULL_HANDLE;
+        uint32_t        queryPoolSize   = 0;
+        uint64_t        timestampMask   = 0;    // 0 if the queue has no timestamps
+        double          timestampPeriod = 1.0;  // ns per tick
+
+        // Host visible copy of the chain input, to save or to upload a saved frame
+        VkBuffer       stagingBuffer       = VK_NULL_HANDLE;
+        VkDeviceMemory stagingBufferMemory = VK_NULL_HANDLE;
+        VkDeviceSize   stagingBufferSize   = 0;
+
+        bool             requested = false;
+        ChainProfileMode mode      = ChainProfileMode::CurrentFrame;
+
+        // The profile in flight between record() and finish()
+        bool                     inFlight     = false;
+        ChainProfileMode         recordedMode = ChainProfileMode::CurrentFrame;
+        std::vector<std::string> passNames;  // empty names are left out of the results
+        CaptureHeader            pendingHeader = {};
+        FrameUniforms            liveUniforms;  // restored after profiling a saved frame
+
+        std::vector<EffectTime> results;
+        std::string             resultLabel;
+    };
+} // namespace vkBasalt
+
+#endif // CHAIN_PROFILER_HPP_INCLUDED
@@ -26,12 +26,95 @@ namespace vkBasalt
 
         return commandBuffers;
     }
+
+    // Hands the depth image back to the application, memoryBarrier is the one that made it readable
+    static void restoreDepthLayout(LogicalDevice* pLogicalDevice, VkCommandBuffer commandBuffer, VkImageMemoryBarrier memoryBarrier)
+    {
+        memoryBarrier.oldLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        memoryBarrier.newLayout     = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        memoryBarrier.dstAccessMask = 0;
+        // the layout transition has to wait for the shader reads
+        pLogicalDevice->vkd.CmdPipelineBarrier(
+            commandBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 0, nullptr, 1, &memoryBarrier);
+    }
+
+    void recordEffectChain(LogicalDevice*                                        pLogicalDevice,
+                           const std::vector<std::shared_ptr<vkBasalt::Effect>>& effects,
+                           VkImage                                               depthImage,
+                           VkImageView                                           depthImageView,
+                           VkFormat                                              depthFormat,
+                           uint32_t                                              imageIndex,
+                           VkCommandBuffer                                       commandBuffer,
+                           LinearDepthPass*                                      linearDepth,
+                           VkQueryPool                                           queryPool,
+                           uint32_t                                              firstQuery)
+    {
+        bool useLinearDepth = linearDepth && depthImageView;
+
+        // bottom of pipe waits for everything recorded before, so consecutive timestamps enclose one pass
+        auto writeTimestamp = [&](uint32_t query) {
+            if (queryPool != VK_NULL_HANDLE)
+                pLogicalDevice->vkd.CmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, firstQuery + query);
+        };
+
+        VkImageMemoryBarrier memoryBarrier;
+        memoryBarrier.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        memoryBarrier.pNext               = nullptr;
+        memoryBarrier.image               = depthImage;
+        memoryBarrier.oldLayout           = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        memoryBarrier.newLayout           = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        memoryBarrier.srcAccessMask       = 0;
+        memoryBarrier.dstAccessMask       = VK_ACCESS_SHADER_READ_BIT;
+        memoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        memoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        memoryBarrier.subresourceRange.aspectMask =
+            isStencilFormat(depthFormat) ? VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT : VK_IMAGE_ASPECT_DEPTH_BIT;
+        memoryBarrier.subresourceRange.baseMipLevel   = 0;
+        memoryBarrier.subresourceRange.levelCount     = 1;
+        memoryBarrier.subresourceRange.baseArrayLayer = 0;
+        memoryBarrier.subresourceRange.layerCount     = 1;
+
+        writeTimestamp(0);
+
+        if (depthImageView)
+        {
+            pLogicalDevice->vkd.CmdPipelineBarrier(commandBuffer,
+                                                   VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                                   VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                                                   0,
+                                                   0,
+                                                   nullptr,
+                                                   0,
+                                                   nullptr,
+                                                   1,
+                                                   &memoryBarrier);
+        }
+
+        if (useLinearDepth)
+        {
+            linearDepth->record(commandBuffer);
+            restoreDepthLayout(pLogicalDevice, commandBuffer, memoryBarrier);
+        }
+        writeTimestamp(1);
+
+        for (uint32_t j = 0; j < effects.size(); j++)
+        {
+            Logger::debug("before applying effect " + convertToString(effects[j]));
+            effects[j]->applyEffect(imageIndex, commandBuffer);
+            writeTimestamp(j + 2);
+        }
+
+        if (depthImageView && !useLinearDepth)
+            restoreDepthLayout(pLogicalDevice, commandBuffer, memoryBarrier);
+    }
+
     void writeCommandBuffers(LogicalDevice*                                 pLogicalDevice,
                              std::vector<std::shared_ptr<vkBasalt::Effect>> effects,
                              VkImage                                        depthImage,
                              VkImageView                                    depthImageView,
                              VkFormat                                       depthFormat,
-                             std::vector<VkCommandBuffer>                   commandBuffers)
+                             std::vector<VkCommandBuffer>                   commandBuffers,
+                             LinearDepthPass*                               linearDepth)
     {
         VkCommandBufferBeginInfo beginInfo = {};
 
@@ -40,9 +123,14 @@ namespace vkBasalt
         beginInfo.flags            = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
         beginInfo.pInheritanceInfo = nullptr;
 
+        // With the prepass the effects sample linear depth and the game's depth image
+        // can go back to its layout right after the prepass read it
+        bool        useLinearDepth  = linearDepth && depthImageView;
+        VkImageView effectDepthView = useLinearDepth ? linearDepth->useDepthImage(depthImageView) : depthImageView;
+
         for (auto& effect : effects)
         {
-            effect->useDepthImage(depthImageView);
+            effect->useDepthImage(effectDepthView);
         }
 
         for (uint32_t i = 0; i < commandBuffers.size(); i++)
@@ -51,59 +139,7 @@ namespace vkBasalt
             VkResult result = pLogicalDevice->vkd.BeginCommandBuffer(commandBuffers[i], &beginInfo);
             ASSERT_VULKAN(result);
 
-            VkImageMemoryBarrier memoryBarrier;
-            memoryBarrier.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-            memoryBarrier.pNext               = nullptr;
-            memoryBarrier.image               = depthImage;
-            memoryBarrier.oldLayout           = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-            memoryBarrier.newLayout           = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            memoryBarrier.srcAccessMask       = 0;
-            memoryBarrier.dstAccessMask       = VK_ACCESS_SHADER_READ_BIT;
-            memoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-            memoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-            memoryBarrier.subresourceRange.aspectMask =
-                isStencilFormat(depthFormat) ? VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT : VK_IMAGE_ASPECT_DEPTH_BIT;
-            memoryBarrier.subresourceRange.baseMipLevel   = 0;
-            memoryBarrier.subresourceRange.levelCount     = 1;
-            memoryBarrier.subresourceRange.baseArrayLayer = 0;
-            memoryBarrier.subresourceRange.layerCount     = 1;
-
-            if (depthImageView)
-            {
-                pLogicalDevice->vkd.CmdPipelineBarrier(commandBuffers[i],
-                                                       VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-                                                       VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
-                                                       0,
-                                                       0,
-                                                       nullptr,
-                                                       0,
-                                                       nullptr,
-                                                       1,
-                                                       &memoryBarrier);
-            }
-
-            for (uint32_t j = 0; j < effects.size(); j++)
-            {
-                Logger::debug("before applying effect " + convertToString(effects[j]));
-                effects[j]->applyEffect(i, commandBuffers[i]);
-            }
-
-            memoryBarrier.oldLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            memoryBarrier.newLayout     = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-            memoryBarrier.dstAccessMask = 0;
-            if (depthImageView)
-            {
-                pLogicalDevice->vkd.CmdPipelineBarrier(commandBuffers[i],
-                                                       VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-                                                       VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
-                                                       0,
-                                                       0,
-                                                       nullptr,
-                                                       0,
-                                                       nullptr,
-                                                       1,
-                                                       &memoryBarrier);
-            }
+            recordEffectChain(pLogicalDevice, effects, depthImage, depthImageView, depthFormat, i, commandBuffers[i], linearDepth);
 
             result = pLogicalDevice->vkd.EndCommandBuffer(commandBuffers[i]);
             ASSERT_VULKAN(result);
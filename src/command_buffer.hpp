@@ -10,6 +10,7 @@
 #include "vulkan_include.hpp"
 
 #include "logical_device.hpp"
+#include "linear_depth.hpp"
 
 #include "effects/effect.hpp"
 namespace vkBasalt
@@ -22,7 +23,21 @@ namespace vkBasalt
                              VkImage                                        depthImage,
                              VkImageView                                    depthImageView,
                              VkFormat                                       depthFormat,
-                             std::vector<VkCommandBuffer>                   commandBuffers);
+                             std::vector<VkCommandBuffer>                   commandBuffers,
+                             LinearDepthPass*                               linearDepth = nullptr);
+
+    // Records the chain once for imageIndex into a command buffer that is already recording.
+    // With a queryPool it writes firstQuery + 0 before the chain, + 1 after the linear depth prepass and + 2 + j after effect j
+    void recordEffectChain(LogicalDevice*                                        pLogicalDevice,
+                           const std::vector<std::shared_ptr<vkBasalt::Effect>>& effects,
+                           VkImage                                               depthImage,
+                           VkImageView                                           depthImageView,
+                           VkFormat                                              depthFormat,
+                           uint32_t                                              imageIndex,
+                           VkCommandBuffer                                       commandBuffer,
+                           LinearDepthPass*                                      linearDepth,
+                           VkQueryPool                                           queryPool  = VK_NULL_HANDLE,
+                           uint32_t                                              firstQuery = 0);
 
     std::vector<VkSemaphore> createSemaphores(LogicalDevice* pLogicalDevice, uint32_t count);
 } // namespace vkBasalt
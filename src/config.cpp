@@ -107,6 +107,7 @@ namespace vkBasalt
 
     void Config::readConfigFile(std::ifstream& stream)
     {
+        ScopedTimer timer("parsing config", configFilePath);
         std::string line;
         while (std::getline(stream, line))
             readConfigLine(line);
@@ -255,6 +255,8 @@ namespace vkBasalt
                 settings.maxEffects = std::stoi(value);
             else if (key == "overlayBlockInput")
                 settings.overlayBlockInput = (value == "true" || value == "1");
+            else if (key == "overlayIdleRelease")
+                settings.overlayIdleRelease = std::stoi(value);
             else if (key == "toggleKey")
                 settings.toggleKey = value;
             else if (key == "reloadKey")
@@ -271,6 +273,20 @@ namespace vkBasalt
                 settings.autoApplyDelay = std::stoi(value);
             else if (key == "showDebugWindow")
                 settings.showDebugWindow = (value == "true" || value == "1");
+            else if (key == "vramLimitMB")
+                settings.vramLimitMB = std::stoi(value);
+            else if (key == "respectMemoryBudget")
+                settings.respectMemoryBudget = (value == "true" || value == "1");
+            else if (key == "halfPrecisionShaders")
+                settings.halfPrecisionShaders = (value == "true" || value == "1");
+            else if (key == "dedicatedEffectQueue")
+                settings.dedicatedEffectQueue = (value == "true" || value == "1");
+            else if (key == "linearDepthPrepass")
+                settings.linearDepthPrepass = (value == "true" || value == "1");
+            else if (key == "bypassWhenDisabled")
+                settings.bypassWhenDisabled = (value == "true" || value == "1");
+            else if (key == "presentLatencyStats")
+                settings.presentLatencyStats = (value == "true" || value == "1");
         }
 
         return settings;
@@ -300,10 +316,22 @@ namespace vkBasalt
 
         file << "# Overlay settings\n";
         file << "overlayBlockInput = " << (settings.overlayBlockInput ? "true" : "false") << "\n";
+        file << "overlayIdleRelease = " << settings.overlayIdleRelease << "\n";
         file << "maxEffects = " << settings.maxEffects << "\n";
         file << "autoApply = " << (settings.autoApply ? "true" : "false") << "\n";
         file << "autoApplyDelay = " << settings.autoApplyDelay << "\n";
 
+        file << "\n# VRAM budget (vramLimitMB = 0 means no limit)\n";
+        file << "vramLimitMB = " << settings.vramLimitMB << "\n";
+        file << "respectMemoryBudget = " << (settings.respectMemoryBudget ? "true" : "false") << "\n";
+
+        file << "\n# Performance\n";
+        file << "halfPrecisionShaders = " << (settings.halfPrecisionShaders ? "true" : "false") << "\n";
+        file << "dedicatedEffectQueue = " << (settings.dedicatedEffectQueue ? "true" : "false") << "\n";
+        file << "linearDepthPrepass = " << (settings.linearDepthPrepass ? "true" : "false") << "\n";
+        file << "bypassWhenDisabled = " << (settings.bypassWhenDisabled ? "true" : "false") << "\n";
+        file << "presentLatencyStats = " << (settings.presentLatencyStats ? "true" : "false") << "\n";
+
         file << "\n# Key bindings\n";
         file << "toggleKey = " << settings.toggleKey << "\n";
         file << "reloadKey = " << settings.reloadKey << "\n";
@@ -363,6 +391,7 @@ namespace vkBasalt
         std::vector<std::string>& shaderPaths,
         std::vector<std::string>& texturePaths)
     {
+        ScopedTimer timer("scanning for shaders in", dir);
         try
         {
             for (const auto& entry : std::filesystem::recursive_directory_iterator(
@@ -22,6 +22,7 @@ namespace vkBasalt
     {
         int maxEffects = 10;
         bool overlayBlockInput = false;
+        int overlayIdleRelease = 60;  // Seconds hidden before the overlay frees ImGui and its Vulkan objects (0 = never)
         std::string toggleKey = "Home";
         std::string reloadKey = "F10";
         std::string overlayKey = "End";
@@ -30,6 +31,13 @@ namespace vkBasalt
         bool autoApply = true;  // Auto-apply changes without clicking Apply
         int autoApplyDelay = 200;  // ms delay before auto-applying changes
         bool showDebugWindow = false;  // Show debug window with raw effect registry data
+        int vramLimitMB = 0;  // Refuse effects once vkBasalt's own allocations exceed this (0 = no limit)
+        bool respectMemoryBudget = false;  // Refuse effects while the driver reports VRAM over budget
+        bool halfPrecisionShaders = true;  // Use FP16 built-in shader variants when the device supports them
+        bool dedicatedEffectQueue = false;  // Request an extra graphics queue for effects and overlay (requires restart)
+        bool linearDepthPrepass = false;  // Linearize depth once per frame for all ReShade effects
+        bool bypassWhenDisabled = false;  // Give the application the real swapchain images while effects are off
+        bool presentLatencyStats = false;  // Measure how long presents take to reach the screen (requires restart)
     };
 
     // Shader Manager configuration (from shader_manager.conf)
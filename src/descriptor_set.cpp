@@ -1,6 +1,8 @@
 #include "descriptor_set.hpp"
 #include "logger.hpp"
 
+#include <numeric>
+
 namespace vkBasalt
 {
 
@@ -54,7 +56,9 @@ namespace vkBasalt
     VkDescriptorSet writeBufferDescriptorSet(LogicalDevice*        pLogicalDevice,
                                              VkDescriptorPool      descriptorPool,
                                              VkDescriptorSetLayout descriptorSetLayout,
-                                             VkBuffer              buffer)
+                                             VkBuffer              buffer,
+                                             VkDeviceSize          offset,
+                                             VkDeviceSize          range)
     {
         VkDescriptorSet descriptorSet;
 
@@ -70,8 +74,8 @@ namespace vkBasalt
 
         VkDescriptorBufferInfo bufferInfo;
         bufferInfo.buffer = buffer;
-        bufferInfo.offset = 0;
-        bufferInfo.range  = VK_WHOLE_SIZE;
+        bufferInfo.offset = offset;
+        bufferInfo.range  = range;
 
         VkWriteDescriptorSet writeDescriptorSet = {};
 
@@ -93,14 +97,24 @@ namespace vkBasalt
     }
 
     VkDescriptorSetLayout createImageSamplerDescriptorSetLayout(LogicalDevice* pLogicalDevice, uint32_t count)
+    {
+        std::vector<uint32_t> bindings(count);
+        std::iota(bindings.begin(), bindings.end(), 0u);
+        return createImageSamplerDescriptorSetLayout(pLogicalDevice, bindings);
+    }
+
+    VkDescriptorSetLayout createImageSamplerDescriptorSetLayout(LogicalDevice*                   pLogicalDevice,
+                                                                const std::vector<uint32_t>&     bindings,
+                                                                VkDescriptorSetLayoutCreateFlags flags)
     {
         VkDescriptorSetLayout descriptorSetLayout;
 
+        uint32_t count = bindings.size();
         std::vector<VkDescriptorSetLayoutBinding> bindigs(count);
         for (uint32_t i = 0; i < count; i++)
         {
             VkDescriptorSetLayoutBinding descriptorSetLayoutBinding;
-            descriptorSetLayoutBinding.binding            = i;
+            descriptorSetLayoutBinding.binding            = bindings[i];
             descriptorSetLayoutBinding.descriptorType     = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
             descriptorSetLayoutBinding.descriptorCount    = 1;
             descriptorSetLayoutBinding.stageFlags         = VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_VERTEX_BIT;
@@ -111,7 +125,7 @@ namespace vkBasalt
         VkDescriptorSetLayoutCreateInfo descriptorSetCreateInfo;
         descriptorSetCreateInfo.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
         descriptorSetCreateInfo.pNext        = nullptr;
-        descriptorSetCreateInfo.flags        = 0;
+        descriptorSetCreateInfo.flags        = flags;
         descriptorSetCreateInfo.bindingCount = count;
         descriptorSetCreateInfo.pBindings    = bindigs.data();
 
@@ -126,6 +140,18 @@ namespace vkBasalt
                                                                             VkDescriptorSetLayout                 descriptorSetLayout,
                                                                             std::vector<VkSampler>                samplers,
                                                                             std::vector<std::vector<VkImageView>> imageViewsVectors)
+    {
+        std::vector<uint32_t> bindings(imageViewsVectors.size());
+        std::iota(bindings.begin(), bindings.end(), 0u);
+        return allocateAndWriteImageSamplerDescriptorSets(pLogicalDevice, descriptorPool, descriptorSetLayout, bindings, samplers, imageViewsVectors);
+    }
+
+    std::vector<VkDescriptorSet> allocateAndWriteImageSamplerDescriptorSets(LogicalDevice*                               pLogicalDevice,
+                                                                            VkDescriptorPool                             descriptorPool,
+                                                                            VkDescriptorSetLayout                        descriptorSetLayout,
+                                                                            const std::vector<uint32_t>&                 bindings,
+                                                                            const std::vector<VkSampler>&                samplers,
+                                                                            const std::vector<std::vector<VkImageView>>& imageViewsVectors)
     {
         if (imageViewsVectors.empty() || imageViewsVectors[0].empty())
         {
@@ -174,7 +200,7 @@ namespace vkBasalt
                 imageInfos[j].sampler   = samplers[j];
                 imageInfos[j].imageView = imageViewsVectors[j][i];
 
-                writeDescriptorSets[j].dstBinding = j;
+                writeDescriptorSets[j].dstBinding = bindings[j];
                 writeDescriptorSets[j].pImageInfo = &imageInfos[j];
                 writeDescriptorSets[j].dstSet     = descriptorSets[i];
             }
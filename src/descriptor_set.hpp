@@ -20,15 +20,30 @@ namespace vkBasalt
     VkDescriptorSet writeBufferDescriptorSet(LogicalDevice*        pLogicalDevice,
                                              VkDescriptorPool      descriptorPool,
                                              VkDescriptorSetLayout descriptorSetLayout,
-                                             VkBuffer              buffer);
+                                             VkBuffer              buffer,
+                                             VkDeviceSize          offset = 0,
+                                             VkDeviceSize          range  = VK_WHOLE_SIZE);
 
     VkDescriptorSetLayout createImageSamplerDescriptorSetLayout(LogicalDevice* pLogicalDevice, uint32_t count);
 
+    // One combined image sampler per entry of bindings, flags allows e.g. push descriptor layouts
+    VkDescriptorSetLayout createImageSamplerDescriptorSetLayout(LogicalDevice*               pLogicalDevice,
+                                                                const std::vector<uint32_t>& bindings,
+                                                                VkDescriptorSetLayoutCreateFlags flags = 0);
+
     std::vector<VkDescriptorSet> allocateAndWriteImageSamplerDescriptorSets(LogicalDevice*                        pLogicalDevice,
                                                                             VkDescriptorPool                      descriptorPool,
                                                                             VkDescriptorSetLayout                 descriptorSetLayout,
                                                                             std::vector<VkSampler>                samplers,
                                                                             std::vector<std::vector<VkImageView>> imageViewsVectors);
+
+    // Same as above, sampler j and imageViewsVectors[j] are written to bindings[j]
+    std::vector<VkDescriptorSet> allocateAndWriteImageSamplerDescriptorSets(LogicalDevice*                               pLogicalDevice,
+                                                                            VkDescriptorPool                             descriptorPool,
+                                                                            VkDescriptorSetLayout                        descriptorSetLayout,
+                                                                            const std::vector<uint32_t>&                 bindings,
+                                                                            const std::vector<VkSampler>&                samplers,
+                                                                            const std::vector<std::vector<VkImageView>>& imageViewsVectors);
 } // namespace vkBasalt
 
 #endif // DESCRIPTOR_SET_HPP_INCLUDED
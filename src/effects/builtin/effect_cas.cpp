@@ -26,7 +26,7 @@ namespace vkBasalt
         float sharpness = pConfig->getOption<float>("casSharpness", 0.4f);
 
         vertexCode   = full_screen_triangle_vert;
-        fragmentCode = cas_frag;
+        fragmentCode = useHalfPrecision(pLogicalDevice) ? cas_fp16_frag : cas_frag;
 
         VkSpecializationMapEntry sharpnessMapEntry;
         sharpnessMapEntry.constantID = 0;
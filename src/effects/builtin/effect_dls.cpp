@@ -28,7 +28,7 @@ namespace vkBasalt
         float specData[2] = {sharpness, denoise};
 
         vertexCode   = full_screen_triangle_vert;
-        fragmentCode = dls_frag;
+        fragmentCode = useHalfPrecision(pLogicalDevice) ? dls_fp16_frag : dls_frag;
 
         VkSpecializationMapEntry mapEntries[2];
         mapEntries[0].constantID = 0;
@@ -12,6 +12,7 @@
 #include "shader.hpp"
 #include "sampler.hpp"
 #include "image.hpp"
+#include "memory.hpp"
 #include "lut_cube.hpp"
 
 #include "stb_image.h"
@@ -38,18 +39,31 @@ namespace vkBasalt
         }
 
         int      height = 0;
-        LutCube  lutCube;
         stbi_uc* pixels = nullptr;
         int32_t  usingPNG = (int32_t)(lutFile.find(".cube") == std::string::npos && lutFile.find(".CUBE") == std::string::npos);
+
+        // .cube files carry more than 8 bits, keep that unless disabled
+        VkFormat                   lutFormat = VK_FORMAT_R8G8B8A8_UNORM;
+        std::vector<unsigned char> unormTexels;
+        std::vector<uint16_t>      halfTexels;
         if (!usingPNG)
         {
-            lutCube = LutCube(lutFile);
-            pixels  = lutCube.colorCube.data();
-            height  = lutCube.size;
-            if (height == 0 || pixels == nullptr)
+            LutCube lutCube(lutFile);
+            height = lutCube.size;
+            if (height == 0)
             {
                 throw std::runtime_error("Failed to load LUT cube file: " + lutFile);
             }
+            if (pConfig->getOption<bool>("lutHighPrecision", true))
+            {
+                lutFormat  = VK_FORMAT_R16G16B16A16_SFLOAT;
+                halfTexels = lutCube.toFloat16();
+            }
+            else
+            {
+                unormTexels = lutCube.toUNORM8();
+                pixels      = unormTexels.data();
+            }
         }
         else
         {
@@ -89,19 +103,31 @@ namespace vkBasalt
         lutImage = createImages(pLogicalDevice,
                                 1,
                                 lutImageExtent,
-                                VK_FORMAT_R8G8B8A8_UNORM, // TODO search for format and save it
+                                lutFormat,
                                 VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
                                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
                                 lutMemory)[0];
 
-        uploadToImage(pLogicalDevice, lutImage, lutImageExtent, height * height * height * 4, pixels);
+        uint32_t texelCount = height * height * height;
+        if (lutFormat == VK_FORMAT_R16G16B16A16_SFLOAT)
+        {
+            uploadToImage(pLogicalDevice,
+                          lutImage,
+                          lutImageExtent,
+                          texelCount * 4 * sizeof(uint16_t),
+                          reinterpret_cast<const unsigned char*>(halfTexels.data()));
+        }
+        else
+        {
+            uploadToImage(pLogicalDevice, lutImage, lutImageExtent, texelCount * 4, pixels);
+        }
 
         if (usingPNG)
         {
             stbi_image_free(pixels);
         }
 
-        lutImageView = createImageViews(pLogicalDevice, VK_FORMAT_R8G8B8A8_UNORM, std::vector<VkImage>(1, lutImage), VK_IMAGE_VIEW_TYPE_3D)[0];
+        lutImageView = createImageViews(pLogicalDevice, lutFormat, std::vector<VkImage>(1, lutImage), VK_IMAGE_VIEW_TYPE_3D)[0];
 
         lutDescriptorSetLayout = createImageSamplerDescriptorSetLayout(pLogicalDevice, 1);
         descriptorSetLayouts.push_back(lutDescriptorSetLayout);
@@ -133,7 +159,7 @@ namespace vkBasalt
         pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, lutImage, nullptr);
         pLogicalDevice->vkd.DestroyDescriptorSetLayout(pLogicalDevice->device, lutDescriptorSetLayout, nullptr);
         pLogicalDevice->vkd.DestroyDescriptorPool(pLogicalDevice->device, lutDescriptorPool, nullptr);
-        pLogicalDevice->vkd.FreeMemory(pLogicalDevice->device, lutMemory, nullptr);
+        freeMemory(pLogicalDevice, lutMemory);
     }
     void LutEffect::applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer)
     {
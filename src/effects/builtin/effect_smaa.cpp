@@ -11,6 +11,8 @@
 #include "shader.hpp"
 #include "sampler.hpp"
 #include "image.hpp"
+#include "memory.hpp"
+#include "format.hpp"
 #include "util.hpp"
 
 #include "AreaTex.h"
@@ -82,6 +84,30 @@ namespace vkBasalt
 
         uploadToImage(pLogicalDevice, searchImage, searchImageExtent, SEARCHTEX_SIZE, searchTexBytes);
 
+        // The edge pass discards pixels without edges, so its stencil writes mark exactly the pixels
+        // the expensive blend weight search has to run for
+        stencilFormat = getStencilFormat(pLogicalDevice);
+        if (stencilFormat != VK_FORMAT_UNDEFINED)
+        {
+            stencilImage = createImages(pLogicalDevice,
+                                        1,
+                                        {imageExtent.width, imageExtent.height, 1},
+                                        stencilFormat,
+                                        VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+                                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                        stencilMemory)[0];
+            stencilImageView = createImageViews(pLogicalDevice,
+                                                stencilFormat,
+                                                {stencilImage},
+                                                VK_IMAGE_VIEW_TYPE_2D,
+                                                VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT)[0];
+            Logger::debug("created smaa stencil image");
+        }
+        else
+        {
+            Logger::warn("no stencil format, smaa blend weights are computed for every pixel");
+        }
+
         areaImageView = createImageViews(pLogicalDevice, VK_FORMAT_R8G8_UNORM, std::vector<VkImage>(1, areaImage))[0];
         Logger::debug("after creating area ImageView");
         searchImageView = createImageViews(pLogicalDevice, VK_FORMAT_R8_UNORM, std::vector<VkImage>(1, searchImage))[0];
@@ -135,6 +161,13 @@ namespace vkBasalt
 
         renderPass      = createRenderPass(pLogicalDevice, format);
         unormRenderPass = createRenderPass(pLogicalDevice, VK_FORMAT_B8G8R8A8_UNORM);
+        edgeRenderPass  = unormRenderPass;
+        blendRenderPass = unormRenderPass;
+        if (stencilImage)
+        {
+            edgeRenderPass  = createStencilRenderPass(pLogicalDevice, VK_FORMAT_B8G8R8A8_UNORM, stencilFormat, true);
+            blendRenderPass = createStencilRenderPass(pLogicalDevice, VK_FORMAT_B8G8R8A8_UNORM, stencilFormat, false);
+        }
 
         std::vector<VkDescriptorSetLayout> descriptorSetLayouts = {imageSamplerDescriptorSetLayout};
         pipelineLayout                                          = createGraphicsPipelineLayout(pLogicalDevice, descriptorSetLayouts);
@@ -156,6 +189,30 @@ namespace vkBasalt
         specializationInfo.dataSize      = sizeof(smaaOptions);
         specializationInfo.pData         = &smaaOptions;
 
+        // edge pass sets the stencil to 1 where it did not discard, the blend pass only runs there
+        VkPipelineDepthStencilStateCreateInfo edgeStencilState = {};
+        edgeStencilState.sType             = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+        edgeStencilState.depthTestEnable   = VK_FALSE;
+        edgeStencilState.depthWriteEnable  = VK_FALSE;
+        edgeStencilState.depthCompareOp    = VK_COMPARE_OP_ALWAYS;
+        edgeStencilState.stencilTestEnable = VK_TRUE;
+        edgeStencilState.front.failOp      = VK_STENCIL_OP_KEEP;
+        edgeStencilState.front.passOp      = VK_STENCIL_OP_REPLACE;
+        edgeStencilState.front.depthFailOp = VK_STENCIL_OP_KEEP;
+        edgeStencilState.front.compareOp   = VK_COMPARE_OP_ALWAYS;
+        edgeStencilState.front.compareMask = 0xff;
+        edgeStencilState.front.writeMask   = 0xff;
+        edgeStencilState.front.reference   = 1;
+        edgeStencilState.back              = edgeStencilState.front;
+        edgeStencilState.minDepthBounds    = 0.0f;
+        edgeStencilState.maxDepthBounds    = 1.0f;
+
+        VkPipelineDepthStencilStateCreateInfo blendStencilState = edgeStencilState;
+        blendStencilState.front.passOp    = VK_STENCIL_OP_KEEP;
+        blendStencilState.front.compareOp = VK_COMPARE_OP_EQUAL;
+        blendStencilState.front.writeMask = 0;
+        blendStencilState.back            = blendStencilState.front;
+
         edgePipeline = createGraphicsPipeline(pLogicalDevice,
                                               edgeVertexModule,
                                               &specializationInfo,
@@ -164,8 +221,10 @@ namespace vkBasalt
                                               &specializationInfo,
                                               "main",
                                               imageExtent,
-                                              unormRenderPass,
-                                              pipelineLayout);
+                                              edgeRenderPass,
+                                              pipelineLayout,
+                                              false,
+                                              stencilImage ? &edgeStencilState : nullptr);
 
         blendPipeline = createGraphicsPipeline(pLogicalDevice,
                                                blendVertexModule,
@@ -175,8 +234,10 @@ namespace vkBasalt
                                                &specializationInfo,
                                                "main",
                                                imageExtent,
-                                               unormRenderPass,
-                                               pipelineLayout);
+                                               blendRenderPass,
+                                               pipelineLayout,
+                                               false,
+                                               stencilImage ? &blendStencilState : nullptr);
 
         neighborPipeline = createGraphicsPipeline(pLogicalDevice,
                                                   neighborVertexModule,
@@ -201,8 +262,17 @@ namespace vkBasalt
                                                                          std::vector<VkSampler>(imageViewsVector.size(), sampler),
                                                                          imageViewsVector);
 
-        edgeFramebuffers     = createFramebuffers(pLogicalDevice, unormRenderPass, imageExtent, {edgeImageViews});
-        blendFramebuffers    = createFramebuffers(pLogicalDevice, unormRenderPass, imageExtent, {blendImageViews});
+        if (stencilImage)
+        {
+            std::vector<VkImageView> stencilImageViews(inputImageViews.size(), stencilImageView);
+            edgeFramebuffers  = createFramebuffers(pLogicalDevice, edgeRenderPass, imageExtent, {edgeImageViews, stencilImageViews});
+            blendFramebuffers = createFramebuffers(pLogicalDevice, blendRenderPass, imageExtent, {blendImageViews, stencilImageViews});
+        }
+        else
+        {
+            edgeFramebuffers  = createFramebuffers(pLogicalDevice, unormRenderPass, imageExtent, {edgeImageViews});
+            blendFramebuffers = createFramebuffers(pLogicalDevice, unormRenderPass, imageExtent, {blendImageViews});
+        }
         neignborFramebuffers = createFramebuffers(pLogicalDevice, renderPass, imageExtent, {outputImageViews});
     }
     void SmaaEffect::applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer)
@@ -251,13 +321,15 @@ namespace vkBasalt
         VkRenderPassBeginInfo renderPassBeginInfo;
         renderPassBeginInfo.sType             = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
         renderPassBeginInfo.pNext             = nullptr;
-        renderPassBeginInfo.renderPass        = unormRenderPass;
+        renderPassBeginInfo.renderPass        = edgeRenderPass;
         renderPassBeginInfo.framebuffer       = edgeFramebuffers[imageIndex];
         renderPassBeginInfo.renderArea.offset = {0, 0};
         renderPassBeginInfo.renderArea.extent = imageExtent;
-        VkClearValue clearValue               = {0.0f, 0.0f, 0.0f, 1.0f};
-        renderPassBeginInfo.clearValueCount   = 1;
-        renderPassBeginInfo.pClearValues      = &clearValue;
+        VkClearValue clearValues[2];
+        clearValues[0].color                = {{0.0f, 0.0f, 0.0f, 1.0f}};
+        clearValues[1].depthStencil         = {1.0f, 0};
+        renderPassBeginInfo.clearValueCount = stencilImage ? 2 : 1;
+        renderPassBeginInfo.pClearValues    = clearValues;
         // edge renderPass
         Logger::debug("before beginn edge renderpass");
         pLogicalDevice->vkd.CmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
@@ -277,6 +349,7 @@ namespace vkBasalt
         Logger::debug("after end renderpass");
 
         memoryBarrier.image             = edgeImages[imageIndex];
+        renderPassBeginInfo.renderPass  = blendRenderPass;
         renderPassBeginInfo.framebuffer = blendFramebuffers[imageIndex];
         // blend renderPass
         pLogicalDevice->vkd.CmdPipelineBarrier(
@@ -297,8 +370,9 @@ namespace vkBasalt
         Logger::debug("after end renderpass");
 
         memoryBarrier.image             = blendImages[imageIndex];
-        renderPassBeginInfo.framebuffer = neignborFramebuffers[imageIndex];
-        renderPassBeginInfo.renderPass  = renderPass;
+        renderPassBeginInfo.framebuffer     = neignborFramebuffers[imageIndex];
+        renderPassBeginInfo.renderPass      = renderPass;
+        renderPassBeginInfo.clearValueCount = 1;
         // neighbor renderPass
         pLogicalDevice->vkd.CmdPipelineBarrier(
             commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &memoryBarrier);
@@ -339,6 +413,11 @@ namespace vkBasalt
         pLogicalDevice->vkd.DestroyPipelineLayout(pLogicalDevice->device, pipelineLayout, nullptr);
         pLogicalDevice->vkd.DestroyRenderPass(pLogicalDevice->device, renderPass, nullptr);
         pLogicalDevice->vkd.DestroyRenderPass(pLogicalDevice->device, unormRenderPass, nullptr);
+        if (stencilImage)
+        {
+            pLogicalDevice->vkd.DestroyRenderPass(pLogicalDevice->device, edgeRenderPass, nullptr);
+            pLogicalDevice->vkd.DestroyRenderPass(pLogicalDevice->device, blendRenderPass, nullptr);
+        }
         pLogicalDevice->vkd.DestroyDescriptorSetLayout(pLogicalDevice->device, imageSamplerDescriptorSetLayout, nullptr);
 
         pLogicalDevice->vkd.DestroyShaderModule(pLogicalDevice->device, edgeVertexModule, nullptr);
@@ -349,9 +428,10 @@ namespace vkBasalt
         pLogicalDevice->vkd.DestroyShaderModule(pLogicalDevice->device, neignborFragmentModule, nullptr);
 
         pLogicalDevice->vkd.DestroyDescriptorPool(pLogicalDevice->device, descriptorPool, nullptr);
-        pLogicalDevice->vkd.FreeMemory(pLogicalDevice->device, imageMemory, nullptr);
-        pLogicalDevice->vkd.FreeMemory(pLogicalDevice->device, areaMemory, nullptr);
-        pLogicalDevice->vkd.FreeMemory(pLogicalDevice->device, searchMemory, nullptr);
+        freeMemory(pLogicalDevice, imageMemory);
+        freeMemory(pLogicalDevice, areaMemory);
+        freeMemory(pLogicalDevice, searchMemory);
+        freeMemory(pLogicalDevice, stencilMemory);
         for (unsigned int i = 0; i < edgeFramebuffers.size(); i++)
         {
             pLogicalDevice->vkd.DestroyFramebuffer(pLogicalDevice->device, edgeFramebuffers[i], nullptr);
@@ -369,6 +449,11 @@ namespace vkBasalt
         pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, areaImage, nullptr);
         pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, searchImageView, nullptr);
         pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, searchImage, nullptr);
+        if (stencilImage)
+        {
+            pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, stencilImageView, nullptr);
+            pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, stencilImage, nullptr);
+        }
 
         pLogicalDevice->vkd.DestroySampler(pLogicalDevice->device, sampler, nullptr);
     }
@@ -47,6 +47,10 @@ namespace vkBasalt
         VkImage                      searchImage;
         VkImageView                  areaImageView;
         VkImageView                  searchImageView;
+        VkFormat                     stencilFormat;
+        VkImage                      stencilImage     = VK_NULL_HANDLE; // marks the edge pixels, VK_NULL_HANDLE without a stencil format
+        VkImageView                  stencilImageView = VK_NULL_HANDLE;
+        VkDeviceMemory               stencilMemory    = VK_NULL_HANDLE;
         VkDescriptorSetLayout        imageSamplerDescriptorSetLayout;
         VkDescriptorPool             descriptorPool;
         VkShaderModule               edgeVertexModule;
@@ -57,6 +61,8 @@ namespace vkBasalt
         VkShaderModule               neignborFragmentModule;
         VkRenderPass                 renderPass;
         VkRenderPass                 unormRenderPass;
+        VkRenderPass                 edgeRenderPass;
+        VkRenderPass                 blendRenderPass;
         VkPipelineLayout             pipelineLayout;
         VkPipeline                   edgePipeline;
         VkPipeline                   blendPipeline;
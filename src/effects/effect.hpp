@@ -10,6 +10,7 @@
 
 #include "vulkan_include.hpp"
 #include "params/effect_param.hpp"
+#include "effect_regions.hpp"
 
 namespace vkBasalt
 {
@@ -17,8 +18,12 @@ namespace vkBasalt
     {
     public:
         void virtual applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer) = 0;
-        void virtual updateEffect(){};
+        // Writes the per frame values the command buffer of imageIndex reads, once its last submission finished
+        void virtual updateEffect(uint32_t imageIndex){};
         void virtual useDepthImage(VkImageView depthImageView){};
+        bool virtual usesDepth() const { return false; }
+        // Limits the effect to regions, returns false if it can't. Called before the command buffers are written
+        bool virtual setRegions(const EffectRegions& regions) { return false; }
         virtual std::vector<std::unique_ptr<EffectParam>> getParameters() const { return {}; }
         virtual ~Effect(){};
 
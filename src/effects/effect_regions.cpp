@@ -0,0 +1,290 @@
+#include "effect_regions.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <locale>
+#include <map>
+#include <sstream>
+#include <tuple>
+
+#include "config.hpp"
+#include "logger.hpp"
+
+#include "stb_image.h"
+
+namespace vkBasalt
+{
+    namespace
+    {
+        bool parseRect(const std::string& text, float rect[4])
+        {
+            std::stringstream ss(text);
+            ss.imbue(std::locale("C"));
+            char separators[3];
+            ss >> rect[0] >> separators[0] >> rect[1] >> separators[1] >> rect[2] >> separators[2] >> rect[3];
+            return !ss.fail() && separators[0] == ',' && separators[1] == ',' && separators[2] == ',';
+        }
+
+        // Merges the cells of the grid between xs and ys into rectangles,
+        // first runs of equal coverage within a row, then equal runs of consecutive rows
+        void splitGrid(const std::vector<int32_t>& xs, const std::vector<int32_t>& ys, const std::vector<bool>& covered, EffectRegions& regions)
+        {
+            size_t columns = xs.size() - 1;
+
+            // rectangles that reach the current row, by x range and coverage
+            std::map<std::tuple<int32_t, int32_t, bool>, size_t> open;
+            for (size_t row = 0; row + 1 < ys.size(); row++)
+            {
+                std::map<std::tuple<int32_t, int32_t, bool>, size_t> next;
+                for (size_t column = 0; column < columns;)
+                {
+                    bool   inside = covered[row * columns + column];
+                    size_t end    = column + 1;
+                    while (end < columns && covered[row * columns + end] == inside)
+                        end++;
+
+                    std::vector<VkRect2D>& rects = inside ? regions.inside : regions.outside;
+                    auto                   key   = std::make_tuple(xs[column], xs[end], inside);
+                    auto                   found = open.find(key);
+                    if (found != open.end())
+                    {
+                        rects[found->second].extent.height += ys[row + 1] - ys[row];
+                        next[key] = found->second;
+                    }
+                    else
+                    {
+                        VkRect2D rect;
+                        rect.offset = {xs[column], ys[row]};
+                        rect.extent = {static_cast<uint32_t>(xs[end] - xs[column]), static_cast<uint32_t>(ys[row + 1] - ys[row])};
+                        next[key]   = rects.size();
+                        rects.push_back(rect);
+                    }
+                    column = end;
+                }
+                open = std::move(next);
+            }
+        }
+    } // namespace
+
+    EffectRegions getEffectRegions(Config* pConfig, const std::string& effectName, VkExtent2D imageExtent)
+    {
+        EffectRegions regions;
+
+        std::vector<std::string> rectStrings = pConfig->getInstanceOption<std::vector<std::string>>(effectName, "regions");
+        std::string              maskFile    = pConfig->getInstanceOption<std::string>(effectName, "regionMask");
+        if (rectStrings.empty() && maskFile.empty())
+            return regions;
+
+        int32_t width  = imageExtent.width;
+        int32_t height = imageExtent.height;
+
+        // Covered rectangles in pixels, they may overlap
+        std::vector<VkRect2D> rects;
+        bool                  valid = false;
+
+        auto addRect = [&](int32_t x0, int32_t y0, int32_t x1, int32_t y1) {
+            x0 = std::clamp(x0, 0, width);
+            y0 = std::clamp(y0, 0, height);
+            x1 = std::clamp(x1, 0, width);
+            y1 = std::clamp(y1, 0, height);
+            if (x1 > x0 && y1 > y0)
+                rects.push_back({{x0, y0}, {static_cast<uint32_t>(x1 - x0), static_cast<uint32_t>(y1 - y0)}});
+        };
+
+        for (const auto& rectString : rectStrings)
+        {
+            float rect[4];
+            if (!parseRect(rectString, rect))
+            {
+                Logger::warn("invalid region \"" + rectString + "\" for " + effectName + ", expected x,y,width,height");
+                continue;
+            }
+            valid = true;
+            addRect(std::lround(rect[0] * width),
+                    std::lround(rect[1] * height),
+                    std::lround((rect[0] + rect[2]) * width),
+                    std::lround((rect[1] + rect[3]) * height));
+        }
+
+        if (!maskFile.empty())
+        {
+            int      maskWidth, maskHeight, channels;
+            stbi_uc* pixels = stbi_load(maskFile.c_str(), &maskWidth, &maskHeight, &channels, STBI_grey);
+            if (!pixels)
+            {
+                Logger::err("couldn't load region mask " + maskFile + " for " + effectName);
+            }
+            else
+            {
+                valid = true;
+                for (int32_t y = 0; y < maskHeight; y++)
+                {
+                    for (int32_t x = 0; x < maskWidth; x++)
+                    {
+                        if (pixels[y * maskWidth + x] >= 128)
+                        {
+                            addRect(static_cast<int64_t>(x) * width / maskWidth,
+                                    static_cast<int64_t>(y) * height / maskHeight,
+                                    static_cast<int64_t>(x + 1) * width / maskWidth,
+                                    static_cast<int64_t>(y + 1) * height / maskHeight);
+                        }
+                    }
+                }
+                stbi_image_free(pixels);
+            }
+        }
+
+        if (!valid)
+            return regions;
+
+        // Every rectangle edge becomes a grid line, each cell is then either fully covered or not
+        std::vector<int32_t> xs = {0, width};
+        std::vector<int32_t> ys = {0, height};
+        for (const auto& rect : rects)
+        {
+            xs.push_back(rect.offset.x);
+            xs.push_back(rect.offset.x + rect.extent.width);
+            ys.push_back(rect.offset.y);
+            ys.push_back(rect.offset.y + rect.extent.height);
+        }
+        std::sort(xs.begin(), xs.end());
+        xs.erase(std::unique(xs.begin(), xs.end()), xs.end());
+        std::sort(ys.begin(), ys.end());
+        ys.erase(std::unique(ys.begin(), ys.end()), ys.end());
+
+        size_t            columns = xs.size() - 1;
+        std::vector<bool> covered(columns * (ys.size() - 1), false);
+        for (const auto& rect : rects)
+        {
+            size_t column0 = std::lower_bound(xs.begin(), xs.end(), rect.offset.x) - xs.begin();
+            size_t column1 = std::lower_bound(xs.begin(), xs.end(), rect.offset.x + static_cast<int32_t>(rect.extent.width)) - xs.begin();
+            size_t row0    = std::lower_bound(ys.begin(), ys.end(), rect.offset.y) - ys.begin();
+            size_t row1    = std::lower_bound(ys.begin(), ys.end(), rect.offset.y + static_cast<int32_t>(rect.extent.height)) - ys.begin();
+            for (size_t row = row0; row < row1; row++)
+            {
+                for (size_t column = column0; column < column1; column++)
+                    covered[row * columns + column] = true;
+            }
+        }
+
+        splitGrid(xs, ys, covered, regions);
+
+        if (!regions.isActive())
+            return EffectRegions();
+
+        regions.bounds = {{0, 0}, imageExtent};
+        if (!regions.inside.empty())
+        {
+            int32_t x0 = width, y0 = height, x1 = 0, y1 = 0;
+            for (const auto& rect : regions.inside)
+            {
+                x0 = std::min(x0, rect.offset.x);
+                y0 = std::min(y0, rect.offset.y);
+                x1 = std::max(x1, rect.offset.x + static_cast<int32_t>(rect.extent.width));
+                y1 = std::max(y1, rect.offset.y + static_cast<int32_t>(rect.extent.height));
+            }
+            regions.bounds = {{x0, y0}, {static_cast<uint32_t>(x1 - x0), static_cast<uint32_t>(y1 - y0)}};
+        }
+
+        uint64_t insidePixels = 0;
+        for (const auto& rect : regions.inside)
+            insidePixels += static_cast<uint64_t>(rect.extent.width) * rect.extent.height;
+        Logger::info(effectName + " limited to " + std::to_string(regions.inside.size()) + " regions, "
+                     + std::to_string(insidePixels * 100 / (static_cast<uint64_t>(width) * height)) + "% of the image");
+
+        return regions;
+    }
+
+    void copyOutsideRegions(LogicalDevice*              pLogicalDevice,
+                            VkCommandBuffer             commandBuffer,
+                            const EffectRegions&        regions,
+                            VkImage                     input,
+                            VkImageLayout               inputLayout,
+                            const std::vector<VkImage>& outputs,
+                            VkImageLayout               outputLayout)
+    {
+        VkImageMemoryBarrier memoryBarrier;
+        memoryBarrier.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        memoryBarrier.pNext               = nullptr;
+        memoryBarrier.srcAccessMask       = VK_ACCESS_MEMORY_WRITE_BIT;
+        memoryBarrier.dstAccessMask       = VK_ACCESS_TRANSFER_READ_BIT;
+        memoryBarrier.oldLayout           = inputLayout;
+        memoryBarrier.newLayout           = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        memoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        memoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        memoryBarrier.image               = input;
+
+        memoryBarrier.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+        memoryBarrier.subresourceRange.baseMipLevel   = 0;
+        memoryBarrier.subresourceRange.levelCount     = 1;
+        memoryBarrier.subresourceRange.baseArrayLayer = 0;
+        memoryBarrier.subresourceRange.layerCount     = 1;
+
+        std::vector<VkImageMemoryBarrier> barriers = {memoryBarrier};
+        for (VkImage output : outputs)
+        {
+            // The previous effect may have rendered into or stored to it, its writes come before the copy's
+            memoryBarrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+            memoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            memoryBarrier.oldLayout     = VK_IMAGE_LAYOUT_UNDEFINED;
+            memoryBarrier.newLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            memoryBarrier.image         = output;
+            barriers.push_back(memoryBarrier);
+        }
+        pLogicalDevice->vkd.CmdPipelineBarrier(commandBuffer,
+                                               VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                                               VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                               0,
+                                               0,
+                                               nullptr,
+                                               0,
+                                               nullptr,
+                                               barriers.size(),
+                                               barriers.data());
+
+        std::vector<VkImageCopy> imageCopies;
+        for (const auto& rect : regions.outside)
+        {
+            VkImageCopy imageCopy;
+            imageCopy.srcSubresource            = {};
+            imageCopy.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            imageCopy.srcSubresource.layerCount = 1;
+            imageCopy.srcOffset                 = {rect.offset.x, rect.offset.y, 0};
+            imageCopy.dstSubresource            = imageCopy.srcSubresource;
+            imageCopy.dstOffset                 = imageCopy.srcOffset;
+            imageCopy.extent                    = {rect.extent.width, rect.extent.height, 1};
+            imageCopies.push_back(imageCopy);
+        }
+        for (VkImage output : outputs)
+        {
+            pLogicalDevice->vkd.CmdCopyImage(commandBuffer,
+                                             input,
+                                             VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                             output,
+                                             VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                             imageCopies.size(),
+                                             imageCopies.data());
+        }
+
+        // The effect reads the input in its shaders and renders into the outputs next
+        for (auto& barrier : barriers)
+        {
+            bool isInput          = barrier.image == input;
+            barrier.srcAccessMask = isInput ? VK_ACCESS_TRANSFER_READ_BIT : VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = isInput ? VK_ACCESS_SHADER_READ_BIT
+                                            : VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT;
+            barrier.oldLayout     = barrier.newLayout;
+            barrier.newLayout     = isInput ? inputLayout : outputLayout;
+        }
+        pLogicalDevice->vkd.CmdPipelineBarrier(commandBuffer,
+                                               VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                               VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                                               0,
+                                               0,
+                                               nullptr,
+                                               0,
+                                               nullptr,
+                                               barriers.size(),
+                                               barriers.data());
+    }
+} // namespace vkBasalt
@@ -0,0 +1,42 @@
+#ifndef EFFECT_REGIONS_HPP_INCLUDED
+#define EFFECT_REGIONS_HPP_INCLUDED
+#include <vector>
+#include <string>
+
+#include "vulkan_include.hpp"
+
+#include "logical_device.hpp"
+
+namespace vkBasalt
+{
+    class Config;
+
+    // The part of the image an effect is limited to, split into disjoint rectangles in pixels.
+    // The effect only renders inside, outside gets copied from its input unchanged
+    struct EffectRegions
+    {
+        std::vector<VkRect2D> inside;
+        std::vector<VkRect2D> outside;
+        VkRect2D              bounds = {};  // bounding box of inside, the whole image if inside is empty
+
+        // false if the effect covers the whole image
+        bool isActive() const { return !outside.empty(); }
+    };
+
+    // Reads "<effectName>.regions", a ':' separated list of "x,y,width,height" in fractions of the image,
+    // and "<effectName>.regionMask", a low resolution image where every bright pixel marks a tile to process.
+    // Both together are combined, without either the effect covers the whole image
+    EffectRegions getEffectRegions(Config* pConfig, const std::string& effectName, VkExtent2D imageExtent);
+
+    // Copies the outside rectangles of input into every output image. input is expected in and returned to inputLayout,
+    // the previous content of the outputs is discarded and they are left in outputLayout
+    void copyOutsideRegions(LogicalDevice*              pLogicalDevice,
+                            VkCommandBuffer             commandBuffer,
+                            const EffectRegions&        regions,
+                            VkImage                     input,
+                            VkImageLayout               inputLayout,
+                            const std::vector<VkImage>& outputs,
+                            VkImageLayout               outputLayout);
+} // namespace vkBasalt
+
+#endif // EFFECT_REGIONS_HPP_INCLUDED
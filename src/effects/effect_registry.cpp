@@ -1,10 +1,12 @@
 #include "effect_registry.hpp"
 
 #include <algorithm>
+#include <bit>
 #include <filesystem>
 #include <set>
 
 #include "reshade_parser.hpp"
+#include "reshade_metadata.hpp"
 #include "config_serializer.hpp"
 #include "builtin/builtin_effects.hpp"
 #include "logger.hpp"
@@ -81,6 +83,12 @@ namespace vkBasalt
 
             return "";
         }
+
+        // Parameter names are identifiers, so the last '/' always separates them from the effect name
+        std::string paramKey(const std::string& effectName, const std::string& paramName)
+        {
+            return effectName + "/" + paramName;
+        }
     } // anonymous namespace
 
     bool EffectRegistry::isBuiltInEffect(const std::string& name)
@@ -90,9 +98,19 @@ namespace vkBasalt
 
     void EffectRegistry::initialize(Config* pConfig)
     {
+        ScopedTimer timer("EffectRegistry::initialize");
         std::lock_guard<std::mutex> lock(mutex);
         this->pConfig = pConfig;
         effects.clear();
+        paramTable.clear();
+        paramEffects.clear();
+        paramVersions.clear();
+        dirtyParams.clear();
+        dirtyDefs.clear();
+        effectParamRanges.clear();
+        effectIndices.clear();
+        paramHandles.clear();
+        parametersVersion.fetch_add(1, std::memory_order_relaxed);
 
         std::vector<std::string> effectNames = pConfig->getOption<std::vector<std::string>>("effects");
         std::vector<std::string> disabledEffects = pConfig->getOption<std::vector<std::string>>("disabledEffects");
@@ -169,6 +187,7 @@ namespace vkBasalt
         }
 
         effects.push_back(std::move(config));
+        registerLastEffect();
     }
 
     void EffectRegistry::initReshadeEffect(const std::string& name, const std::string& path)
@@ -183,17 +202,20 @@ namespace vkBasalt
         std::filesystem::path p(path);
         config.effectType = p.stem().string();
 
-        // Test shader compilation first to catch errors
-        ShaderTestResult testResult = testShaderCompilation(name, path);
-        if (!testResult.success)
+        // Only preprocess here, errors of the full compile are reported when the effect is created
+        auto metadata = loadReshadeMetadata(path);
+        std::string error = !metadata->loaded ? "Failed to load shader file"
+                            : !metadata->errors.empty() ? "Preprocessor errors: " + metadata->errors
+                                                        : "";
+        if (!error.empty())
         {
-            config.compileError = testResult.errorMessage;
+            config.compileError = error;
             config.enabled = false;  // Disable failed effects by default
-            Logger::err("EffectRegistry: failed to compile " + name + ": " + testResult.errorMessage);
+            Logger::err("EffectRegistry: failed to load " + name + ": " + error);
         }
         else
         {
-            // Only parse parameters if compilation succeeded
+            // Only parse parameters if preprocessing succeeded
             config.parameters = parseReshadeEffect(name, path, pConfig);
 
             // Extract preprocessor definitions (user-configurable macros)
@@ -218,76 +240,80 @@ namespace vkBasalt
         }
 
         effects.push_back(std::move(config));
+        registerLastEffect();
     }
 
-    std::vector<const EffectConfig*> EffectRegistry::getEnabledEffects() const
+    void EffectRegistry::registerLastEffect()
     {
-        std::lock_guard<std::mutex> lock(mutex);
-        std::vector<const EffectConfig*> enabled;
+        uint32_t effectIndex = static_cast<uint32_t>(effects.size() - 1);
+        EffectConfig& effect = effects.back();
 
-        for (const auto& effect : effects)
+        // Moving the EffectConfig keeps the parameter objects in place, so the table can point at them
+        ParamHandle first = static_cast<ParamHandle>(paramTable.size());
+        for (auto& param : effect.parameters)
         {
-            if (effect.enabled)
-                enabled.push_back(&effect);
+            paramHandles.emplace(paramKey(effect.name, param->name), static_cast<ParamHandle>(paramTable.size()));
+            paramTable.push_back(param.get());
+            paramEffects.push_back(effectIndex);
+            paramVersions.push_back(0);
         }
+        dirtyParams.resize((paramTable.size() + 63) / 64, 0);
+        dirtyDefs.push_back(0);
+        effectParamRanges.emplace_back(first, static_cast<uint32_t>(effect.parameters.size()));
+        effectIndices.emplace(effect.name, effectIndex);
+    }
 
-        return enabled;
+    void EffectRegistry::markDirty(ParamHandle handle)
+    {
+        paramVersions[handle]++;
+        dirtyParams[handle / 64] |= uint64_t(1) << (handle % 64);
+        parametersVersion.fetch_add(1, std::memory_order_relaxed);
     }
 
-    std::vector<std::unique_ptr<EffectParam>> EffectRegistry::getAllParameters() const
+    std::vector<const EffectConfig*> EffectRegistry::getEnabledEffects() const
     {
         std::lock_guard<std::mutex> lock(mutex);
-        std::vector<std::unique_ptr<EffectParam>> params;
+        std::vector<const EffectConfig*> enabled;
 
         for (const auto& effect : effects)
         {
-            for (const auto& p : effect.parameters)
-                params.push_back(p->clone());
+            if (effect.enabled)
+                enabled.push_back(&effect);
         }
 
-        return params;
+        return enabled;
     }
 
     // Internal helper to find effect by name (assumes mutex is held)
     EffectConfig* EffectRegistry::findEffect(const std::string& effectName)
     {
-        for (auto& effect : effects)
-        {
-            if (effect.name == effectName)
-                return &effect;
-        }
-        return nullptr;
+        auto it = effectIndices.find(effectName);
+        return it != effectIndices.end() ? &effects[it->second] : nullptr;
     }
 
     const EffectConfig* EffectRegistry::findEffect(const std::string& effectName) const
     {
-        for (const auto& effect : effects)
-        {
-            if (effect.name == effectName)
-                return &effect;
-        }
-        return nullptr;
+        auto it = effectIndices.find(effectName);
+        return it != effectIndices.end() ? &effects[it->second] : nullptr;
     }
 
     // Internal helper to find parameter within an effect (assumes mutex is held)
     EffectParam* EffectRegistry::findParam(EffectConfig& effect, const std::string& paramName)
     {
-        for (auto& param : effect.parameters)
-        {
-            if (param->name == paramName)
-                return param.get();
-        }
-        return nullptr;
+        ParamHandle handle = findHandle(effect.name, paramName);
+        return handle != invalidParamHandle ? paramTable[handle] : nullptr;
     }
 
     const EffectParam* EffectRegistry::findParam(const EffectConfig& effect, const std::string& paramName) const
     {
-        for (const auto& param : effect.parameters)
-        {
-            if (param->name == paramName)
-                return param.get();
-        }
-        return nullptr;
+        ParamHandle handle = findHandle(effect.name, paramName);
+        return handle != invalidParamHandle ? paramTable[handle] : nullptr;
+    }
+
+    ParamHandle EffectRegistry::findHandle(const std::string& effectName, const std::string& paramName) const
+    {
+        auto it = paramHandles.find(paramKey(effectName, paramName));
+        return it != paramHandles.end() ? it->second : invalidParamHandle;
     }
 
     void EffectRegistry::setEffectEnabled(const std::string& effectName, bool enabled)
@@ -327,7 +353,10 @@ namespace vkBasalt
 
         EffectParam* param = findParam(*effect, paramName);
         if (param && param->getType() == ParamType::Float)
+        {
             static_cast<FloatParam*>(param)->value = value;
+            markDirty(findHandle(effectName, paramName));
+        }
     }
 
     void EffectRegistry::setParameterValue(const std::string& effectName, const std::string& paramName, int value)
@@ -340,7 +369,10 @@ namespace vkBasalt
 
         EffectParam* param = findParam(*effect, paramName);
         if (param && param->getType() == ParamType::Int)
+        {
             static_cast<IntParam*>(param)->value = value;
+            markDirty(findHandle(effectName, paramName));
+        }
     }
 
     void EffectRegistry::setParameterValue(const std::string& effectName, const std::string& paramName, bool value)
@@ -353,7 +385,10 @@ namespace vkBasalt
 
         EffectParam* param = findParam(*effect, paramName);
         if (param && param->getType() == ParamType::Bool)
+        {
             static_cast<BoolParam*>(param)->value = value;
+            markDirty(findHandle(effectName, paramName));
+        }
     }
 
     EffectParam* EffectRegistry::getParameter(const std::string& effectName, const std::string& paramName)
@@ -381,16 +416,67 @@ namespace vkBasalt
     std::vector<EffectParam*> EffectRegistry::getParametersForEffect(const std::string& effectName)
     {
         std::lock_guard<std::mutex> lock(mutex);
-        std::vector<EffectParam*> result;
 
-        EffectConfig* effect = findEffect(effectName);
-        if (!effect)
-            return result;
+        auto it = effectIndices.find(effectName);
+        if (it == effectIndices.end())
+            return {};
 
-        for (auto& param : effect->parameters)
-            result.push_back(param.get());
+        auto [first, count] = effectParamRanges[it->second];
+        return std::vector<EffectParam*>(paramTable.begin() + first, paramTable.begin() + first + count);
+    }
 
-        return result;
+    ParamHandle EffectRegistry::getParameterHandle(const std::string& effectName, const std::string& paramName) const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return findHandle(effectName, paramName);
+    }
+
+    EffectParam* EffectRegistry::getParameter(ParamHandle handle)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return handle < paramTable.size() ? paramTable[handle] : nullptr;
+    }
+
+    uint64_t EffectRegistry::getParameterVersion(ParamHandle handle) const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return handle < paramVersions.size() ? paramVersions[handle] : 0;
+    }
+
+    void EffectRegistry::markParameterChanged(const EffectParam& param)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ParamHandle handle = findHandle(param.effectName, param.name);
+        if (handle != invalidParamHandle)
+            markDirty(handle);
+    }
+
+    std::vector<std::string> EffectRegistry::takeDirtyEffects()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        std::vector<uint8_t> dirtyEffects = std::move(dirtyDefs);
+        dirtyDefs.assign(effects.size(), 0);
+
+        for (size_t word = 0; word < dirtyParams.size(); word++)
+        {
+            uint64_t bits = dirtyParams[word];
+            while (bits)
+            {
+                size_t bit = static_cast<size_t>(std::countr_zero(bits));
+                dirtyEffects[paramEffects[word * 64 + bit]] = 1;
+                bits &= bits - 1;
+            }
+            dirtyParams[word] = 0;
+        }
+
+        std::vector<std::string> names;
+        for (size_t i = 0; i < dirtyEffects.size(); i++)
+        {
+            if (dirtyEffects[i])
+                names.push_back(effects[i].name);
+        }
+        return names;
     }
 
     bool EffectRegistry::hasEffect(const std::string& name) const
@@ -502,6 +588,7 @@ namespace vkBasalt
             if (def.name == macroName)
             {
                 def.value = value;
+                dirtyDefs[effectIndices[effectName]] = 1;
                 return;
             }
         }
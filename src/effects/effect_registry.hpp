@@ -1,6 +1,8 @@
 #ifndef EFFECT_REGISTRY_HPP_INCLUDED
 #define EFFECT_REGISTRY_HPP_INCLUDED
 
+#include <atomic>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -13,6 +15,10 @@
 
 namespace vkBasalt
 {
+    // Index of a parameter in the registry's flat tables, stable until initialize() runs again
+    using ParamHandle = uint32_t;
+    constexpr ParamHandle invalidParamHandle = UINT32_MAX;
+
     // EffectRegistry is the single source of truth for all effect configurations.
     // UI reads/writes here, rendering reads from here.
     class EffectRegistry
@@ -27,9 +33,6 @@ namespace vkBasalt
         // Get only enabled effects (for rendering) - returns pointers to avoid copying
         std::vector<const EffectConfig*> getEnabledEffects() const;
 
-        // Get all parameters from all effects (for UI)
-        std::vector<std::unique_ptr<EffectParam>> getAllParameters() const;
-
         // Toggle effect enabled state
         void setEffectEnabled(const std::string& effectName, bool enabled);
 
@@ -51,6 +54,21 @@ namespace vkBasalt
         // Get all parameters for a specific effect (returns pointers, not clones)
         std::vector<EffectParam*> getParametersForEffect(const std::string& effectName);
 
+        // Resolve a parameter once, afterwards it's reached by index without a name lookup
+        ParamHandle getParameterHandle(const std::string& effectName, const std::string& paramName) const;
+        EffectParam* getParameter(ParamHandle handle);
+        uint64_t getParameterVersion(ParamHandle handle) const;
+
+        // Call after writing a parameter value directly (UI editors), bumps its version and marks its effect dirty
+        void markParameterChanged(const EffectParam& param);
+
+        // Incremented on every parameter change, cheap to compare for anything caching parameter values
+        uint64_t getParametersVersion() const { return parametersVersion.load(std::memory_order_relaxed); }
+
+        // Effects whose parameters or preprocessor definitions changed since the last call, in registry order.
+        // Clears the dirty bits, the caller is expected to recreate these effects
+        std::vector<std::string> takeDirtyEffects();
+
         // Get config reference for effects to read values
         Config* getConfig() const { return pConfig; }
 
@@ -112,11 +130,28 @@ namespace vkBasalt
         // Initialize ReShade effect config
         void initReshadeEffect(const std::string& name, const std::string& path);
 
+        // Flat parameter tables indexed by ParamHandle, an effect's parameters are one contiguous range.
+        // The EffectParam objects themselves stay in EffectConfig::parameters
+        std::vector<EffectParam*> paramTable;
+        std::vector<uint32_t> paramEffects;                     // owning index into effects
+        std::vector<uint64_t> paramVersions;
+        std::vector<uint64_t> dirtyParams;                      // one bit per handle
+        std::vector<uint8_t> dirtyDefs;                         // per effect, preprocessor definitions changed
+        std::vector<std::pair<ParamHandle, uint32_t>> effectParamRanges;  // per effect, first handle and count
+        std::unordered_map<std::string, uint32_t> effectIndices;
+        std::unordered_map<std::string, ParamHandle> paramHandles;  // key is "effect/param"
+        std::atomic<uint64_t> parametersVersion{0};
+
+        // Add the last pushed effect to the lookup tables
+        void registerLastEffect();
+        void markDirty(ParamHandle handle);
+
         // Internal helpers (assume mutex is held)
         EffectConfig* findEffect(const std::string& effectName);
         const EffectConfig* findEffect(const std::string& effectName) const;
         EffectParam* findParam(EffectConfig& effect, const std::string& paramName);
         const EffectParam* findParam(const EffectConfig& effect, const std::string& paramName) const;
+        ParamHandle findHandle(const std::string& effectName, const std::string& paramName) const;
     };
 
 } // namespace vkBasalt
@@ -9,6 +9,8 @@
 #include <variant>
 #include <algorithm>
 #include <filesystem>
+#include <future>
+#include <stdexcept>
 
 #include "image_view.hpp"
 #include "descriptor_set.hpp"
@@ -19,22 +21,127 @@
 #include "shader.hpp"
 #include "sampler.hpp"
 #include "image.hpp"
+#include "memory.hpp"
 #include "format.hpp"
 #include "config_serializer.hpp"
+#include "settings_manager.hpp"
+#include "reshade_pass_analysis.hpp"
+#include "effect_regions.hpp"
 
 #include "util.hpp"
 
 #include "stb_image.h"
 #include "stb_image_dds.h"
-#include "stb_image_resize.h"
+
+#include "reshade/spirv.hpp"
 
 namespace vkBasalt
 {
+    namespace
+    {
+        // Rewrites the DescriptorSet decoration of the given variables
+        void setDescriptorSet(std::vector<uint32_t>& spirv, const std::set<uint32_t>& ids, uint32_t set)
+        {
+            for (size_t i = 5; i < spirv.size();)
+            {
+                uint32_t wordCount = spirv[i] >> 16;
+                if (wordCount == 0 || i + wordCount > spirv.size())
+                    break;
+                if ((spirv[i] & 0xFFFF) == spv::OpDecorate && wordCount == 4 && spirv[i + 2] == spv::DecorationDescriptorSet
+                    && ids.count(spirv[i + 1]))
+                {
+                    spirv[i + 3] = set;
+                }
+                i += wordCount;
+            }
+        }
+
+        VkWriteDescriptorSet imageSamplerWrite(VkDescriptorSet dstSet, uint32_t binding)
+        {
+            VkWriteDescriptorSet writeDescriptorSet = {};
+
+            writeDescriptorSet.sType            = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writeDescriptorSet.pNext            = nullptr;
+            writeDescriptorSet.dstSet           = dstSet;
+            writeDescriptorSet.dstBinding       = binding;
+            writeDescriptorSet.dstArrayElement  = 0;
+            writeDescriptorSet.descriptorCount  = 1;
+            writeDescriptorSet.descriptorType   = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            writeDescriptorSet.pImageInfo       = nullptr;
+            writeDescriptorSet.pBufferInfo      = nullptr;
+            writeDescriptorSet.pTexelBufferView = nullptr;
+            return writeDescriptorSet;
+        }
+
+        // Pixels of a source texture as they are in the file, the GPU scales them to the texture size
+        struct DecodedTexture
+        {
+            // Also freed if the effect throws before the texture got uploaded
+            std::unique_ptr<stbi_uc, decltype(&stbi_image_free)> pixels{nullptr, stbi_image_free};
+
+            int         width  = 0;
+            int         height = 0;
+            uint32_t    size   = 0;
+            std::string error;
+        };
+
+        // Runs on the decode threads. stb_image.c is built without failure strings and its failure reason is thread local,
+        // the remaining globals are settings vkBasalt never changes
+        DecodedTexture decodeTexture(const std::vector<std::string>& searchPaths, const std::string& textureName, int desiredChannels, bool toRG)
+        {
+            DecodedTexture decoded;
+
+            FILE* file = nullptr;
+            for (const auto& texPath : searchPaths)
+            {
+                file = fopen((texPath + "/" + textureName).c_str(), "rb");
+                if (file != nullptr)
+                    break;
+            }
+            if (file == nullptr)
+            {
+                decoded.error = "couldn't open texture: " + textureName + " (searched " + std::to_string(searchPaths.size()) + " directories)";
+                return decoded;
+            }
+
+            int channels;
+            if (stbi_dds_test_file(file))
+                decoded.pixels.reset(stbi_dds_load_from_file(file, &decoded.width, &decoded.height, &channels, desiredChannels));
+            else
+                decoded.pixels.reset(stbi_load_from_file(file, &decoded.width, &decoded.height, &channels, desiredChannels));
+            fclose(file);
+
+            if (decoded.pixels == nullptr)
+            {
+                decoded.error = "couldn't decode texture: " + textureName;
+                return decoded;
+            }
+            decoded.size = static_cast<uint32_t>(decoded.width) * decoded.height * desiredChannels;
+
+            // change RGBA to RG
+            if (toRG)
+            {
+                stbi_uc* pixels = decoded.pixels.get();
+                uint32_t pos    = 0;
+                for (uint32_t j = 0; j < decoded.size; j += 4)
+                {
+                    pixels[pos] = pixels[j];
+                    pos++;
+                    pixels[pos] = pixels[j + 1];
+                    pos++;
+                }
+                decoded.size /= 2;
+            }
+            return decoded;
+        }
+    } // namespace
+
     ReshadeEffect::ReshadeEffect(LogicalDevice*       pLogicalDevice,
                                  VkFormat             format,
                                  VkExtent2D           imageExtent,
                                  std::vector<VkImage> inputImages,
                                  std::vector<VkImage> outputImages,
+                                 ScratchImages*       pScratchImages,
                                  EffectRegistry*      pEffectRegistry,
                                  std::string          effectName,
                                  std::string          effectPath,
@@ -46,6 +153,7 @@ namespace vkBasalt
         this->imageExtent           = imageExtent;
         this->inputImages           = inputImages;
         this->outputImages          = outputImages;
+        this->pScratchImages        = pScratchImages;
         this->pEffectRegistry       = pEffectRegistry;
         this->effectName            = effectName;
         this->effectPath            = effectPath;
@@ -53,6 +161,9 @@ namespace vkBasalt
         inputOutputFormatUNORM = convertToUNORM(format);
         inputOutputFormatSRGB  = convertToSRGB(format);
 
+        // Compile first, a shader that fails to parse throws before anything is allocated
+        createReshadeModule();
+
         inputImageViewsSRGB  = createImageViews(pLogicalDevice, inputOutputFormatSRGB, inputImages);
         inputImageViewsUNORM = createImageViews(pLogicalDevice, inputOutputFormatUNORM, inputImages);
         Logger::debug("created input ImageViews");
@@ -60,38 +171,74 @@ namespace vkBasalt
         outputImageViewsUNORM = createImageViews(pLogicalDevice, inputOutputFormatUNORM, outputImages);
         Logger::debug("created ImageViews");
 
-        createReshadeModule();
+        pruneDeadPasses();
 
-        enumerateReshadeUniforms(module);
-
-        uniforms = createReshadeUniforms(module);
+        {
+            ScopedTimer timer("creating uniforms of", effectName);
+            enumerateReshadeUniforms(module);
+            uniforms = std::make_unique<ReshadeUniforms>(module);
+        }
 
         bufferSize = module.total_uniform_size;
         if (bufferSize)
         {
+            // The uniforms of one image can be written while the frames of the others are still on the GPU
+            VkPhysicalDeviceProperties deviceProperties;
+            pLogicalDevice->vki.GetPhysicalDeviceProperties(pLogicalDevice->physicalDevice, &deviceProperties);
+            VkDeviceSize alignment = deviceProperties.limits.minUniformBufferOffsetAlignment;
+            uniformStride          = (bufferSize + alignment - 1) / alignment * alignment;
+
             createBuffer(pLogicalDevice,
-                         bufferSize,
+                         uniformStride * inputImages.size(),
                          VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
                          stagingBuffer,
                          stagingBufferMemory);
+
+            // Host coherent, so it can stay mapped for the lifetime of the effect
+            VkResult result = pLogicalDevice->vkd.MapMemory(pLogicalDevice->device, stagingBufferMemory, 0, VK_WHOLE_SIZE, 0, &mappedUniformBuffer);
+            ASSERT_VULKAN(result);
         }
 
-        stencilFormat = getStencilFormat(pLogicalDevice);
+        stencilFormat = pScratchImages->getStencilFormat();
         Logger::debug("Stencil Format: " + std::to_string(stencilFormat));
-        textureMemory.push_back(VK_NULL_HANDLE);
-        stencilImage = createImages(pLogicalDevice,
-                                    1,
-                                    {imageExtent.width, imageExtent.height, 1},
-                                    stencilFormat,
-                                    VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
-                                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                                    textureMemory.back())[0];
 
-        stencilImageView = createImageViews(
-            pLogicalDevice, stencilFormat, {stencilImage}, VK_IMAGE_VIEW_TYPE_2D, VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT)[0];
+        // Source textures are decoded in parallel, each one is waited for when its image gets filled
+        std::vector<std::future<DecodedTexture>> decodedTextures(module.textures.size());
+        {
+            std::vector<std::string> searchPaths = ConfigSerializer::loadShaderManagerConfig().discoveredTexturePaths;
+            for (size_t i = 0; i < module.textures.size(); i++)
+            {
+                const auto& texture = module.textures[i];
+                const auto  source  = std::find_if(
+                    texture.annotations.begin(), texture.annotations.end(), [](const auto& a) { return a.name == "source"; });
+                if (source == texture.annotations.end() || texture.semantic == "COLOR" || texture.semantic == "DEPTH"
+                    || !liveTextures.count(texture.unique_name))
+                    continue;
 
-        std::vector<std::vector<VkImageView>> imageViewVector;
+                int desiredChannels;
+                switch (convertToUNORM(convertReshadeFormat(texture.format)))
+                {
+                    case VK_FORMAT_R8_UNORM: desiredChannels = STBI_grey; break;
+                    case VK_FORMAT_R8G8_UNORM:
+                        desiredChannels = STBI_rgb_alpha; // TODO why doesn't STBI_grey_alpha work?
+                        break;
+                    case VK_FORMAT_R8G8B8A8_UNORM: desiredChannels = STBI_rgb_alpha; break;
+                    default:
+                        Logger::err("unsupported texture upload format" + std::to_string(convertReshadeFormat(texture.format)));
+                        desiredChannels = 4;
+                        break;
+                }
+                bool toRG = convertToUNORM(convertReshadeFormat(texture.format)) == VK_FORMAT_R8G8_UNORM;
+
+                decodedTextures[i] = std::async(std::launch::async,
+                                                decodeTexture,
+                                                searchPaths,
+                                                std::string(source->value.string_data),
+                                                desiredChannels,
+                                                toRG);
+            }
+        }
 
         for (size_t i = 0; i < module.textures.size(); i++)
         {
@@ -121,6 +268,14 @@ namespace vkBasalt
                 textureFormatsSRGB[module.textures[i].unique_name]  = inputOutputFormatSRGB;
                 continue;
             }
+            if (!liveTextures.count(module.textures[i].unique_name))
+            {
+                // Only used by pruned passes or disabled code, samplers still need something valid to point at
+                textureImageViewsUNORM[module.textures[i].unique_name] = inputImageViewsUNORM;
+                textureImageViewsSRGB[module.textures[i].unique_name]  = inputImageViewsSRGB;
+                Logger::debug("skipping unused texture " + module.textures[i].unique_name);
+                continue;
+            }
             VkExtent3D textureExtent = {module.textures[i].width, module.textures[i].height, 1};
             // TODO handle mip map levels correctly
             // TODO handle pooled textures better
@@ -225,165 +380,139 @@ namespace vkBasalt
                 textureFormatsUNORM[module.textures[i].unique_name] = convertToUNORM(convertReshadeFormat(module.textures[i].format));
                 textureFormatsSRGB[module.textures[i].unique_name]  = convertToSRGB(convertReshadeFormat(module.textures[i].format));
 
-                int desiredChannels;
-                switch (textureFormatsUNORM[module.textures[i].unique_name])
+                DecodedTexture decoded = decodedTextures[i].get();
+                if (decoded.pixels == nullptr)
                 {
-                    case VK_FORMAT_R8_UNORM: desiredChannels = STBI_grey; break;
-                    case VK_FORMAT_R8G8_UNORM:
-                        desiredChannels = STBI_rgb_alpha; // TODO why doesn't STBI_grey_alpha work?
-                        break;
-                    case VK_FORMAT_R8G8B8A8_UNORM: desiredChannels = STBI_rgb_alpha; break;
-                    case VK_FORMAT_R8G8B8A8_SRGB: desiredChannels = STBI_rgb_alpha; break;
-                    default:
-                        Logger::err("unsupported texture upload format" + std::to_string(textureFormatsUNORM[module.textures[i].unique_name]));
-                        desiredChannels = 4;
-                        break;
+                    // Leave it empty but in a layout the passes can sample
+                    Logger::err(decoded.error);
+                    changeImageLayout(pLogicalDevice, images, module.textures[i].levels);
+                    continue;
                 }
 
-                // Search for texture in discovered paths from shader manager
-                std::string textureName = source->value.string_data;
-                std::string filePath;
-                FILE* file = nullptr;
+                uploadToImageScaled(pLogicalDevice,
+                                    images[0],
+                                    textureExtent,
+                                    textureFormatsUNORM[module.textures[i].unique_name],
+                                    {static_cast<uint32_t>(decoded.width), static_cast<uint32_t>(decoded.height), 1},
+                                    decoded.size,
+                                    decoded.pixels.get(),
+                                    module.textures[i].levels);
+            }
+        }
 
-                ShaderManagerConfig shaderMgrConfig = ConfigSerializer::loadShaderManagerConfig();
-                for (const auto& texPath : shaderMgrConfig.discoveredTexturePaths)
-                {
-                    filePath = texPath + "/" + textureName;
-                    file = fopen(filePath.c_str(), "rb");
-                    if (file != nullptr)
-                        break;
-                }
+        std::vector<bool> isInputSampler(module.samplers.size(), false);
+        for (auto& inputSampler : inputSamplers)
+            isInputSampler[inputSampler.binding] = true;
 
-                stbi_uc*             pixels;
-                std::vector<stbi_uc> resizedPixels;
-                uint32_t             size;
-                int                  width;
-                int                  height;
+        // Everything but the input samplers looks the same for every image, so set 1 is written once
+        std::vector<uint32_t>                 textureBindings;
+        std::vector<VkSampler>                textureSamplers;
+        std::vector<std::vector<VkImageView>> textureViews;
 
-                size = textureExtent.width * textureExtent.height * desiredChannels;
+        for (size_t i = 0; i < module.samplers.size(); i++)
+        {
+            reshadefx::sampler_info info = module.samplers[i];
 
-                if (file == nullptr)
-                {
-                    Logger::err("couldn't open texture: " + textureName + " (searched " +
-                        std::to_string(shaderMgrConfig.discoveredTexturePaths.size()) + " directories)");
-                }
-                if (stbi_dds_test_file(file))
-                {
-                    int channels;
-                    pixels = stbi_dds_load_from_file(file, &width, &height, &channels, desiredChannels);
-                }
-                else
-                {
-                    int channels;
-                    pixels = stbi_load_from_file(file, &width, &height, &channels, desiredChannels);
-                }
+            VkSampler sampler = createReshadeSampler(pLogicalDevice, info);
 
-                // change RGBA to RG
-                if (textureFormatsUNORM[module.textures[i].unique_name] == VK_FORMAT_R8G8_UNORM)
-                {
-                    uint32_t pos = 0;
-                    for (uint32_t j = 0; j < size; j += 4)
-                    {
-                        pixels[pos] = pixels[j];
-                        pos++;
-                        pixels[pos] = pixels[j + 1];
-                        pos++;
-                    }
-                    size /= 2;
-                    desiredChannels /= 2;
-                }
+            samplers.push_back(sampler);
 
-                if (static_cast<uint32_t>(width) != textureExtent.width || static_cast<uint32_t>(height) != textureExtent.height)
-                {
-                    resizedPixels.resize(size);
-                    stbir_resize_uint8(pixels, width, height, 0, resizedPixels.data(), textureExtent.width, textureExtent.height, 0, desiredChannels);
-                }
+            if (isInputSampler[info.binding])
+                continue;
 
-                uploadToImage(
-                    pLogicalDevice, images[0], textureExtent, size, resizedPixels.size() ? resizedPixels.data() : pixels, module.textures[i].levels);
-                stbi_image_free(pixels);
-            }
+            textureBindings.push_back(info.binding);
+            textureSamplers.push_back(sampler);
+            textureViews.push_back({info.srgb ? textureImageViewsSRGB[info.texture_name][0] : textureImageViewsUNORM[info.texture_name][0]});
         }
 
-        for (size_t i = 0; i < module.samplers.size(); i++)
+        // count the back buffer writes
+        for (auto& pass : module.techniques[0].passes)
         {
-            reshadefx::sampler_info info = module.samplers[i];
+            if (pass.render_target_names[0] == "")
+            {
+                outputWrites++;
+            }
+        }
+        Logger::debug("output writes: " + std::to_string(outputWrites));
 
-            VkSampler sampler = createReshadeSampler(pLogicalDevice, info);
+        // if there is only one outputWrite, we can directly write to outputImages
+        if (outputWrites > 1)
+        {
+            backBufferImages          = pScratchImages->getBackBufferImages();
+            backBufferImageViewsSRGB  = pScratchImages->getBackBufferImageViews(true);
+            backBufferImageViewsUNORM = pScratchImages->getBackBufferImageViews(false);
+        }
 
-            samplers.push_back(sampler);
+        std::vector<uint32_t> inputBindings;
+        for (auto& inputSampler : inputSamplers)
+            inputBindings.push_back(inputSampler.binding);
 
-            imageViewVector.push_back(info.srgb ? textureImageViewsSRGB[info.texture_name] : textureImageViewsUNORM[info.texture_name]);
-        }
+        // 32 is the smallest maxPushDescriptors the extension allows
+        pushInputSamplers = pLogicalDevice->supportsPushDescriptor && !inputSamplers.empty() && inputSamplers.size() <= 32;
+        Logger::debug(std::to_string(inputSamplers.size()) + " input samplers" + (pushInputSamplers ? ", pushed" : ""));
 
-        imageSamplerDescriptorSetLayout = createImageSamplerDescriptorSetLayout(pLogicalDevice, module.samplers.size());
-        uniformDescriptorSetLayout      = createUniformBufferDescriptorSetLayout(pLogicalDevice);
+        textureDescriptorSetLayout = createImageSamplerDescriptorSetLayout(pLogicalDevice, textureBindings);
+        inputDescriptorSetLayout   = createImageSamplerDescriptorSetLayout(
+            pLogicalDevice, inputBindings, pushInputSamplers ? VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR : 0);
+        uniformDescriptorSetLayout = createUniformBufferDescriptorSetLayout(pLogicalDevice);
         Logger::debug("created descriptorSetLayouts");
 
-        VkDescriptorPoolSize imagePoolSize;
-        imagePoolSize.type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        imagePoolSize.descriptorCount = inputImages.size() * module.samplers.size() * 3;
+        // Without push descriptors set 2 exists per image for the input, back buffer and output views,
+        // the latter two only if the passes flip between them
+        uint32_t inputVariants = std::clamp(outputWrites, 1, 3);
+        uint32_t inputSetCount = (pushInputSamplers || inputSamplers.empty()) ? 0 : inputVariants * inputImages.size();
 
         VkDescriptorPoolSize bufferPoolSize;
         bufferPoolSize.type            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        bufferPoolSize.descriptorCount = 3;
+        bufferPoolSize.descriptorCount = inputImages.size();
 
-        std::vector<VkDescriptorPoolSize> poolSizes = {imagePoolSize, bufferPoolSize};
+        std::vector<VkDescriptorPoolSize> poolSizes = {bufferPoolSize};
+
+        VkDescriptorPoolSize imagePoolSize;
+        imagePoolSize.type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        imagePoolSize.descriptorCount = textureBindings.size() + inputSetCount * inputBindings.size();
+        if (imagePoolSize.descriptorCount)
+            poolSizes.push_back(imagePoolSize);
 
         descriptorPool = createDescriptorPool(pLogicalDevice, poolSizes);
         Logger::debug("created descriptorPool");
 
-        std::vector<VkDescriptorSetLayout> descriptorSetLayouts = {uniformDescriptorSetLayout, imageSamplerDescriptorSetLayout};
+        std::vector<VkDescriptorSetLayout> descriptorSetLayouts = {uniformDescriptorSetLayout, textureDescriptorSetLayout, inputDescriptorSetLayout};
 
         pipelineLayout = createGraphicsPipelineLayout(pLogicalDevice, descriptorSetLayouts);
 
         Logger::debug("created Pipeline layout");
 
-        Logger::debug("output writes: " + std::to_string(outputWrites));
         if (bufferSize)
         {
-            bufferDescriptorSet = writeBufferDescriptorSet(pLogicalDevice, descriptorPool, uniformDescriptorSetLayout, stagingBuffer);
-        }
-
-        inputDescriptorSets =
-            allocateAndWriteImageSamplerDescriptorSets(pLogicalDevice, descriptorPool, imageSamplerDescriptorSetLayout, samplers, imageViewVector);
-
-        // count the back buffer writes
-        for (auto& pass : module.techniques[0].passes)
-        {
-            if (pass.render_target_names[0] == "")
+            for (uint32_t j = 0; j < inputImages.size(); j++)
             {
-                outputWrites++;
+                bufferDescriptorSets.push_back(writeBufferDescriptorSet(
+                    pLogicalDevice, descriptorPool, uniformDescriptorSetLayout, stagingBuffer, uniformStride * j, bufferSize));
             }
         }
 
-        // if there is only one outputWrite, we can directly write to outputImages
-        if (outputWrites > 1)
+        if (!textureBindings.empty())
         {
-            textureMemory.push_back(VK_NULL_HANDLE);
-            backBufferImages = createImages(pLogicalDevice,
-                                            inputImages.size(),
-                                            {imageExtent.width, imageExtent.height, 1},
-                                            format, // TODO search for format and save it
-                                            VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
-                                            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                                            textureMemory.back());
-
-            backBufferImageViewsSRGB  = createImageViews(pLogicalDevice, inputOutputFormatSRGB, backBufferImages);
-            backBufferImageViewsUNORM = createImageViews(pLogicalDevice, inputOutputFormatUNORM, backBufferImages);
-
-            std::replace(imageViewVector.begin(), imageViewVector.end(), inputImageViewsSRGB, backBufferImageViewsSRGB);
-            std::replace(imageViewVector.begin(), imageViewVector.end(), inputImageViewsUNORM, backBufferImageViewsUNORM);
-
-            backBufferDescriptorSets = allocateAndWriteImageSamplerDescriptorSets(
-                pLogicalDevice, descriptorPool, imageSamplerDescriptorSetLayout, samplers, imageViewVector);
+            textureDescriptorSet = allocateAndWriteImageSamplerDescriptorSets(
+                pLogicalDevice, descriptorPool, textureDescriptorSetLayout, textureBindings, textureSamplers, textureViews)[0];
         }
-        if (outputWrites > 2)
+
+        for (uint32_t variant = 0; inputSetCount && variant < inputVariants; variant++)
         {
-            std::replace(imageViewVector.begin(), imageViewVector.end(), backBufferImageViewsSRGB, outputImageViewsSRGB);
-            std::replace(imageViewVector.begin(), imageViewVector.end(), backBufferImageViewsUNORM, outputImageViewsUNORM);
-            outputDescriptorSets = allocateAndWriteImageSamplerDescriptorSets(
-                pLogicalDevice, descriptorPool, imageSamplerDescriptorSetLayout, samplers, imageViewVector);
+            std::vector<VkSampler>                inputSamplerHandles;
+            std::vector<std::vector<VkImageView>> inputViews;
+            for (auto& inputSampler : inputSamplers)
+            {
+                inputSamplerHandles.push_back(samplers[inputSampler.binding]);
+                inputViews.emplace_back();
+                for (uint32_t j = 0; j < inputImages.size(); j++)
+                    inputViews.back().push_back(getInputSamplerView(inputSampler, j, variant));
+            }
+
+            std::vector<VkDescriptorSet> variantSets = allocateAndWriteImageSamplerDescriptorSets(
+                pLogicalDevice, descriptorPool, inputDescriptorSetLayout, inputBindings, inputSamplerHandles, inputViews);
+            inputDescriptorSets.insert(inputDescriptorSets.end(), variantSets.begin(), variantSets.end());
         }
 
         Logger::debug("after writing ImageSamplerDescriptorSets");
@@ -476,9 +605,11 @@ namespace vkBasalt
 
             uint32_t depthAttachmentCount = 0;
 
-            if (scissor.extent.width == imageExtent.width && scissor.extent.height == imageExtent.height)
+            if (pass.stencil_enable && scissor.extent.width == imageExtent.width && scissor.extent.height == imageExtent.height)
             {
                 depthAttachmentCount = 1;
+                stencilImage         = pScratchImages->getStencilImage();
+                stencilImageView     = pScratchImages->getStencilImageView();
 
                 attachmentImageViews.push_back(std::vector<VkImageView>(inputImages.size(), stencilImageView));
 
@@ -561,11 +692,10 @@ namespace vkBasalt
             {
                 std::vector<VkImageView> backBufferImageViews = pass.srgb_write_enable ? backBufferImageViewsSRGB : backBufferImageViewsUNORM;
                 std::vector<VkImageView> outputImageViews     = pass.srgb_write_enable ? outputImageViewsSRGB : outputImageViewsUNORM;
-                framebuffers.push_back(createFramebuffers(
-                    pLogicalDevice,
-                    renderPass,
-                    imageExtent,
-                    {outputToBackBuffer ? backBufferImageViews : outputImageViews, std::vector<VkImageView>(inputImages.size(), stencilImageView)}));
+                std::vector<std::vector<VkImageView>> backBufferAttachmentViews = {outputToBackBuffer ? backBufferImageViews : outputImageViews};
+                if (depthAttachmentCount)
+                    backBufferAttachmentViews.push_back(std::vector<VkImageView>(inputImages.size(), stencilImageView));
+                framebuffers.push_back(createFramebuffers(pLogicalDevice, renderPass, imageExtent, backBufferAttachmentViews));
                 outputToBackBuffer = !outputToBackBuffer;
                 switchSamplers.push_back(true);
             }
@@ -803,12 +933,15 @@ namespace vkBasalt
             colorBlendCreateInfo.blendConstants[2] = 0.0f;
             colorBlendCreateInfo.blendConstants[3] = 0.0f;
 
+            // Passes writing the back buffer get their scissor at record time, see setRegions()
+            VkDynamicState dynamicScissor = VK_DYNAMIC_STATE_SCISSOR;
+
             VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo;
             dynamicStateCreateInfo.sType             = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
             dynamicStateCreateInfo.pNext             = nullptr;
             dynamicStateCreateInfo.flags             = 0;
-            dynamicStateCreateInfo.dynamicStateCount = 0;
-            dynamicStateCreateInfo.pDynamicStates    = nullptr;
+            dynamicStateCreateInfo.dynamicStateCount = pass.render_target_names[0] == "" ? 1 : 0;
+            dynamicStateCreateInfo.pDynamicStates    = &dynamicScissor;
 
             VkPipelineDepthStencilStateCreateInfo depthStencilStateCreateInfo = {};
 
@@ -863,78 +996,147 @@ namespace vkBasalt
         Logger::debug("finished creating Reshade effect");
     }
 
-    void ReshadeEffect::updateEffect()
+    void ReshadeEffect::pruneDeadPasses()
+    {
+        // Current values of boolean toggles, so code behind a disabled toggle does not count as a read.
+        // Changing a parameter recreates the effect, which re-runs this.
+        std::unordered_map<uint32_t, bool> boolSpecConstants;
+        for (uint32_t specId = 0; specId < module.spec_constants.size(); specId++)
+        {
+            const auto& spec = module.spec_constants[specId];
+            if (spec.type.base != reshadefx::type::t_bool || spec.name.empty())
+                continue;
+            if (auto* bp = dynamic_cast<BoolParam*>(pEffectRegistry->getParameter(effectName, spec.name)))
+                boolSpecConstants[specId] = bp->value;
+        }
+
+        ReshadePassUsage usage = analyzeReshadePasses(module, boolSpecConstants);
+        liveTextures           = usage.liveTextures;
+        if (module.techniques.empty())
+            return;
+
+        auto&                             passes = module.techniques[0].passes;
+        std::vector<reshadefx::pass_info> livePasses;
+        for (size_t i = 0; i < passes.size(); i++)
+        {
+            if (usage.livePasses[i])
+                livePasses.push_back(passes[i]);
+            else
+                Logger::debug("pruning pass " + std::to_string(i) + " (" + passes[i].ps_entry_point + "), its output is never used");
+        }
+
+        if (livePasses.size() != passes.size())
+            Logger::info(effectName + ": pruned " + std::to_string(passes.size() - livePasses.size()) + " of " + std::to_string(passes.size())
+                         + " passes");
+        passes = std::move(livePasses);
+    }
+
+    void ReshadeEffect::updateEffect(uint32_t imageIndex)
     {
         if (bufferSize)
+            uniforms->update(static_cast<uint8_t*>(mappedUniformBuffer) + uniformStride * imageIndex, getFrameUniforms());
+    }
+
+    bool ReshadeEffect::usesDepth() const
+    {
+        for (auto& texture : module.textures)
         {
-            void*    data;
-            VkResult result = pLogicalDevice->vkd.MapMemory(pLogicalDevice->device, stagingBufferMemory, 0, bufferSize, 0, &data);
-            ASSERT_VULKAN(result);
-            for (auto& uniform : uniforms)
-            {
-                uniform->update(data);
-            }
-            pLogicalDevice->vkd.UnmapMemory(pLogicalDevice->device, stagingBufferMemory);
+            if (texture.semantic == "DEPTH" && liveTextures.count(texture.unique_name))
+                return true;
         }
+        return false;
     }
 
     void ReshadeEffect::useDepthImage(VkImageView depthImageView)
     {
-        std::vector<std::string> depthTextureNames;
+        if (depthImageView == this->depthImageView)
+            return;
+        this->depthImageView = depthImageView;
 
-        for (auto& texture : module.textures)
+        // Pushed descriptors pick up the new view when the command buffers are written again
+        if (pushInputSamplers)
+            return;
+
+        std::vector<VkDescriptorImageInfo> imageInfos;
+        std::vector<VkWriteDescriptorSet>  writeDescriptorSets;
+        for (uint32_t k = 0; k < inputDescriptorSets.size(); k++)
         {
-            if (texture.semantic == "DEPTH")
+            uint32_t imageIndex = k % inputImages.size();
+            for (auto& inputSampler : inputSamplers)
             {
-                depthTextureNames.push_back(texture.unique_name);
+                if (!inputSampler.depth)
+                    continue;
+
+                VkDescriptorImageInfo imageInfo;
+                imageInfo.sampler     = samplers[inputSampler.binding];
+                imageInfo.imageView   = getInputSamplerView(inputSampler, imageIndex, k / inputImages.size());
+                imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+                imageInfos.push_back(imageInfo);
+
+                writeDescriptorSets.push_back(imageSamplerWrite(inputDescriptorSets[k], inputSampler.binding));
             }
         }
+        for (size_t i = 0; i < writeDescriptorSets.size(); i++)
+            writeDescriptorSets[i].pImageInfo = &imageInfos[i];
 
-        for (size_t i = 0; i < module.samplers.size(); i++)
+        if (!writeDescriptorSets.empty())
+            pLogicalDevice->vkd.UpdateDescriptorSets(pLogicalDevice->device, writeDescriptorSets.size(), writeDescriptorSets.data(), 0, nullptr);
+    }
+
+    bool ReshadeEffect::setRegions(const EffectRegions& regions)
+    {
+        this->regions = regions;
+        return true;
+    }
+
+    VkImageView ReshadeEffect::getInputSamplerView(const InputSampler& inputSampler, uint32_t imageIndex, uint32_t variant) const
+    {
+        // Use a input image if there is no depth image to prevent a crash
+        if (inputSampler.depth)
+            return depthImageView ? depthImageView : inputImageViewsUNORM[imageIndex];
+
+        switch (variant)
         {
-            reshadefx::sampler_info info = module.samplers[i];
-            for (auto& name : depthTextureNames)
-            {
-                if (info.texture_name == name)
-                {
-                    for (uint32_t j = 0; j < inputImages.size(); j++)
-                    {
-                        VkDescriptorImageInfo imageInfo;
-                        imageInfo.sampler = samplers[i];
-                        // Use a input image if there is no depth image to prevent a crash
-                        imageInfo.imageView   = depthImageView ? depthImageView : inputImageViewsUNORM[j];
-                        imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-
-                        VkWriteDescriptorSet writeDescriptorSet = {};
-
-                        writeDescriptorSet.sType            = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-                        writeDescriptorSet.pNext            = nullptr;
-                        writeDescriptorSet.dstSet           = inputDescriptorSets[j];
-                        writeDescriptorSet.dstBinding       = i;
-                        writeDescriptorSet.dstArrayElement  = 0;
-                        writeDescriptorSet.descriptorCount  = 1;
-                        writeDescriptorSet.descriptorType   = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-                        writeDescriptorSet.pImageInfo       = &imageInfo;
-                        writeDescriptorSet.pBufferInfo      = nullptr;
-                        writeDescriptorSet.pTexelBufferView = nullptr;
-
-                        pLogicalDevice->vkd.UpdateDescriptorSets(pLogicalDevice->device, 1, &writeDescriptorSet, 0, nullptr);
-                        if (outputWrites > 1)
-                        {
-                            writeDescriptorSet.dstSet = backBufferDescriptorSets[j];
-                            pLogicalDevice->vkd.UpdateDescriptorSets(pLogicalDevice->device, 1, &writeDescriptorSet, 0, nullptr);
-                        }
-                        if (outputWrites > 2)
-                        {
-                            writeDescriptorSet.dstSet = outputDescriptorSets[j];
-                            pLogicalDevice->vkd.UpdateDescriptorSets(pLogicalDevice->device, 1, &writeDescriptorSet, 0, nullptr);
-                        }
-                    }
-                    break;
-                }
-            }
+            case 1: return inputSampler.srgb ? backBufferImageViewsSRGB[imageIndex] : backBufferImageViewsUNORM[imageIndex];
+            case 2: return inputSampler.srgb ? outputImageViewsSRGB[imageIndex] : outputImageViewsUNORM[imageIndex];
+            default: return inputSampler.srgb ? inputImageViewsSRGB[imageIndex] : inputImageViewsUNORM[imageIndex];
         }
     }
+
+    // variant 0 reads the input images, 1 the back buffer and 2 the output images
+    void ReshadeEffect::bindInputSamplers(VkCommandBuffer commandBuffer, uint32_t imageIndex, uint32_t variant)
+    {
+        if (inputSamplers.empty())
+            return;
+
+        if (!pushInputSamplers)
+        {
+            pLogicalDevice->vkd.CmdBindDescriptorSets(commandBuffer,
+                                                      VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                                      pipelineLayout,
+                                                      2,
+                                                      1,
+                                                      &(inputDescriptorSets[variant * inputImages.size() + imageIndex]),
+                                                      0,
+                                                      nullptr);
+            return;
+        }
+
+        std::vector<VkDescriptorImageInfo> imageInfos(inputSamplers.size());
+        std::vector<VkWriteDescriptorSet>  writeDescriptorSets(inputSamplers.size());
+        for (size_t i = 0; i < inputSamplers.size(); i++)
+        {
+            imageInfos[i].sampler     = samplers[inputSamplers[i].binding];
+            imageInfos[i].imageView   = getInputSamplerView(inputSamplers[i], imageIndex, variant);
+            imageInfos[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+            writeDescriptorSets[i]            = imageSamplerWrite(VK_NULL_HANDLE, inputSamplers[i].binding);
+            writeDescriptorSets[i].pImageInfo = &imageInfos[i];
+        }
+        pLogicalDevice->vkd.CmdPushDescriptorSetKHR(
+            commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 2, writeDescriptorSets.size(), writeDescriptorSets.data());
+    }
+
     void ReshadeEffect::applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer)
     {
         Logger::debug("applying ReshadeEffect to command buffer" + convertToString(commandBuffer));
@@ -976,16 +1178,35 @@ namespace vkBasalt
 
         pLogicalDevice->vkd.CmdPipelineBarrier(
             commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &memoryBarrier);
-        memoryBarrier.image     = outputImages[imageIndex];
-        memoryBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        memoryBarrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        pLogicalDevice->vkd.CmdPipelineBarrier(
-            commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &memoryBarrier);
-        if (outputWrites > 1)
+        if (regions.isActive())
         {
-            memoryBarrier.image = backBufferImages[imageIndex];
+            // The back buffer passes only render inside, output and back buffer start out as the input everywhere else
+            std::vector<VkImage> regionOutputs = {outputImages[imageIndex]};
+            if (outputWrites > 1)
+                regionOutputs.push_back(backBufferImages[imageIndex]);
+            copyOutsideRegions(pLogicalDevice,
+                               commandBuffer,
+                               regions,
+                               inputImages[imageIndex],
+                               VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                               regionOutputs,
+                               VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        }
+        else
+        {
+            memoryBarrier.image     = outputImages[imageIndex];
+            memoryBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            memoryBarrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            pLogicalDevice->vkd.CmdPipelineBarrier(
+                commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &memoryBarrier);
+        }
+        if (outputWrites > 1 && !regions.isActive())
+        {
+            // The back buffer is shared with the other effects of the chain, the previous one wrote and sampled it
+            memoryBarrier.image         = backBufferImages[imageIndex];
+            memoryBarrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
             pLogicalDevice->vkd.CmdPipelineBarrier(commandBuffer,
-                                                   VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                                                   VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
                                                    VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
                                                    0,
                                                    0,
@@ -996,35 +1217,43 @@ namespace vkBasalt
                                                    &memoryBarrier);
         }
 
-        // stencil image
-        memoryBarrier.image                       = stencilImage;
-        memoryBarrier.srcAccessMask               = 0;
-        memoryBarrier.dstAccessMask               = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-        memoryBarrier.oldLayout                   = VK_IMAGE_LAYOUT_UNDEFINED;
-        memoryBarrier.newLayout                   = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-        memoryBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_STENCIL_BIT | VK_IMAGE_ASPECT_DEPTH_BIT;
+        // stencil image, the first pass that uses it clears it. It's shared with the other effects of the chain,
+        // so the previous effect's stencil writes have to finish first
+        if (stencilImage != VK_NULL_HANDLE)
+        {
+            memoryBarrier.image                       = stencilImage;
+            memoryBarrier.srcAccessMask               = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+            memoryBarrier.dstAccessMask               = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+            memoryBarrier.oldLayout                   = VK_IMAGE_LAYOUT_UNDEFINED;
+            memoryBarrier.newLayout                   = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+            memoryBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_STENCIL_BIT | VK_IMAGE_ASPECT_DEPTH_BIT;
 
-        pLogicalDevice->vkd.CmdPipelineBarrier(commandBuffer,
-                                               VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
-                                               VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
-                                               0,
-                                               0,
-                                               nullptr,
-                                               0,
-                                               nullptr,
-                                               1,
-                                               &memoryBarrier);
+            pLogicalDevice->vkd.CmdPipelineBarrier(commandBuffer,
+                                                   VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                                                   VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                                                   0,
+                                                   0,
+                                                   nullptr,
+                                                   0,
+                                                   nullptr,
+                                                   1,
+                                                   &memoryBarrier);
+        }
 
         Logger::debug("after the first pipeline barrier");
 
-        pLogicalDevice->vkd.CmdBindDescriptorSets(
-            commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 1, 1, &(inputDescriptorSets[imageIndex]), 0, nullptr);
+        if (textureDescriptorSet != VK_NULL_HANDLE)
+        {
+            pLogicalDevice->vkd.CmdBindDescriptorSets(
+                commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 1, 1, &textureDescriptorSet, 0, nullptr);
+        }
+        bindInputSamplers(commandBuffer, imageIndex, 0);
         Logger::debug("after binding image sampler");
 
         if (bufferSize)
         {
             pLogicalDevice->vkd.CmdBindDescriptorSets(
-                commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &bufferDescriptorSet, 0, nullptr);
+                commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &bufferDescriptorSets[imageIndex], 0, nullptr);
             Logger::debug("after binding uniform buffer");
         }
 
@@ -1033,14 +1262,34 @@ namespace vkBasalt
         {
             renderPassBeginInfos[i].framebuffer = framebuffers[i][imageIndex];
 
+            // switchSamplers marks the passes writing the back buffer, only those are limited to the regions
+            VkRenderPassBeginInfo renderPassBeginInfo = renderPassBeginInfos[i];
+            bool                  limitToRegions      = switchSamplers[i] && regions.isActive();
+            if (limitToRegions)
+                renderPassBeginInfo.renderArea = regions.bounds;
+
             Logger::debug("before beginn renderpass");
-            pLogicalDevice->vkd.CmdBeginRenderPass(commandBuffer, &renderPassBeginInfos[i], VK_SUBPASS_CONTENTS_INLINE);
+            pLogicalDevice->vkd.CmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
             Logger::debug("after beginn renderpass");
 
             pLogicalDevice->vkd.CmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipelines[i]);
             Logger::debug("after bind pipeliene");
 
-            pLogicalDevice->vkd.CmdDraw(commandBuffer, module.techniques[0].passes[i].num_vertices, 1, 0, 0);
+            uint32_t vertexCount = module.techniques[0].passes[i].num_vertices;
+            if (limitToRegions)
+            {
+                for (const auto& rect : regions.inside)
+                {
+                    pLogicalDevice->vkd.CmdSetScissor(commandBuffer, 0, 1, &rect);
+                    pLogicalDevice->vkd.CmdDraw(commandBuffer, vertexCount, 1, 0, 0);
+                }
+            }
+            else
+            {
+                if (switchSamplers[i])
+                    pLogicalDevice->vkd.CmdSetScissor(commandBuffer, 0, 1, &renderPassBeginInfo.renderArea);
+                pLogicalDevice->vkd.CmdDraw(commandBuffer, vertexCount, 1, 0, 0);
+            }
             Logger::debug("after draw");
 
             pLogicalDevice->vkd.CmdEndRenderPass(commandBuffer);
@@ -1050,13 +1299,11 @@ namespace vkBasalt
             {
                 if (backBufferNext)
                 {
-                    pLogicalDevice->vkd.CmdBindDescriptorSets(
-                        commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 1, 1, &(backBufferDescriptorSets[imageIndex]), 0, nullptr);
+                    bindInputSamplers(commandBuffer, imageIndex, 1);
                 }
                 else if (outputWrites > 2)
                 {
-                    pLogicalDevice->vkd.CmdBindDescriptorSets(
-                        commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 1, 1, &(outputDescriptorSets[imageIndex]), 0, nullptr);
+                    bindInputSamplers(commandBuffer, imageIndex, 2);
                 }
                 backBufferNext = !backBufferNext;
             }
@@ -1244,7 +1491,8 @@ namespace vkBasalt
 
         if (bufferSize)
         {
-            pLogicalDevice->vkd.FreeMemory(pLogicalDevice->device, stagingBufferMemory, nullptr);
+            pLogicalDevice->vkd.UnmapMemory(pLogicalDevice->device, stagingBufferMemory);
+            freeMemory(pLogicalDevice, stagingBufferMemory);
             pLogicalDevice->vkd.DestroyBuffer(pLogicalDevice->device, stagingBuffer, nullptr);
         }
 
@@ -1254,7 +1502,8 @@ namespace vkBasalt
             pLogicalDevice->vkd.DestroyRenderPass(pLogicalDevice->device, renderPass, nullptr);
         }
 
-        pLogicalDevice->vkd.DestroyDescriptorSetLayout(pLogicalDevice->device, imageSamplerDescriptorSetLayout, nullptr);
+        pLogicalDevice->vkd.DestroyDescriptorSetLayout(pLogicalDevice->device, textureDescriptorSetLayout, nullptr);
+        pLogicalDevice->vkd.DestroyDescriptorSetLayout(pLogicalDevice->device, inputDescriptorSetLayout, nullptr);
         pLogicalDevice->vkd.DestroyDescriptorSetLayout(pLogicalDevice->device, uniformDescriptorSetLayout, nullptr);
 
         pLogicalDevice->vkd.DestroyShaderModule(pLogicalDevice->device, shaderModule, nullptr);
@@ -1269,15 +1518,6 @@ namespace vkBasalt
             pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, imageView, nullptr);
         }
 
-        for (auto& imageView : backBufferImageViewsSRGB)
-        {
-            pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, imageView, nullptr);
-        }
-        for (auto& imageView : backBufferImageViewsUNORM)
-        {
-            pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, imageView, nullptr);
-        }
-
         for (auto& fbs : framebuffers)
         {
             for (auto& fb : fbs)
@@ -1322,7 +1562,6 @@ namespace vkBasalt
         {
             pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, imageView, nullptr);
         }
-        pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, stencilImageView, nullptr);
 
         for (auto& it : textureImages)
         {
@@ -1332,13 +1571,6 @@ namespace vkBasalt
             }
         }
 
-        for (auto& image : backBufferImages)
-        {
-            pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, image, nullptr);
-        }
-
-        pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, stencilImage, nullptr);
-
         for (auto& sampler : samplers)
         {
             pLogicalDevice->vkd.DestroySampler(pLogicalDevice->device, sampler, nullptr);
@@ -1346,7 +1578,7 @@ namespace vkBasalt
 
         for (auto& memory : textureMemory)
         {
-            pLogicalDevice->vkd.FreeMemory(pLogicalDevice->device, memory, nullptr);
+            freeMemory(pLogicalDevice, memory);
         }
     }
 
@@ -1367,6 +1599,16 @@ namespace vkBasalt
         preprocessor.add_macro_definition("BUFFER_RCP_HEIGHT", "(1.0 / BUFFER_HEIGHT)");
         preprocessor.add_macro_definition("BUFFER_COLOR_DEPTH", (inputOutputFormatUNORM == VK_FORMAT_A2R10G10B10_UNORM_PACK32) ? "10" : "8");
 
+        // With the linear depth prepass the depth texture is already linear, this turns
+        // GetLinearizedDepth() of ReShade.fxh into a plain read. Added first so custom macros can't override it.
+        if (settingsManager.getLinearDepthPrepass())
+        {
+            preprocessor.add_macro_definition("RESHADE_DEPTH_INPUT_IS_REVERSED", "0");
+            preprocessor.add_macro_definition("RESHADE_DEPTH_INPUT_IS_LOGARITHMIC", "0");
+            preprocessor.add_macro_definition("RESHADE_DEPTH_MULTIPLIER", "1");
+            preprocessor.add_macro_definition("RESHADE_DEPTH_LINEARIZATION_FAR_PLANE", "1.0");
+        }
+
         // Add custom preprocessor definitions (user-configurable macros)
         for (const auto& def : customPreprocessorDefs)
         {
@@ -1421,15 +1663,33 @@ namespace vkBasalt
 
         std::unique_ptr<reshadefx::codegen> codegen(reshadefx::create_codegen_spirv(
             true /* vulkan semantics */, true /* debug info */, true /* uniforms to spec constants */, true /*flip vertex shader*/));
-        parser.parse(std::move(preprocessor.output()), codegen.get());
+        bool parsed = parser.parse(std::move(preprocessor.output()), codegen.get());
 
         errors = parser.errors();
         if (errors != "")
         {
             Logger::err(errors);
         }
+        if (!parsed)
+            throw std::runtime_error(errors.empty() ? "failed to compile " + shaderPath : errors);
         codegen->write_result(module);
 
+        // The codegen puts every sampler into set 1, the ones reading COLOR or DEPTH move to set 2
+        inputSamplers.clear();
+        std::set<uint32_t> inputSamplerIds;
+        for (const auto& sampler : module.samplers)
+        {
+            auto texture = std::find_if(module.textures.begin(), module.textures.end(), [&sampler](const auto& t) {
+                return t.unique_name == sampler.texture_name;
+            });
+            if (texture == module.textures.end() || (texture->semantic != "COLOR" && texture->semantic != "DEPTH"))
+                continue;
+
+            inputSamplers.push_back({sampler.binding, texture->semantic == "DEPTH", sampler.srgb != 0});
+            inputSamplerIds.insert(sampler.id);
+        }
+        setDescriptorSet(module.spirv, inputSamplerIds, 2);
+
         VkShaderModuleCreateInfo shaderCreateInfo;
         shaderCreateInfo.sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
         shaderCreateInfo.pNext    = nullptr;
@@ -6,6 +6,7 @@
 #include <iostream>
 #include <vector>
 #include <unordered_map>
+#include <set>
 #include <memory>
 
 #include "vulkan_include.hpp"
@@ -17,6 +18,7 @@
 #include "reshade_uniforms.hpp"
 
 #include "logical_device.hpp"
+#include "scratch_images.hpp"
 
 #include "reshade/effect_parser.hpp"
 #include "reshade/effect_codegen.hpp"
@@ -32,13 +34,16 @@ namespace vkBasalt
                       VkExtent2D           imageExtent,
                       std::vector<VkImage> inputImages,
                       std::vector<VkImage> outputImages,
+                      ScratchImages*       pScratchImages,
                       EffectRegistry*      pEffectRegistry,
                       std::string          effectName,
                       std::string          effectPath = "",  // Optional: explicit path to .fx file
                       std::vector<PreprocessorDefinition> customDefs = {});  // Custom preprocessor definitions
         void virtual applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer) override;
-        void virtual updateEffect() override;
+        void virtual updateEffect(uint32_t imageIndex) override;
         void virtual useDepthImage(VkImageView depthImageView) override;
+        bool virtual setRegions(const EffectRegions& regions) override;
+        bool virtual usesDepth() const override;
         std::vector<std::unique_ptr<EffectParam>> getParameters() const override;
         virtual ~ReshadeEffect();
 
@@ -62,14 +67,27 @@ namespace vkBasalt
         std::unordered_map<std::string, uint32_t>   textureMipLevels;
         std::unordered_map<std::string, VkExtent3D> textureExtents;
 
-        std::vector<VkDescriptorSet> inputDescriptorSets;
-        std::vector<VkDescriptorSet> outputDescriptorSets;
-        std::vector<VkDescriptorSet> backBufferDescriptorSets;
+        // A sampler reading COLOR or DEPTH, its view depends on the image, the back buffer flips and the depth image
+        struct InputSampler
+        {
+            uint32_t binding;
+            bool     depth;
+            bool     srgb;
+        };
+
+        // Set 1 holds the textures and render targets and is the same for every image,
+        // set 2 holds the input samplers and is pushed when VK_KHR_push_descriptor is there
+        std::vector<InputSampler>    inputSamplers;
+        bool                         pushInputSamplers    = false;
+        VkDescriptorSet              textureDescriptorSet = VK_NULL_HANDLE;
+        std::vector<VkDescriptorSet> inputDescriptorSets;  // without push descriptors: input, back buffer, output sets per image
+        VkImageView                  depthImageView = VK_NULL_HANDLE;
 
         std::vector<std::vector<VkFramebuffer>> framebuffers;
 
         VkDescriptorSetLayout                 uniformDescriptorSetLayout;
-        VkDescriptorSetLayout                 imageSamplerDescriptorSetLayout;
+        VkDescriptorSetLayout                 textureDescriptorSetLayout;
+        VkDescriptorSetLayout                 inputDescriptorSetLayout;
         VkShaderModule                        shaderModule;
         VkDescriptorPool                      descriptorPool;
         std::vector<VkRenderPass>             renderPasses;
@@ -89,9 +107,11 @@ namespace vkBasalt
 
         VkFormat    inputOutputFormatUNORM;
         VkFormat    inputOutputFormatSRGB;
-        VkFormat    stencilFormat;
-        VkImage     stencilImage;
-        VkImageView stencilImageView;
+        // stencil and back buffers belong to the swapchain and are shared with the other effects
+        ScratchImages* pScratchImages;
+        VkFormat       stencilFormat;
+        VkImage        stencilImage     = VK_NULL_HANDLE;  // only if a pass enables the stencil
+        VkImageView    stencilImageView = VK_NULL_HANDLE;
         // how often the shader writes to the reshade back buffer
         // we need to flip the "backbuffer" after each write if there is a next one
         int                      outputWrites = 0;
@@ -101,11 +121,21 @@ namespace vkBasalt
         VkBuffer                 stagingBuffer;
         VkDeviceMemory           stagingBufferMemory;
         uint32_t                 bufferSize;
-        VkDescriptorSet          bufferDescriptorSet;
+        VkDeviceSize             uniformStride = 0;  // bufferSize rounded up to the offset alignment, one slot per image
+        std::vector<VkDescriptorSet> bufferDescriptorSets;
+        void*                    mappedUniformBuffer = nullptr;
+
+        std::unique_ptr<ReshadeUniforms> uniforms;
+
+        EffectRegions regions;
 
-        std::vector<std::shared_ptr<ReshadeUniform>> uniforms;
+        // Textures that survive dead pass elimination, the rest are never allocated
+        std::set<std::string> liveTextures;
 
         void          createReshadeModule();
+        void          pruneDeadPasses();
+        VkImageView   getInputSamplerView(const InputSampler& inputSampler, uint32_t imageIndex, uint32_t variant) const;
+        void          bindInputSamplers(VkCommandBuffer commandBuffer, uint32_t imageIndex, uint32_t variant);
         VkFormat      convertReshadeFormat(reshadefx::texture_format texFormat);
         VkCompareOp   convertReshadeCompareOp(reshadefx::pass_stencil_func compareOp);
         VkStencilOp   convertReshadeStencilOp(reshadefx::pass_stencil_op stencilOp);
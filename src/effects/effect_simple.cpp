@@ -11,12 +11,18 @@
 #include "shader.hpp"
 #include "sampler.hpp"
 #include "util.hpp"
+#include "settings_manager.hpp"
+#include "effect_regions.hpp"
 
 namespace vkBasalt
 {
     SimpleEffect::SimpleEffect()
     {
     }
+    bool SimpleEffect::useHalfPrecision(LogicalDevice* pLogicalDevice)
+    {
+        return pLogicalDevice->supportsFloat16 && settingsManager.getHalfPrecisionShaders();
+    }
     void SimpleEffect::init(LogicalDevice*       pLogicalDevice,
                             VkFormat             format,
                             VkExtent2D           imageExtent,
@@ -69,16 +75,38 @@ namespace vkBasalt
                                                   "main",
                                                   imageExtent,
                                                   renderPass,
-                                                  pipelineLayout);
+                                                  pipelineLayout,
+                                                  false,
+                                                  nullptr,
+                                                  true);
 
         imageDescriptorSets = allocateAndWriteImageSamplerDescriptorSets(
             pLogicalDevice, descriptorPool, imageSamplerDescriptorSetLayout, {sampler}, std::vector<std::vector<VkImageView>>(1, inputImageViews));
 
         framebuffers = createFramebuffers(pLogicalDevice, renderPass, imageExtent, {outputImageViews});
     }
+    bool SimpleEffect::setRegions(const EffectRegions& regions)
+    {
+        this->regions = regions;
+        // Compatible with renderPass, so the framebuffers and the pipeline work with both
+        if (regions.isActive() && regionRenderPass == VK_NULL_HANDLE)
+            regionRenderPass = createRenderPass(pLogicalDevice, format, true);
+        return true;
+    }
     void SimpleEffect::applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer)
     {
         Logger::debug("applying SimpleEffect to cb " + convertToString(commandBuffer));
+        if (regions.isActive())
+        {
+            copyOutsideRegions(pLogicalDevice,
+                               commandBuffer,
+                               regions,
+                               inputImages[imageIndex],
+                               VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+                               {outputImages[imageIndex]},
+                               VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+        }
+
         // Used to make the Image accessable by the shader
         VkImageMemoryBarrier memoryBarrier;
         memoryBarrier.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -122,10 +150,12 @@ namespace vkBasalt
         VkRenderPassBeginInfo renderPassBeginInfo;
         renderPassBeginInfo.sType             = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
         renderPassBeginInfo.pNext             = nullptr;
-        renderPassBeginInfo.renderPass        = renderPass;
+        renderPassBeginInfo.renderPass        = regions.isActive() ? regionRenderPass : renderPass;
         renderPassBeginInfo.framebuffer       = framebuffers[imageIndex];
         renderPassBeginInfo.renderArea.offset = {0, 0};
         renderPassBeginInfo.renderArea.extent = imageExtent;
+        if (regions.isActive())
+            renderPassBeginInfo.renderArea = regions.bounds;
         VkClearValue clearValue               = {0.0f, 0.0f, 0.0f, 1.0f};
         renderPassBeginInfo.clearValueCount   = 1;
         renderPassBeginInfo.pClearValues      = &clearValue;
@@ -141,7 +171,20 @@ namespace vkBasalt
         pLogicalDevice->vkd.CmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
         Logger::debug("after bind pipeliene");
 
-        pLogicalDevice->vkd.CmdDraw(commandBuffer, 3, 1, 0, 0);
+        if (regions.isActive())
+        {
+            for (const auto& rect : regions.inside)
+            {
+                pLogicalDevice->vkd.CmdSetScissor(commandBuffer, 0, 1, &rect);
+                pLogicalDevice->vkd.CmdDraw(commandBuffer, 3, 1, 0, 0);
+            }
+        }
+        else
+        {
+            VkRect2D scissor = {{0, 0}, imageExtent};
+            pLogicalDevice->vkd.CmdSetScissor(commandBuffer, 0, 1, &scissor);
+            pLogicalDevice->vkd.CmdDraw(commandBuffer, 3, 1, 0, 0);
+        }
         Logger::debug("after draw");
 
         pLogicalDevice->vkd.CmdEndRenderPass(commandBuffer);
@@ -170,6 +213,7 @@ namespace vkBasalt
         pLogicalDevice->vkd.DestroyPipeline(pLogicalDevice->device, graphicsPipeline, nullptr);
         pLogicalDevice->vkd.DestroyPipelineLayout(pLogicalDevice->device, pipelineLayout, nullptr);
         pLogicalDevice->vkd.DestroyRenderPass(pLogicalDevice->device, renderPass, nullptr);
+        pLogicalDevice->vkd.DestroyRenderPass(pLogicalDevice->device, regionRenderPass, nullptr);
         pLogicalDevice->vkd.DestroyDescriptorSetLayout(pLogicalDevice->device, imageSamplerDescriptorSetLayout, nullptr);
         pLogicalDevice->vkd.DestroyShaderModule(pLogicalDevice->device, vertexModule, nullptr);
         pLogicalDevice->vkd.DestroyShaderModule(pLogicalDevice->device, fragmentModule, nullptr);
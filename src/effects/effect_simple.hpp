@@ -22,6 +22,7 @@ namespace vkBasalt
     public:
         SimpleEffect();
         void virtual applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer) override;
+        bool virtual setRegions(const EffectRegions& regions) override;
         virtual ~SimpleEffect();
 
     protected:
@@ -37,6 +38,8 @@ namespace vkBasalt
         VkShaderModule               vertexModule = VK_NULL_HANDLE;
         VkShaderModule               fragmentModule = VK_NULL_HANDLE;
         VkRenderPass                 renderPass = VK_NULL_HANDLE;
+        VkRenderPass                 regionRenderPass = VK_NULL_HANDLE;  // loads the pixels copied from outside the regions
+        EffectRegions                regions;
         VkPipelineLayout             pipelineLayout = VK_NULL_HANDLE;
         VkPipeline                   graphicsPipeline = VK_NULL_HANDLE;
         VkExtent2D                   imageExtent = {};
@@ -51,6 +54,9 @@ namespace vkBasalt
         // subclasses can put DescriptorSets in here, but the first one will be the input image descriptorSet
         std::vector<VkDescriptorSetLayout> descriptorSetLayouts;
 
+        // Whether to pick the FP16 variant of a shader (device support and user setting)
+        static bool useHalfPrecision(LogicalDevice* pLogicalDevice);
+
         void init(LogicalDevice*       pLogicalDevice,
                   VkFormat             format,
                   VkExtent2D           imageExtent,
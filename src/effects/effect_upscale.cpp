@@ -0,0 +1,128 @@
+#include "effect_upscale.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "effect_simple.hpp"
+#include "image.hpp"
+#include "memory.hpp"
+#include "util.hpp"
+
+#include "shader_sources.hpp"
+
+namespace vkBasalt
+{
+    namespace
+    {
+        // The input size is read from the texture in the shader, only the output size is baked in
+        class EasuEffect : public SimpleEffect
+        {
+        public:
+            EasuEffect(LogicalDevice*       pLogicalDevice,
+                       VkFormat             format,
+                       VkExtent2D           outputExtent,
+                       std::vector<VkImage> inputImages,
+                       std::vector<VkImage> outputImages,
+                       Config*              pConfig)
+            {
+                float outputSize[2] = {(float) outputExtent.width, (float) outputExtent.height};
+
+                vertexCode   = full_screen_triangle_vert;
+                fragmentCode = fsr_easu_frag;
+
+                VkSpecializationMapEntry sizeMapEntries[2];
+                for (uint32_t i = 0; i < 2; i++)
+                {
+                    sizeMapEntries[i].constantID = i;
+                    sizeMapEntries[i].offset     = sizeof(float) * i;
+                    sizeMapEntries[i].size       = sizeof(float);
+                }
+
+                VkSpecializationInfo fragmentSpecializationInfo;
+                fragmentSpecializationInfo.mapEntryCount = 2;
+                fragmentSpecializationInfo.pMapEntries   = sizeMapEntries;
+                fragmentSpecializationInfo.dataSize      = sizeof(outputSize);
+                fragmentSpecializationInfo.pData         = outputSize;
+
+                pVertexSpecInfo   = nullptr;
+                pFragmentSpecInfo = &fragmentSpecializationInfo;
+
+                init(pLogicalDevice, format, outputExtent, inputImages, outputImages, pConfig);
+            }
+        };
+
+        class RcasEffect : public SimpleEffect
+        {
+        public:
+            RcasEffect(LogicalDevice*       pLogicalDevice,
+                       VkFormat             format,
+                       VkExtent2D           imageExtent,
+                       std::vector<VkImage> inputImages,
+                       std::vector<VkImage> outputImages,
+                       Config*              pConfig)
+            {
+                // in stops like FSR, 0 is the strongest sharpening and every stop halves it
+                float sharpness = std::exp2(-std::max(pConfig->getOption<float>("upscaleSharpness", 0.2f), 0.0f));
+
+                vertexCode   = full_screen_triangle_vert;
+                fragmentCode = fsr_rcas_frag;
+
+                VkSpecializationMapEntry sharpnessMapEntry;
+                sharpnessMapEntry.constantID = 0;
+                sharpnessMapEntry.offset     = 0;
+                sharpnessMapEntry.size       = sizeof(float);
+
+                VkSpecializationInfo fragmentSpecializationInfo;
+                fragmentSpecializationInfo.mapEntryCount = 1;
+                fragmentSpecializationInfo.pMapEntries   = &sharpnessMapEntry;
+                fragmentSpecializationInfo.dataSize      = sizeof(float);
+                fragmentSpecializationInfo.pData         = &sharpness;
+
+                pVertexSpecInfo   = nullptr;
+                pFragmentSpecInfo = &fragmentSpecializationInfo;
+
+                init(pLogicalDevice, format, imageExtent, inputImages, outputImages, pConfig);
+            }
+        };
+    } // namespace
+
+    UpscaleEffect::UpscaleEffect(LogicalDevice*       pLogicalDevice,
+                                 VkFormat             format,
+                                 VkExtent2D           outputExtent,
+                                 std::vector<VkImage> inputImages,
+                                 std::vector<VkImage> outputImages,
+                                 Config*              pConfig)
+    {
+        this->pLogicalDevice = pLogicalDevice;
+
+        upscaledImages = createImages(pLogicalDevice,
+                                      inputImages.size(),
+                                      {outputExtent.width, outputExtent.height, 1},
+                                      format,
+                                      VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+                                      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                      upscaledMemory);
+        Logger::debug("created upscaled images");
+
+        easu = std::make_unique<EasuEffect>(pLogicalDevice, format, outputExtent, inputImages, upscaledImages, pConfig);
+        rcas = std::make_unique<RcasEffect>(pLogicalDevice, format, outputExtent, upscaledImages, outputImages, pConfig);
+    }
+
+    void UpscaleEffect::applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer)
+    {
+        Logger::debug("applying UpscaleEffect to cb " + convertToString(commandBuffer));
+        easu->applyEffect(imageIndex, commandBuffer);
+        rcas->applyEffect(imageIndex, commandBuffer);
+    }
+
+    UpscaleEffect::~UpscaleEffect()
+    {
+        Logger::debug("destroying UpscaleEffect " + convertToString(this));
+
+        easu.reset();
+        rcas.reset();
+        for (auto& image : upscaledImages)
+            pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, image, nullptr);
+        freeMemory(pLogicalDevice, upscaledMemory);
+    }
+} // namespace vkBasalt
@@ -0,0 +1,42 @@
+#ifndef EFFECT_UPSCALE_HPP_INCLUDED
+#define EFFECT_UPSCALE_HPP_INCLUDED
+#include <vector>
+#include <fstream>
+#include <string>
+#include <iostream>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+
+#include "vulkan_include.hpp"
+
+#include "effect.hpp"
+#include "config.hpp"
+
+#include "logical_device.hpp"
+
+namespace vkBasalt
+{
+    // Upscales the application's images to the swapchain like FSR 1:
+    // EASU from inputExtent into an intermediate image at outputExtent, then RCAS into the output image
+    class UpscaleEffect : public Effect
+    {
+    public:
+        UpscaleEffect(LogicalDevice*       pLogicalDevice,
+                      VkFormat             format,
+                      VkExtent2D           outputExtent,
+                      std::vector<VkImage> inputImages,
+                      std::vector<VkImage> outputImages,
+                      Config*              pConfig);
+        void virtual applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer) override;
+        virtual ~UpscaleEffect();
+
+    private:
+        LogicalDevice*          pLogicalDevice;
+        std::vector<VkImage>    upscaledImages;
+        VkDeviceMemory          upscaledMemory = VK_NULL_HANDLE;
+        std::unique_ptr<Effect> easu;
+        std::unique_ptr<Effect> rcas;
+    };
+} // namespace vkBasalt
+#endif // EFFECT_UPSCALE_HPP_INCLUDED
@@ -31,6 +31,7 @@ namespace vkBasalt
         std::string label;       // Display label (from ui_label or name)
         std::string tooltip;     // ui_tooltip - hover description
         std::string uiType;      // ui_type - "slider", "drag", "combo", etc.
+        std::string category;    // ui_category - parameters are grouped under it, empty for none
 
         virtual ParamType getType() const = 0;
         virtual const char* getTypeName() const = 0;
@@ -70,6 +71,7 @@ namespace vkBasalt
             p->label = label;
             p->tooltip = tooltip;
             p->uiType = uiType;
+            p->category = category;
             p->value = value;
             p->defaultValue = defaultValue;
             p->minValue = minValue;
@@ -130,6 +132,7 @@ namespace vkBasalt
             p->label = label;
             p->tooltip = tooltip;
             p->uiType = uiType;
+            p->category = category;
             p->componentCount = componentCount;
             for (uint32_t i = 0; i < 4; i++)
             {
@@ -174,6 +177,7 @@ namespace vkBasalt
             p->label = label;
             p->tooltip = tooltip;
             p->uiType = uiType;
+            p->category = category;
             p->value = value;
             p->defaultValue = defaultValue;
             p->minValue = minValue;
@@ -235,6 +239,7 @@ namespace vkBasalt
             p->label = label;
             p->tooltip = tooltip;
             p->uiType = uiType;
+            p->category = category;
             p->componentCount = componentCount;
             for (uint32_t i = 0; i < 4; i++)
             {
@@ -278,6 +283,7 @@ namespace vkBasalt
             p->label = label;
             p->tooltip = tooltip;
             p->uiType = uiType;
+            p->category = category;
             p->value = value;
             p->defaultValue = defaultValue;
             p->minValue = minValue;
@@ -338,6 +344,7 @@ namespace vkBasalt
             p->label = label;
             p->tooltip = tooltip;
             p->uiType = uiType;
+            p->category = category;
             p->componentCount = componentCount;
             for (uint32_t i = 0; i < 4; i++)
             {
@@ -378,6 +385,7 @@ namespace vkBasalt
             p->label = label;
             p->tooltip = tooltip;
             p->uiType = uiType;
+            p->category = category;
             p->value = value;
             p->defaultValue = defaultValue;
             return p;
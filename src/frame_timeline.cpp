@@ -0,0 +1,141 @@
+#include "frame_timeline.hpp"
+
+#include "logical_device.hpp"
+#include "logger.hpp"
+
+namespace vkBasalt
+{
+    FrameTimeline::FrameTimeline(LogicalDevice* pLogicalDevice) : pLogicalDevice(pLogicalDevice)
+    {
+        if (!pLogicalDevice->supportsTimelineSemaphore)
+        {
+            Logger::debug("no timeline semaphores, waiting for the whole queue instead");
+            return;
+        }
+
+        VkSemaphoreTypeCreateInfoKHR typeCreateInfo = {};
+        typeCreateInfo.sType         = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR;
+        typeCreateInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+        typeCreateInfo.initialValue  = 0;
+
+        VkSemaphoreCreateInfo semaphoreCreateInfo = {};
+        semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        semaphoreCreateInfo.pNext = &typeCreateInfo;
+
+        VkResult result = pLogicalDevice->vkd.CreateSemaphore(pLogicalDevice->device, &semaphoreCreateInfo, nullptr, &semaphore);
+        ASSERT_VULKAN(result);
+    }
+
+    FrameTimeline::~FrameTimeline()
+    {
+        waitSubmitted();
+        for (Retired& entry : retired)
+            entry.destroy();
+
+        if (semaphore != VK_NULL_HANDLE)
+            pLogicalDevice->vkd.DestroySemaphore(pLogicalDevice->device, semaphore, nullptr);
+    }
+
+    VkResult FrameTimeline::submit(uint32_t submitCount, VkSubmitInfo* pSubmits, VkFence fence, uint64_t& value)
+    {
+        value = 0;
+        if (semaphore == VK_NULL_HANDLE || submitCount == 0)
+            return pLogicalDevice->vkd.QueueSubmit(pLogicalDevice->queue, submitCount, pSubmits, fence);
+
+        // Binary semaphores ignore their value
+        VkSubmitInfo submitInfo = pSubmits[submitCount - 1];
+        Signal       signal;
+        uint32_t     count = submitInfo.signalSemaphoreCount;
+        if (count)
+        {
+            signal.semaphores[0] = submitInfo.pSignalSemaphores[0];
+            signal.values[0]     = 0;
+        }
+        signal.semaphores[count] = semaphore;
+        signal.values[count]     = submittedValue + 1;
+
+        signal.timelineInfo                           = {};
+        signal.timelineInfo.sType                     = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+        signal.timelineInfo.pNext                     = submitInfo.pNext;
+        signal.timelineInfo.signalSemaphoreValueCount = count + 1;
+        signal.timelineInfo.pSignalSemaphoreValues    = signal.values.data();
+
+        submitInfo.pNext                = &signal.timelineInfo;
+        submitInfo.signalSemaphoreCount = count + 1;
+        submitInfo.pSignalSemaphores    = signal.semaphores.data();
+
+        // The caller's batch stays as it was
+        VkSubmitInfo original     = pSubmits[submitCount - 1];
+        pSubmits[submitCount - 1] = submitInfo;
+        VkResult result           = pLogicalDevice->vkd.QueueSubmit(pLogicalDevice->queue, submitCount, pSubmits, fence);
+        pSubmits[submitCount - 1] = original;
+
+        // A failed submit never signals, waiting on its value would block forever
+        if (result != VK_SUCCESS)
+        {
+            Logger::err("submit for timeline value " + std::to_string(submittedValue + 1) + " failed: " + std::to_string(result));
+            return result;
+        }
+
+        value = ++submittedValue;
+        return result;
+    }
+
+    bool FrameTimeline::isComplete(uint64_t value)
+    {
+        if (value <= completedValue || semaphore == VK_NULL_HANDLE)
+            return true;
+
+        VkResult result = pLogicalDevice->vkd.GetSemaphoreCounterValueKHR(pLogicalDevice->device, semaphore, &completedValue);
+        ASSERT_VULKAN(result);
+        return value <= completedValue;
+    }
+
+    void FrameTimeline::wait(uint64_t value)
+    {
+        if (isComplete(value))
+            return;
+
+        VkSemaphoreWaitInfoKHR waitInfo = {};
+        waitInfo.sType          = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR;
+        waitInfo.semaphoreCount = 1;
+        waitInfo.pSemaphores    = &semaphore;
+        waitInfo.pValues        = &value;
+
+        VkResult result = pLogicalDevice->vkd.WaitSemaphoresKHR(pLogicalDevice->device, &waitInfo, UINT64_MAX);
+        if (result != VK_SUCCESS)
+        {
+            Logger::err("waiting for timeline value " + std::to_string(value) + " failed: " + std::to_string(result));
+            return;
+        }
+        completedValue = value;
+    }
+
+    void FrameTimeline::waitSubmitted()
+    {
+        if (semaphore == VK_NULL_HANDLE)
+            pLogicalDevice->vkd.QueueWaitIdle(pLogicalDevice->queue);
+        else
+            wait(submittedValue);
+    }
+
+    void FrameTimeline::retire(std::function<void()> destroy)
+    {
+        if (semaphore == VK_NULL_HANDLE)
+            waitSubmitted();
+
+        if (isComplete(submittedValue))
+            destroy();
+        else
+            retired.push_back({submittedValue, std::move(destroy)});
+    }
+
+    void FrameTimeline::collect()
+    {
+        while (!retired.empty() && isComplete(retired.front().value))
+        {
+            retired.front().destroy();
+            retired.pop_front();
+        }
+    }
+} // namespace vkBasalt
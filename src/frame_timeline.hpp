@@ -0,0 +1,70 @@
+#ifndef FRAME_TIMELINE_HPP_INCLUDED
+#define FRAME_TIMELINE_HPP_INCLUDED
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <functional>
+
+#include "vulkan_include.hpp"
+
+namespace vkBasalt
+{
+    struct LogicalDevice;
+
+    // Counts vkBasalt's submissions on its queue with a timeline semaphore, so the layer knows which ones still execute.
+    // Waits then target one submission instead of the whole queue, and resources a submission uses can be destroyed
+    // once its value completed. Without VK_KHR_timeline_semaphore submissions go untracked (value 0),
+    // waitSubmitted() and retire() fall back to vkQueueWaitIdle
+    class FrameTimeline
+    {
+    public:
+        explicit FrameTimeline(LogicalDevice* pLogicalDevice);
+        ~FrameTimeline();
+
+        FrameTimeline(const FrameTimeline&)            = delete;
+        FrameTimeline& operator=(const FrameTimeline&) = delete;
+
+        // vkQueueSubmit on the device's queue, the last batch also signals the next value (on top of its own,
+        // at most one, signal semaphore). value is what the submission will signal, 0 if it failed or goes untracked.
+        // The value only counts as submitted once the submit succeeded
+        VkResult submit(uint32_t submitCount, VkSubmitInfo* pSubmits, VkFence fence, uint64_t& value);
+
+        // The value of the latest submission, it completes after all the earlier ones
+        uint64_t getSubmittedValue() const { return submittedValue; }
+
+        bool isComplete(uint64_t value);
+
+        // Blocks until value completed
+        void wait(uint64_t value);
+        void waitSubmitted();
+
+        // Runs destroy once everything submitted so far completed, or right away if nothing is in flight
+        void retire(std::function<void()> destroy);
+
+        // Runs the retired destroys whose submissions completed, call it once per frame
+        void collect();
+
+    private:
+        // What submit() chains into the last VkSubmitInfo
+        struct Signal
+        {
+            VkTimelineSemaphoreSubmitInfoKHR timelineInfo;
+            std::array<VkSemaphore, 2>       semaphores;
+            std::array<uint64_t, 2>          values;
+        };
+
+        struct Retired
+        {
+            uint64_t              value;
+            std::function<void()> destroy;
+        };
+
+        LogicalDevice*      pLogicalDevice;
+        VkSemaphore         semaphore      = VK_NULL_HANDLE;  // null without timeline semaphore support
+        uint64_t            submittedValue = 0;
+        uint64_t            completedValue = 0;  // cached, only goes up
+        std::deque<Retired> retired;             // in value order
+    };
+} // namespace vkBasalt
+
+#endif // FRAME_TIMELINE_HPP_INCLUDED
@@ -29,7 +29,9 @@ namespace vkBasalt
                                       VkExtent2D            extent,
                                       VkRenderPass          renderPass,
                                       VkPipelineLayout      pipelineLayout,
-                                      bool                  flip)
+                                      bool                  flip,
+                                      const VkPipelineDepthStencilStateCreateInfo* pDepthStencilState,
+                                      bool                  dynamicScissor)
     {
         VkResult result;
 
@@ -143,13 +145,13 @@ namespace vkBasalt
         colorBlendCreateInfo.blendConstants[2] = 0.0f;
         colorBlendCreateInfo.blendConstants[3] = 0.0f;
 
-        VkDynamicState dynamicStates[] = {};
+        VkDynamicState dynamicStates[] = {VK_DYNAMIC_STATE_SCISSOR};
 
         VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo;
         dynamicStateCreateInfo.sType             = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
         dynamicStateCreateInfo.pNext             = nullptr;
         dynamicStateCreateInfo.flags             = 0;
-        dynamicStateCreateInfo.dynamicStateCount = 0;
+        dynamicStateCreateInfo.dynamicStateCount = dynamicScissor ? 1 : 0;
         dynamicStateCreateInfo.pDynamicStates    = dynamicStates;
 
         VkGraphicsPipelineCreateInfo pipelineCreateInfo;
@@ -164,7 +166,7 @@ namespace vkBasalt
         pipelineCreateInfo.pViewportState      = &viewportStateCreateInfo;
         pipelineCreateInfo.pRasterizationState = &rasterizationCreateInfo;
         pipelineCreateInfo.pMultisampleState   = &multisampleCreateInfo;
-        pipelineCreateInfo.pDepthStencilState  = nullptr;
+        pipelineCreateInfo.pDepthStencilState  = pDepthStencilState;
         pipelineCreateInfo.pColorBlendState    = &colorBlendCreateInfo;
         pipelineCreateInfo.pDynamicState       = &dynamicStateCreateInfo;
         pipelineCreateInfo.layout              = pipelineLayout;
@@ -25,7 +25,9 @@ namespace vkBasalt
                                       VkExtent2D            extent,
                                       VkRenderPass          renderPass,
                                       VkPipelineLayout      pipelineLayout,
-                                      bool                  flip = false);
+                                      bool                  flip = false,
+                                      const VkPipelineDepthStencilStateCreateInfo* pDepthStencilState = nullptr,
+                                      bool                  dynamicScissor = false);  // set with vkCmdSetScissor
 
 } // namespace vkBasalt
 
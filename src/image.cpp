@@ -2,6 +2,7 @@
 #include "memory.hpp"
 #include "buffer.hpp"
 #include "format.hpp"
+#include "frame_timeline.hpp"
 
 namespace vkBasalt
 {
@@ -72,7 +73,7 @@ namespace vkBasalt
         memoryAllocateInfo.allocationSize  = memoryRequirements.size * count;
         memoryAllocateInfo.memoryTypeIndex = findMemoryTypeIndex(pLogicalDevice, memoryRequirements.memoryTypeBits, properties);
 
-        result = pLogicalDevice->vkd.AllocateMemory(pLogicalDevice->device, &memoryAllocateInfo, nullptr, &imageMemory);
+        result = allocateMemory(pLogicalDevice, &memoryAllocateInfo, &imageMemory);
         ASSERT_VULKAN(result);
 
         for (uint32_t i = 0; i < count; i++)
@@ -86,6 +87,19 @@ namespace vkBasalt
     void
     uploadToImage(LogicalDevice* pLogicalDevice, VkImage image, VkExtent3D extent, uint32_t size, const unsigned char* writeData, uint32_t mipLevels)
     {
+        uploadToImageScaled(pLogicalDevice, image, extent, VK_FORMAT_UNDEFINED, extent, size, writeData, mipLevels);
+    }
+
+    void uploadToImageScaled(LogicalDevice*       pLogicalDevice,
+                             VkImage              image,
+                             VkExtent3D           extent,
+                             VkFormat             format,
+                             VkExtent3D           dataExtent,
+                             uint32_t             size,
+                             const unsigned char* writeData,
+                             uint32_t             mipLevels)
+    {
+        bool scaled = dataExtent.width != extent.width || dataExtent.height != extent.height || dataExtent.depth != extent.depth;
 
         VkBuffer       stagingBuffer;
         VkDeviceMemory stagingMemory;
@@ -102,6 +116,20 @@ namespace vkBasalt
         std::memcpy(data, writeData, size);
         pLogicalDevice->vkd.UnmapMemory(pLogicalDevice->device, stagingMemory);
 
+        // The data goes to an image of its own size first, the blit scales it into image
+        VkImage        dataImage       = image;
+        VkDeviceMemory dataImageMemory = VK_NULL_HANDLE;
+        if (scaled)
+        {
+            dataImage = createImages(pLogicalDevice,
+                                     1,
+                                     dataExtent,
+                                     format,
+                                     VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+                                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                     dataImageMemory)[0];
+        }
+
         VkCommandBufferAllocateInfo allocInfo = {};
 
         allocInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -130,7 +158,7 @@ namespace vkBasalt
         memoryBarrier.newLayout                       = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
         memoryBarrier.srcQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
         memoryBarrier.dstQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
-        memoryBarrier.image                           = image;
+        memoryBarrier.image                           = dataImage;
         memoryBarrier.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
         memoryBarrier.subresourceRange.baseMipLevel   = 0;
         memoryBarrier.subresourceRange.levelCount     = 1;
@@ -149,9 +177,42 @@ namespace vkBasalt
         region.imageSubresource.baseArrayLayer = 0;
         region.imageSubresource.layerCount     = 1;
         region.imageOffset                     = {0, 0, 0};
-        region.imageExtent                     = extent;
+        region.imageExtent                     = dataExtent;
+
+        pLogicalDevice->vkd.CmdCopyBufferToImage(commandBuffer, stagingBuffer, dataImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+        if (scaled)
+        {
+            // Linear filtering in the blit replaces resizing on the CPU
+            VkImageMemoryBarrier blitBarriers[2] = {memoryBarrier, memoryBarrier};
+            blitBarriers[0].oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            blitBarriers[0].newLayout     = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+            blitBarriers[0].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            blitBarriers[0].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+            blitBarriers[1].image         = image;
+
+            pLogicalDevice->vkd.CmdPipelineBarrier(
+                commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 2, blitBarriers);
 
-        pLogicalDevice->vkd.CmdCopyBufferToImage(commandBuffer, stagingBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+            VkImageBlit blit;
+            blit.srcSubresource = region.imageSubresource;
+            blit.srcOffsets[0]  = {0, 0, 0};
+            blit.srcOffsets[1]  = {int32_t(dataExtent.width), int32_t(dataExtent.height), int32_t(dataExtent.depth)};
+            blit.dstSubresource = region.imageSubresource;
+            blit.dstOffsets[0]  = {0, 0, 0};
+            blit.dstOffsets[1]  = {int32_t(extent.width), int32_t(extent.height), int32_t(extent.depth)};
+
+            pLogicalDevice->vkd.CmdBlitImage(commandBuffer,
+                                             dataImage,
+                                             VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                             image,
+                                             VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                             1,
+                                             &blit,
+                                             VK_FILTER_LINEAR);
+
+            memoryBarrier.image = image;
+        }
 
         memoryBarrier.oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
         memoryBarrier.newLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
@@ -171,12 +232,21 @@ namespace vkBasalt
         submitInfo.commandBufferCount = 1;
         submitInfo.pCommandBuffers    = &commandBuffer;
 
-        pLogicalDevice->vkd.QueueSubmit(pLogicalDevice->queue, 1, &submitInfo, VK_NULL_HANDLE);
-        pLogicalDevice->vkd.QueueWaitIdle(pLogicalDevice->queue);
-
-        pLogicalDevice->vkd.FreeCommandBuffers(pLogicalDevice->device, pLogicalDevice->commandPool, 1, &commandBuffer);
-        pLogicalDevice->vkd.FreeMemory(pLogicalDevice->device, stagingMemory, nullptr);
-        pLogicalDevice->vkd.DestroyBuffer(pLogicalDevice->device, stagingBuffer, nullptr);
+        // Later submissions on the queue are ordered behind the barriers, only the staging resources wait for the upload
+        // If the submit fails nothing runs and retire() frees right away
+        uint64_t value;
+        pLogicalDevice->frameTimeline->submit(1, &submitInfo, VK_NULL_HANDLE, value);
+
+        pLogicalDevice->frameTimeline->retire([=]() {
+            pLogicalDevice->vkd.FreeCommandBuffers(pLogicalDevice->device, pLogicalDevice->commandPool, 1, &commandBuffer);
+            freeMemory(pLogicalDevice, stagingMemory);
+            pLogicalDevice->vkd.DestroyBuffer(pLogicalDevice->device, stagingBuffer, nullptr);
+            if (scaled)
+            {
+                pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, dataImage, nullptr);
+                freeMemory(pLogicalDevice, dataImageMemory);
+            }
+        });
     }
 
     void changeImageLayout(LogicalDevice* pLogicalDevice, std::vector<VkImage> images, uint32_t mipLevels)
@@ -230,10 +300,12 @@ namespace vkBasalt
         submitInfo.commandBufferCount = 1;
         submitInfo.pCommandBuffers    = &commandBuffer;
 
-        pLogicalDevice->vkd.QueueSubmit(pLogicalDevice->queue, 1, &submitInfo, VK_NULL_HANDLE);
-        pLogicalDevice->vkd.QueueWaitIdle(pLogicalDevice->queue);
+        // If the submit fails nothing runs and retire() frees right away
+        uint64_t value;
+        pLogicalDevice->frameTimeline->submit(1, &submitInfo, VK_NULL_HANDLE, value);
 
-        pLogicalDevice->vkd.FreeCommandBuffers(pLogicalDevice->device, pLogicalDevice->commandPool, 1, &commandBuffer);
+        pLogicalDevice->frameTimeline->retire(
+            [=]() { pLogicalDevice->vkd.FreeCommandBuffers(pLogicalDevice->device, pLogicalDevice->commandPool, 1, &commandBuffer); });
     }
 
     void generateMipMaps(LogicalDevice* pLogicalDevice, VkCommandBuffer commandBuffer, VkImage image, VkExtent3D extent, uint32_t mipLevels)
@@ -26,6 +26,17 @@ namespace vkBasalt
     void uploadToImage(
         LogicalDevice* pLogicalDevice, VkImage image, VkExtent3D extent, uint32_t size, const unsigned char* writeData, uint32_t mipLevels = 1);
 
+    // Like uploadToImage, but writeData is dataExtent large and gets scaled to extent by a linear blit.
+    // format is the one of writeData, it needs blit support (the 8 bit UNORM formats always have it)
+    void uploadToImageScaled(LogicalDevice*       pLogicalDevice,
+                             VkImage              image,
+                             VkExtent3D           extent,
+                             VkFormat             format,
+                             VkExtent3D           dataExtent,
+                             uint32_t             size,
+                             const unsigned char* writeData,
+                             uint32_t             mipLevels = 1);
+
     void changeImageLayout(LogicalDevice* pLogicalDevice, std::vector<VkImage> images, uint32_t mipLevels = 1);
 
     void generateMipMaps(LogicalDevice* pLogicalDevice, VkCommandBuffer commandBuffer, VkImage image, VkExtent3D extent, uint32_t mipLevels);
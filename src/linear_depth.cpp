@@ -0,0 +1,214 @@
+#include "linear_depth.hpp"
+
+#include "image.hpp"
+#include "image_view.hpp"
+#include "descriptor_set.hpp"
+#include "graphics_pipeline.hpp"
+#include "framebuffer.hpp"
+#include "shader.hpp"
+#include "memory.hpp"
+#include "config.hpp"
+#include "logger.hpp"
+#include "util.hpp"
+
+#include "shader_sources.hpp"
+
+namespace vkBasalt
+{
+    namespace
+    {
+        VkRenderPass createLinearDepthRenderPass(LogicalDevice* pLogicalDevice, VkFormat format)
+        {
+            VkAttachmentDescription attachmentDescription = {};
+            attachmentDescription.format         = format;
+            attachmentDescription.samples        = VK_SAMPLE_COUNT_1_BIT;
+            attachmentDescription.loadOp         = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+            attachmentDescription.storeOp        = VK_ATTACHMENT_STORE_OP_STORE;
+            attachmentDescription.stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+            attachmentDescription.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+            attachmentDescription.initialLayout  = VK_IMAGE_LAYOUT_UNDEFINED;
+            attachmentDescription.finalLayout    = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+            VkAttachmentReference attachmentReference;
+            attachmentReference.attachment = 0;
+            attachmentReference.layout     = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+            VkSubpassDescription subpassDescription = {};
+            subpassDescription.pipelineBindPoint    = VK_PIPELINE_BIND_POINT_GRAPHICS;
+            subpassDescription.colorAttachmentCount = 1;
+            subpassDescription.pColorAttachments    = &attachmentReference;
+
+            // wait for last frame's effects to stop reading, and make the result visible to this frame's
+            VkSubpassDependency subpassDependencies[2] = {};
+            subpassDependencies[0].srcSubpass    = VK_SUBPASS_EXTERNAL;
+            subpassDependencies[0].dstSubpass    = 0;
+            subpassDependencies[0].srcStageMask  = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+            subpassDependencies[0].dstStageMask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+            subpassDependencies[0].srcAccessMask = 0;
+            subpassDependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+            subpassDependencies[1].srcSubpass    = 0;
+            subpassDependencies[1].dstSubpass    = VK_SUBPASS_EXTERNAL;
+            subpassDependencies[1].srcStageMask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+            subpassDependencies[1].dstStageMask  = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+            subpassDependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+            subpassDependencies[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+            VkRenderPassCreateInfo renderPassCreateInfo = {};
+            renderPassCreateInfo.sType           = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+            renderPassCreateInfo.attachmentCount = 1;
+            renderPassCreateInfo.pAttachments    = &attachmentDescription;
+            renderPassCreateInfo.subpassCount    = 1;
+            renderPassCreateInfo.pSubpasses      = &subpassDescription;
+            renderPassCreateInfo.dependencyCount = 2;
+            renderPassCreateInfo.pDependencies   = subpassDependencies;
+
+            VkRenderPass renderPass;
+            VkResult     result = pLogicalDevice->vkd.CreateRenderPass(pLogicalDevice->device, &renderPassCreateInfo, nullptr, &renderPass);
+            ASSERT_VULKAN(result);
+            return renderPass;
+        }
+
+        // R32 when the device can filter it (not required by the spec), R16 otherwise
+        VkFormat chooseLinearDepthFormat(LogicalDevice* pLogicalDevice)
+        {
+            VkFormatProperties properties;
+            pLogicalDevice->vki.GetPhysicalDeviceFormatProperties(pLogicalDevice->physicalDevice, VK_FORMAT_R32_SFLOAT, &properties);
+            VkFormatFeatureFlags needed = VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+            return (properties.optimalTilingFeatures & needed) == needed ? VK_FORMAT_R32_SFLOAT : VK_FORMAT_R16_SFLOAT;
+        }
+    } // namespace
+
+    LinearDepthPass::LinearDepthPass(LogicalDevice* pLogicalDevice, VkExtent2D imageExtent, Config* pConfig)
+        : pLogicalDevice(pLogicalDevice), imageExtent(imageExtent)
+    {
+        // Same parameters and defaults as the RESHADE_DEPTH_* macros of ReShade.fxh
+        struct
+        {
+            float    farPlane;
+            float    multiplier;
+            VkBool32 reversed;
+            VkBool32 logarithmic;
+        } linearizeOptions{};
+
+        linearizeOptions.farPlane    = pConfig->getOption<float>("depthLinearizationFarPlane", 1000.0f);
+        linearizeOptions.multiplier  = pConfig->getOption<float>("depthMultiplier", 1.0f);
+        linearizeOptions.reversed    = pConfig->getOption<bool>("depthInputIsReversed", true);
+        linearizeOptions.logarithmic = pConfig->getOption<bool>("depthInputIsLogarithmic", false);
+
+        VkSpecializationMapEntry specMapEntrys[4];
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            specMapEntrys[i].constantID = i;
+            specMapEntrys[i].offset     = sizeof(float) * i; // VkBool32 is the same size as float
+            specMapEntrys[i].size       = sizeof(float);
+        }
+
+        VkSpecializationInfo specializationInfo;
+        specializationInfo.mapEntryCount = 4;
+        specializationInfo.pMapEntries   = specMapEntrys;
+        specializationInfo.dataSize      = sizeof(linearizeOptions);
+        specializationInfo.pData         = &linearizeOptions;
+
+        format = chooseLinearDepthFormat(pLogicalDevice);
+        image  = createImages(pLogicalDevice,
+                             1,
+                             {imageExtent.width, imageExtent.height, 1},
+                             format,
+                             VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                             imageMemory)[0];
+        imageView = createImageViews(pLogicalDevice, format, {image})[0];
+
+        // depth is read texel by texel, filtering raw depth would mix foreground and background
+        VkSamplerCreateInfo samplerCreateInfo = {};
+        samplerCreateInfo.sType        = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        samplerCreateInfo.magFilter    = VK_FILTER_NEAREST;
+        samplerCreateInfo.minFilter    = VK_FILTER_NEAREST;
+        samplerCreateInfo.mipmapMode   = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+        samplerCreateInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerCreateInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerCreateInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerCreateInfo.compareOp    = VK_COMPARE_OP_ALWAYS;
+        samplerCreateInfo.borderColor  = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+        VkResult result = pLogicalDevice->vkd.CreateSampler(pLogicalDevice->device, &samplerCreateInfo, nullptr, &sampler);
+        ASSERT_VULKAN(result);
+
+        descriptorSetLayout = createImageSamplerDescriptorSetLayout(pLogicalDevice, 1);
+
+        VkDescriptorPoolSize imagePoolSize;
+        imagePoolSize.type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        imagePoolSize.descriptorCount = 1;
+        descriptorPool                = createDescriptorPool(pLogicalDevice, {imagePoolSize});
+
+        VkDescriptorSetAllocateInfo descriptorSetAllocateInfo = {};
+        descriptorSetAllocateInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        descriptorSetAllocateInfo.descriptorPool     = descriptorPool;
+        descriptorSetAllocateInfo.descriptorSetCount = 1;
+        descriptorSetAllocateInfo.pSetLayouts        = &descriptorSetLayout;
+        result = pLogicalDevice->vkd.AllocateDescriptorSets(pLogicalDevice->device, &descriptorSetAllocateInfo, &descriptorSet);
+        ASSERT_VULKAN(result);
+
+        createShaderModule(pLogicalDevice, full_screen_triangle_vert, &vertexModule);
+        createShaderModule(pLogicalDevice, linear_depth_frag, &fragmentModule);
+
+        renderPass     = createLinearDepthRenderPass(pLogicalDevice, format);
+        pipelineLayout = createGraphicsPipelineLayout(pLogicalDevice, {descriptorSetLayout});
+        pipeline       = createGraphicsPipeline(
+            pLogicalDevice, vertexModule, nullptr, "main", fragmentModule, &specializationInfo, "main", imageExtent, renderPass, pipelineLayout);
+        framebuffer = createFramebuffers(pLogicalDevice, renderPass, imageExtent, {{imageView}})[0];
+
+        Logger::debug("created linear depth pass, format " + convertToString(format));
+    }
+
+    VkImageView LinearDepthPass::useDepthImage(VkImageView depthImageView)
+    {
+        VkDescriptorImageInfo imageInfo;
+        imageInfo.sampler     = sampler;
+        imageInfo.imageView   = depthImageView;
+        imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        VkWriteDescriptorSet writeDescriptorSet = {};
+        writeDescriptorSet.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writeDescriptorSet.dstSet          = descriptorSet;
+        writeDescriptorSet.dstBinding      = 0;
+        writeDescriptorSet.descriptorCount = 1;
+        writeDescriptorSet.descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        writeDescriptorSet.pImageInfo      = &imageInfo;
+        pLogicalDevice->vkd.UpdateDescriptorSets(pLogicalDevice->device, 1, &writeDescriptorSet, 0, nullptr);
+
+        return imageView;
+    }
+
+    void LinearDepthPass::record(VkCommandBuffer commandBuffer)
+    {
+        VkRenderPassBeginInfo renderPassBeginInfo = {};
+        renderPassBeginInfo.sType             = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        renderPassBeginInfo.renderPass        = renderPass;
+        renderPassBeginInfo.framebuffer       = framebuffer;
+        renderPassBeginInfo.renderArea.offset = {0, 0};
+        renderPassBeginInfo.renderArea.extent = imageExtent;
+
+        pLogicalDevice->vkd.CmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+        pLogicalDevice->vkd.CmdBindDescriptorSets(
+            commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+        pLogicalDevice->vkd.CmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+        pLogicalDevice->vkd.CmdDraw(commandBuffer, 3, 1, 0, 0);
+        pLogicalDevice->vkd.CmdEndRenderPass(commandBuffer);
+    }
+
+    LinearDepthPass::~LinearDepthPass()
+    {
+        pLogicalDevice->vkd.DestroyFramebuffer(pLogicalDevice->device, framebuffer, nullptr);
+        pLogicalDevice->vkd.DestroyPipeline(pLogicalDevice->device, pipeline, nullptr);
+        pLogicalDevice->vkd.DestroyPipelineLayout(pLogicalDevice->device, pipelineLayout, nullptr);
+        pLogicalDevice->vkd.DestroyRenderPass(pLogicalDevice->device, renderPass, nullptr);
+        pLogicalDevice->vkd.DestroyShaderModule(pLogicalDevice->device, vertexModule, nullptr);
+        pLogicalDevice->vkd.DestroyShaderModule(pLogicalDevice->device, fragmentModule, nullptr);
+        pLogicalDevice->vkd.DestroyDescriptorPool(pLogicalDevice->device, descriptorPool, nullptr);
+        pLogicalDevice->vkd.DestroyDescriptorSetLayout(pLogicalDevice->device, descriptorSetLayout, nullptr);
+        pLogicalDevice->vkd.DestroySampler(pLogicalDevice->device, sampler, nullptr);
+        pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, imageView, nullptr);
+        pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, image, nullptr);
+        freeMemory(pLogicalDevice, imageMemory);
+    }
+} // namespace vkBasalt
@@ -0,0 +1,54 @@
+#ifndef LINEAR_DEPTH_HPP_INCLUDED
+#define LINEAR_DEPTH_HPP_INCLUDED
+#include <vector>
+#include <string>
+#include <memory>
+
+#include "vulkan_include.hpp"
+
+#include "logical_device.hpp"
+
+namespace vkBasalt
+{
+    class Config;
+
+    // Converts the game's depth buffer into linear depth once per frame.
+    // ReShade effects sample the result instead of the raw depth, their GetLinearizedDepth()
+    // is turned into a plain read by the macros in ReshadeEffect::createReshadeModule().
+    class LinearDepthPass
+    {
+    public:
+        LinearDepthPass(LogicalDevice* pLogicalDevice, VkExtent2D imageExtent, Config* pConfig);
+        ~LinearDepthPass();
+
+        LinearDepthPass(const LinearDepthPass&)            = delete;
+        LinearDepthPass& operator=(const LinearDepthPass&) = delete;
+
+        // Reads from depthImageView from now on, returns the view effects should sample
+        VkImageView useDepthImage(VkImageView depthImageView);
+
+        // Expects the depth image in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        // leaves the linear depth image in the same layout
+        void record(VkCommandBuffer commandBuffer);
+
+    private:
+        LogicalDevice*        pLogicalDevice;
+        VkExtent2D            imageExtent;
+        VkFormat              format;
+        VkImage               image          = VK_NULL_HANDLE;
+        VkImageView           imageView      = VK_NULL_HANDLE;
+        VkDeviceMemory        imageMemory    = VK_NULL_HANDLE;
+        VkSampler             sampler        = VK_NULL_HANDLE;
+        VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
+        VkDescriptorPool      descriptorPool = VK_NULL_HANDLE;
+        VkDescriptorSet       descriptorSet  = VK_NULL_HANDLE;
+        VkShaderModule        vertexModule   = VK_NULL_HANDLE;
+        VkShaderModule        fragmentModule = VK_NULL_HANDLE;
+        VkRenderPass          renderPass     = VK_NULL_HANDLE;
+        VkPipelineLayout      pipelineLayout = VK_NULL_HANDLE;
+        VkPipeline            pipeline       = VK_NULL_HANDLE;
+        VkFramebuffer         framebuffer    = VK_NULL_HANDLE;
+    };
+} // namespace vkBasalt
+
+#endif // LINEAR_DEPTH_HPP_INCLUDED
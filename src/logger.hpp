@@ -2,6 +2,7 @@
 #define LOGGER_HPP_INCLUDED
 
 #include <array>
+#include <chrono>
 #include <fstream>
 #include <iostream>
 #include <mutex>
@@ -82,6 +83,42 @@ namespace vkBasalt
         static std::string getFileName();
     };
 
+    // Logs how long the enclosing scope took at debug level, for CPU paths that run at load time.
+    // Only reads the clock and builds the label ("what subject") when debug logging is on
+    class ScopedTimer
+    {
+    public:
+        explicit ScopedTimer(const char* what) : ScopedTimer(what, nullptr) {}
+        ScopedTimer(const char* what, const std::string& subject) : ScopedTimer(what, &subject) {}
+
+        ~ScopedTimer()
+        {
+            if (!enabled)
+                return;
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            Logger::debug(label + " took " + std::to_string(ms) + " ms");
+        }
+
+        ScopedTimer(const ScopedTimer&)            = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    private:
+        ScopedTimer(const char* what, const std::string* pSubject)
+        {
+            if (Logger::logLevel() > LogLevel::Debug)
+                return;
+            label = what;
+            if (pSubject)
+                label += " " + *pSubject;
+            start   = std::chrono::steady_clock::now();
+            enabled = true;
+        }
+
+        std::string                           label;
+        std::chrono::steady_clock::time_point start;
+        bool                                  enabled = false;
+    };
+
 } // namespace vkBasalt
 
 #endif // LOGGER_HPP_INCLUDED
@@ -9,11 +9,15 @@
 
 #include "vulkan_include.hpp"
 #include "vkdispatch.hpp"
+#include "memory_tracker.hpp"
 
 namespace vkBasalt
 {
     struct OverlayPersistentState;  // Forward declaration
     class ImGuiOverlay;  // Forward declaration
+    class PresentLatencyTracker;
+    class ChainProfiler;
+    class FrameTimeline;
 
     struct LogicalDevice
     {
@@ -22,19 +26,37 @@ namespace vkBasalt
         VkDevice                 device;
         VkPhysicalDevice         physicalDevice;
         VkInstance               instance;
-        VkQueue                  queue;
+        VkQueue                  queue;  // every vkBasalt submission goes here
         uint32_t                 queueFamilyIndex;
+        bool                     dedicatedQueue        = false;           // queue is an extra queue, not the application's
+        VkSemaphore              queueHandoffSemaphore = VK_NULL_HANDLE;  // orders presents without wait semaphores
         VkCommandPool            commandPool;
         bool                     supportsMutableFormat;
+        bool                     supportsMemoryBudget   = false;
+        bool                     supportsFloat16        = false;  // shaderFloat16 is enabled on the device
+        bool                     supportsPushDescriptor = false;  // VK_KHR_push_descriptor is enabled
+        bool                     supportsTimelineSemaphore = false;  // VK_KHR_timeline_semaphore is enabled
         std::vector<VkImage>     depthImages;
         std::vector<VkFormat>    depthFormats;
         std::vector<VkImageView> depthImageViews;
 
+        // Every allocation made through allocateMemory(), grouped by owner
+        MemoryTracker memoryTracker;
+
         // Persistent overlay state that survives swapchain recreation
         std::unique_ptr<OverlayPersistentState> overlayPersistentState;
 
         // ImGui overlay - lives at device level to survive swapchain recreation
         std::unique_ptr<ImGuiOverlay> imguiOverlay;
+
+        // Only with the presentLatencyStats setting
+        std::unique_ptr<PresentLatencyTracker> presentLatency;
+
+        // Tracks which of vkBasalt's submissions still execute, see frame_timeline.hpp
+        std::unique_ptr<FrameTimeline> frameTimeline;
+
+        // Created when the overlay first asks for a chain profile
+        std::unique_ptr<ChainProfiler> chainProfiler;
     };
 } // namespace vkBasalt
 
@@ -1,4 +1,6 @@
 #include "logical_swapchain.hpp"
+#include "frame_timeline.hpp"
+#include "memory.hpp"
 
 namespace vkBasalt
 {
@@ -6,16 +8,24 @@ namespace vkBasalt
     {
         if (imageCount > 0)
         {
+            // Not only the frames, the uploads and layout changes of its effects and fake images have to be done as well,
+            // and those are submitted before the first present
+            pLogicalDevice->frameTimeline->waitSubmitted();
+
             effects.clear();
             defaultTransfer.reset();
+            linearDepth.reset();
+            scratchImages.reset();
 
-            pLogicalDevice->vkd.FreeCommandBuffers(
-                pLogicalDevice->device, pLogicalDevice->commandPool, commandBuffersEffect.size(), commandBuffersEffect.data());
-            pLogicalDevice->vkd.FreeCommandBuffers(
-                pLogicalDevice->device, pLogicalDevice->commandPool, commandBuffersNoEffect.size(), commandBuffersNoEffect.data());
+            if (!commandBuffersEffect.empty())
+                pLogicalDevice->vkd.FreeCommandBuffers(
+                    pLogicalDevice->device, pLogicalDevice->commandPool, commandBuffersEffect.size(), commandBuffersEffect.data());
+            if (!commandBuffersNoEffect.empty())
+                pLogicalDevice->vkd.FreeCommandBuffers(
+                    pLogicalDevice->device, pLogicalDevice->commandPool, commandBuffersNoEffect.size(), commandBuffersNoEffect.data());
             Logger::debug("after free commandbuffer");
 
-            pLogicalDevice->vkd.FreeMemory(pLogicalDevice->device, fakeImageMemory, nullptr);
+            freeMemory(pLogicalDevice, fakeImageMemory);
 
             for (uint32_t i = 0; i < fakeImages.size(); i++)
             {
@@ -12,6 +12,8 @@
 #include "vulkan_include.hpp"
 
 #include "logical_device.hpp"
+#include "linear_depth.hpp"
+#include "scratch_images.hpp"
 
 namespace vkBasalt
 {
@@ -22,20 +24,27 @@ namespace vkBasalt
     {
         LogicalDevice*                       pLogicalDevice;
         VkSwapchainCreateInfoKHR             swapchainCreateInfo;
-        VkExtent2D                           imageExtent;
+        VkExtent2D                           imageExtent;   // what the application renders at
+        VkExtent2D                           outputExtent;  // the real swapchain images, larger than imageExtent when upscaling
         VkFormat                             format;
         uint32_t                             imageCount;
         std::vector<VkImage>                 images;
         std::vector<VkImageView>             imageViews;  // for overlay rendering
-        std::vector<VkImage>                 fakeImages;
+        std::vector<VkImage>                 fakeImages;  // empty when bypassed
+        bool                                 bypass = false;  // the application renders into images directly, no effects
         size_t                               maxEffectSlots = 0;  // Max number of effects supported
         std::vector<VkCommandBuffer>         commandBuffersEffect;
         std::vector<VkCommandBuffer>         commandBuffersNoEffect;
         std::vector<VkSemaphore>             semaphores;
         std::vector<VkSemaphore>             overlaySemaphores;
         std::vector<std::shared_ptr<Effect>> effects;
+        std::vector<std::string>             effectNames;  // the effect in each slot, effects may have a final pass after them
         std::shared_ptr<Effect>              defaultTransfer;
-        VkDeviceMemory                       fakeImageMemory;
+        std::unique_ptr<LinearDepthPass>     linearDepth;  // only while an effect samples depth and the prepass is enabled
+        std::unique_ptr<ScratchImages>       scratchImages;  // stencil and back buffers shared by the effects
+        VkDeviceMemory                       fakeImageMemory = VK_NULL_HANDLE;
+        uint64_t                             presentId = 0;  // last VkPresentIdKHR a present was tagged with
+        std::vector<uint64_t>                frameValues;    // per image, FrameTimeline value of its last effect submission
 
         void destroy();
         void reloadEffects(Config* pConfig);
@@ -1,124 +1,322 @@
 #include "lut_cube.hpp"
 
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <sstream>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include "logger.hpp"
 
 namespace vkBasalt
 {
-    LutCube::LutCube()
-    {
-    }
-    LutCube::LutCube(const std::string& file)
+    namespace
     {
-        std::ifstream cubeStream(file);
-        if (!cubeStream.good())
+        constexpr char cacheMagic[8] = {'V', 'K', 'B', 'L', 'U', 'T', '1', '\0'};
+
+        struct CacheHeader
         {
-            Logger::err("lut cube file does not exist");
+            char     magic[8];
+            int64_t  mtime; // ns
+            uint64_t fileSize;
+            int32_t  size;
+            uint32_t padding;
+        };
+
+        std::string getCacheFile(const std::string& file)
+        {
+            std::string cacheDir;
+            if (const char* xdgCache = std::getenv("XDG_CACHE_HOME"))
+                cacheDir = std::string(xdgCache) + "/vkBasalt-overlay/lut";
+            else if (const char* home = std::getenv("HOME"))
+                cacheDir = std::string(home) + "/.cache/vkBasalt-overlay/lut";
+            else
+                return "";
+
+            std::error_code ec;
+            std::string     path = std::filesystem::weakly_canonical(file, ec).string();
+            if (ec)
+                path = file;
+
+            std::stringstream name;
+            name << std::hex << std::hash<std::string>()(path) << ".bin";
+            return cacheDir + "/" + name.str();
         }
 
-        std::string line;
+        const char* skipWhiteSpace(const char* begin, const char* end)
+        {
+            while (begin < end && (*begin == ' ' || *begin == '\t'))
+                begin++;
+            return begin;
+        }
 
-        while (std::getline(cubeStream, line))
+        bool startsWith(const char* begin, const char* end, const char* keyword)
         {
-            parseLine(line);
+            size_t length = std::strlen(keyword);
+            return (size_t) (end - begin) >= length && std::memcmp(begin, keyword, length) == 0;
+        }
+
+        // reads whitespace separated floats, returns false if there are fewer than count
+        bool parseFloats(const char* begin, const char* end, float* out, int count)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                begin = skipWhiteSpace(begin, end);
+                if (begin < end && *begin == '+')
+                    begin++;
+                auto [next, error] = std::from_chars(begin, end, out[i]);
+                if (error != std::errc())
+                    return false;
+                begin = next;
+            }
+            return true;
         }
+
+        uint16_t floatToHalf(float value)
+        {
+            uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+
+            uint32_t sign     = (bits >> 16) & 0x8000;
+            uint32_t mantissa = bits & 0x7FFFFF;
+            int32_t  exponent = (int32_t) ((bits >> 23) & 0xFF) - 127 + 15;
+
+            if (((bits >> 23) & 0xFF) == 0xFF)
+                return sign | 0x7C00 | (mantissa ? 0x200 : 0);
+            if (exponent >= 31)
+                return sign | 0x7C00;
+
+            uint32_t shift = 13;
+            uint32_t half  = sign | ((uint32_t) std::max(exponent, 0) << 10);
+            if (exponent <= 0)
+            {
+                // subnormal
+                if (exponent < -10)
+                    return sign;
+                mantissa |= 0x800000;
+                shift = 14 - exponent;
+            }
+            half |= mantissa >> shift;
+
+            // round to nearest even, a carry into the exponent is still correct
+            uint32_t rest    = mantissa & ((1u << shift) - 1);
+            uint32_t halfway = 1u << (shift - 1);
+            if (rest > halfway || (rest == halfway && (half & 1)))
+                half++;
+            return half;
+        }
+    } // namespace
+
+    LutCube::LutCube()
+    {
     }
-    void LutCube::parseLine(std::string line)
+    LutCube::LutCube(const std::string& file)
     {
-        if (line.length() == 0)
+        ScopedTimer timer("loading lut cube", file);
+        int fd = open(file.c_str(), O_RDONLY);
+        if (fd < 0)
         {
+            Logger::err("lut cube file does not exist");
             return;
         }
-        if (line[0] == '#')
+
+        struct stat fileStat;
+        if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0)
         {
+            Logger::err("could not read lut cube file " + file);
+            close(fd);
             return;
         }
-        if (line.find("LUT_3D_SIZE") != std::string::npos)
-        {
-            line = line.substr(line.find("LUT_3D_SIZE") + 11);
-            line = skipWhiteSpace(line);
-            size = std::stoi(line);
 
-            colorCube = std::vector<unsigned char>(size * size * size * 4, 255);
+        int64_t     mtime     = (int64_t) fileStat.st_mtim.tv_sec * 1000000000 + fileStat.st_mtim.tv_nsec;
+        uint64_t    fileSize  = fileStat.st_size;
+        std::string cacheFile = getCacheFile(file);
+        if (!cacheFile.empty() && loadCache(cacheFile, mtime, fileSize))
+        {
+            Logger::debug("loaded lut cube " + file + " from cache");
+            close(fd);
             return;
         }
-        if (line.find("DOMAIN_MIN") != std::string::npos)
+
+        void* data = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (data == MAP_FAILED)
         {
-            line = line.substr(line.find("DOMAIN_MIN") + 10);
-            splitTripel(line, minX, minY, minZ);
+            Logger::err("could not map lut cube file " + file);
             return;
         }
-        if (line.find("DOMAIN_MAX") != std::string::npos)
+        madvise(data, fileSize, MADV_SEQUENTIAL);
+
+        bool parsed = parse(static_cast<const char*>(data), fileSize);
+        munmap(data, fileSize);
+
+        if (!parsed)
         {
-            line = line.substr(line.find("DOMAIN_MAX") + 10);
-            splitTripel(line, maxX, maxY, maxZ);
+            Logger::err("invalid lut cube file " + file);
+            colorCube.clear();
+            size = 0;
             return;
         }
-        if (line.find_first_of("0123456789") == 0)
+
+        if (!cacheFile.empty())
+            saveCache(cacheFile, mtime, fileSize);
+    }
+
+    bool LutCube::parse(const char* data, size_t length)
+    {
+        const char* end = data + length;
+        for (const char* line = data; line < end;)
         {
-            float         x, y, z;
-            unsigned char outX, outY, outZ;
-            splitTripel(line, x, y, z);
-            clampTripel(x, y, z, outX, outY, outZ);
-            writeColor(currentX, currentY, currentZ, outX, outY, outZ);
-            if (currentX != size - 1)
-            {
-                currentX++;
-            }
-            else if (currentY != size - 1)
-            {
-                currentY++;
-                currentX = 0;
-            }
-            else if (currentZ != size - 1)
-            {
-                currentZ++;
-                currentX = 0;
-                currentY = 0;
-            }
-            return;
+            const char* lineEnd = static_cast<const char*>(std::memchr(line, '\n', end - line));
+            if (!lineEnd)
+                lineEnd = end;
+            if (!parseLine(line, lineEnd))
+                return false;
+            line = lineEnd + 1;
         }
+
+        if (size && currentPoint != (size_t) size * size * size)
+            Logger::warn("lut cube has " + std::to_string(currentPoint) + " points, expected " + std::to_string(size * size * size));
+        return size != 0;
     }
 
-    std::string LutCube::skipWhiteSpace(std::string text)
+    bool LutCube::parseLine(const char* begin, const char* end)
     {
-        while (text.size() > 0 && (text[0] == ' ' || text[0] == '\t'))
+        if (end > begin && end[-1] == '\r')
+            end--;
+        begin = skipWhiteSpace(begin, end);
+        if (begin == end || *begin == '#')
+            return true;
+
+        if (startsWith(begin, end, "LUT_3D_SIZE"))
+        {
+            begin = skipWhiteSpace(begin + 11, end);
+            if (std::from_chars(begin, end, size).ec != std::errc() || size < 2 || size > 256)
+            {
+                Logger::err("invalid LUT_3D_SIZE");
+                size = 0;
+                return false;
+            }
+            colorCube = std::vector<float>((size_t) size * size * size * 4, 1.0f);
+            return true;
+        }
+        if (startsWith(begin, end, "DOMAIN_MIN"))
         {
-            text = text.substr(1);
+            float domain[3];
+            if (!parseFloats(begin + 10, end, domain, 3))
+                return false;
+            minX = domain[0];
+            minY = domain[1];
+            minZ = domain[2];
+            return true;
         }
-        return text;
+        if (startsWith(begin, end, "DOMAIN_MAX"))
+        {
+            float domain[3];
+            if (!parseFloats(begin + 10, end, domain, 3))
+                return false;
+            maxX = domain[0];
+            maxY = domain[1];
+            maxZ = domain[2];
+            return true;
+        }
+        if ((*begin >= '0' && *begin <= '9') || *begin == '-' || *begin == '+' || *begin == '.')
+        {
+            float color[3];
+            if (!parseFloats(begin, end, color, 3))
+                return false;
+            if (currentPoint >= (size_t) size * size * size)
+                return true; // more points than LUT_3D_SIZE says, ignore like before
+
+            float* point = &colorCube[currentPoint * 4];
+            point[0]     = color[0] / (maxX - minX);
+            point[1]     = color[1] / (maxY - minY);
+            point[2]     = color[2] / (maxZ - minZ);
+            currentPoint++;
+            return true;
+        }
+
+        // TITLE, LUT_1D_SIZE and other keywords
+        return true;
+    }
+
+    std::vector<unsigned char> LutCube::toUNORM8() const
+    {
+        std::vector<unsigned char> texels(colorCube.size());
+        for (size_t i = 0; i < colorCube.size(); i++)
+            texels[i] = (unsigned char) std::lround(std::clamp(colorCube[i], 0.0f, 1.0f) * 255.0f);
+        return texels;
     }
 
-    void LutCube::splitTripel(std::string tripel, float& x, float& y, float& z)
+    std::vector<uint16_t> LutCube::toFloat16() const
     {
-        tripel       = skipWhiteSpace(tripel);
-        size_t after = tripel.find_first_of(" \n");
-        x            = std::stof(tripel.substr(0, after));
-        tripel       = tripel.substr(after);
-
-        tripel = skipWhiteSpace(tripel);
-        after  = tripel.find_first_of(" \n");
-        y      = std::stof(tripel.substr(0, after));
-        tripel = tripel.substr(after);
-
-        tripel = skipWhiteSpace(tripel);
-        z      = std::stof(tripel);
+        std::vector<uint16_t> texels(colorCube.size());
+        for (size_t i = 0; i < colorCube.size(); i++)
+            texels[i] = floatToHalf(colorCube[i]);
+        return texels;
     }
 
-    void LutCube::clampTripel(float x, float y, float z, unsigned char& outX, unsigned char& outY, unsigned char& outZ)
+    bool LutCube::loadCache(const std::string& cacheFile, int64_t mtime, uint64_t fileSize)
     {
-        outX = (unsigned char) 255 * (x / (maxX - minX));
-        outY = (unsigned char) 255 * (y / (maxY - minY));
-        outZ = (unsigned char) 255 * (z / (maxZ - minZ));
+        std::ifstream cache(cacheFile, std::ios::binary);
+        if (!cache.good())
+            return false;
+
+        CacheHeader header;
+        if (!cache.read(reinterpret_cast<char*>(&header), sizeof(header)))
+            return false;
+        if (std::memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) != 0 || header.mtime != mtime || header.fileSize != fileSize
+            || header.size < 2 || header.size > 256)
+            return false;
+
+        std::vector<float> cube((size_t) header.size * header.size * header.size * 4);
+        if (!cache.read(reinterpret_cast<char*>(cube.data()), cube.size() * sizeof(float)))
+            return false;
+
+        size      = header.size;
+        colorCube = std::move(cube);
+        return true;
     }
 
-    void LutCube::writeColor(int x, int y, int z, unsigned char r, unsigned char g, unsigned char b)
+    void LutCube::saveCache(const std::string& cacheFile, int64_t mtime, uint64_t fileSize) const
     {
-        static const int colorSize = 4; // 4 bytes per point in the cube, rgba
+        std::error_code ec;
+        std::filesystem::create_directories(std::filesystem::path(cacheFile).parent_path(), ec);
 
-        int locationR = (((z * size) + y) * size + x) * colorSize;
+        CacheHeader header = {};
+        std::memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+        header.mtime    = mtime;
+        header.fileSize = fileSize;
+        header.size     = size;
 
-        colorCube[locationR + 0] = r;
-        colorCube[locationR + 1] = g;
-        colorCube[locationR + 2] = b;
+        // write to a temporary file first so a crash never leaves a truncated cache behind,
+        // its name is unique so other processes and threads writing the same cache don't interleave
+        std::string tempFile = cacheFile + "." + std::to_string(getpid()) + "."
+                             + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + ".tmp";
+        {
+            std::ofstream cache(tempFile, std::ios::binary | std::ios::trunc);
+            cache.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            cache.write(reinterpret_cast<const char*>(colorCube.data()), colorCube.size() * sizeof(float));
+            if (!cache.good())
+            {
+                Logger::warn("could not write lut cache " + tempFile);
+                std::filesystem::remove(tempFile, ec);
+                return;
+            }
+        }
+        std::filesystem::rename(tempFile, cacheFile, ec);
+        if (ec)
+        {
+            Logger::warn("could not write lut cache " + cacheFile);
+            std::filesystem::remove(tempFile, ec);
+        }
     }
 } // namespace vkBasalt
@@ -8,32 +8,38 @@
 #include <vector>
 #include <unordered_map>
 #include <cstdlib>
+#include <cstdint>
 
 namespace vkBasalt
 {
     /*
        reads .cube files
-       returns a vector of bytes
-       one byte is one color value
-       4 bytes stand for rgba
-       the alpha value is always 255
+       colorCube holds 4 floats (rgba) per point, alpha is always 1,
+       red changes fastest, then green, then blue (the order of the file)
 
        size will be set according to the size in the file, which can be in [2,256]
        the cube will have the dimentions size * size * size
 
-       so the vector will have a length of size*size*size*4
+       so the vector will have a length of size*size*size*4, size is 0 if the file could not be read
+
+       The parsed cube is cached in $XDG_CACHE_HOME/vkBasalt-overlay/lut, keyed by path, mtime and file size.
 
        See: https://wwwimages2.adobe.com/content/dam/acom/en/products/speedgrade/cc/pdfs/cube-lut-specification-1.0.pdf
     */
     class LutCube
     {
     public:
-        std::vector<unsigned char> colorCube;
-        int                        size;
+        std::vector<float> colorCube;
+        int                size = 0;
 
         LutCube(const std::string& file);
         LutCube();
 
+        // texel data for VK_FORMAT_R8G8B8A8_UNORM
+        std::vector<unsigned char> toUNORM8() const;
+        // texel data for VK_FORMAT_R16G16B16A16_SFLOAT
+        std::vector<uint16_t> toFloat16() const;
+
     private:
         float minX = 0.0f;
         float minY = 0.0f;
@@ -43,21 +49,13 @@ namespace vkBasalt
         float maxY = 1.0f;
         float maxZ = 1.0f;
 
-        int currentX = 0;
-        int currentY = 0;
-        int currentZ = 0;
-
-        void writeColor(int x, int y, int z, unsigned char r, unsigned char g, unsigned char b);
-
-        void parseLine(std::string line);
-
-        // splits a tripel of floats
-        void splitTripel(std::string tripel, float& x, float& y, float& z);
+        size_t currentPoint = 0;
 
-        void clampTripel(float x, float y, float z, unsigned char& outX, unsigned char& outY, unsigned char& outZ);
+        bool parse(const char* data, size_t length);
+        bool parseLine(const char* begin, const char* end);
 
-        // returns the text without leading whitespace
-        std::string skipWhiteSpace(std::string text);
+        bool loadCache(const std::string& cacheFile, int64_t mtime, uint64_t fileSize);
+        void saveCache(const std::string& cacheFile, int64_t mtime, uint64_t fileSize) const;
     };
 
 } // namespace vkBasalt
@@ -2,6 +2,11 @@
 
 namespace vkBasalt
 {
+    namespace
+    {
+        thread_local std::string currentOwner = "vkBasalt";
+    }
+
     uint32_t findMemoryTypeIndex(LogicalDevice* pLogicalDevice, uint32_t typeFilter, VkMemoryPropertyFlags properties)
     {
         VkPhysicalDeviceMemoryProperties physicalDeviceMemoryProperties;
@@ -17,4 +22,61 @@ namespace vkBasalt
         Logger::err("Found no correct memory type");
         return 0x70AD;
     }
+
+    VkResult allocateMemory(LogicalDevice* pLogicalDevice, const VkMemoryAllocateInfo* pAllocateInfo, VkDeviceMemory* pMemory)
+    {
+        VkResult result = pLogicalDevice->vkd.AllocateMemory(pLogicalDevice->device, pAllocateInfo, nullptr, pMemory);
+        if (result == VK_SUCCESS)
+            pLogicalDevice->memoryTracker.add(*pMemory, currentOwner, pAllocateInfo->allocationSize);
+        return result;
+    }
+
+    void freeMemory(LogicalDevice* pLogicalDevice, VkDeviceMemory memory)
+    {
+        if (memory == VK_NULL_HANDLE)
+            return;
+        pLogicalDevice->memoryTracker.remove(memory);
+        pLogicalDevice->vkd.FreeMemory(pLogicalDevice->device, memory, nullptr);
+    }
+
+    MemoryOwnerScope::MemoryOwnerScope(const std::string& owner) : previousOwner(currentOwner)
+    {
+        currentOwner = owner;
+    }
+
+    MemoryOwnerScope::~MemoryOwnerScope()
+    {
+        currentOwner = previousOwner;
+    }
+
+    const std::string& MemoryOwnerScope::current()
+    {
+        return currentOwner;
+    }
+
+    bool getDeviceLocalBudget(LogicalDevice* pLogicalDevice, VkDeviceSize& usage, VkDeviceSize& budget)
+    {
+        if (!pLogicalDevice->supportsMemoryBudget || !pLogicalDevice->vki.GetPhysicalDeviceMemoryProperties2)
+            return false;
+
+        VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties = {};
+        budgetProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+        VkPhysicalDeviceMemoryProperties2 memoryProperties = {};
+        memoryProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+        memoryProperties.pNext = &budgetProperties;
+
+        pLogicalDevice->vki.GetPhysicalDeviceMemoryProperties2(pLogicalDevice->physicalDevice, &memoryProperties);
+
+        usage  = 0;
+        budget = 0;
+        for (uint32_t i = 0; i < memoryProperties.memoryProperties.memoryHeapCount; i++)
+        {
+            if (!(memoryProperties.memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT))
+                continue;
+            usage += budgetProperties.heapUsage[i];
+            budget += budgetProperties.heapBudget[i];
+        }
+        return budget > 0;
+    }
 } // namespace vkBasalt
@@ -14,6 +14,28 @@
 namespace vkBasalt
 {
     uint32_t findMemoryTypeIndex(LogicalDevice* pLogicalDevice, uint32_t typeFilter, VkMemoryPropertyFlags properties);
-}
+
+    // All device memory of the layer goes through these two, so that it can be attributed
+    // to the owner set by the innermost MemoryOwnerScope on the calling thread
+    VkResult allocateMemory(LogicalDevice* pLogicalDevice, const VkMemoryAllocateInfo* pAllocateInfo, VkDeviceMemory* pMemory);
+    void     freeMemory(LogicalDevice* pLogicalDevice, VkDeviceMemory memory);
+
+    // Sets the owner name for allocations on this thread until it goes out of scope
+    class MemoryOwnerScope
+    {
+    public:
+        explicit MemoryOwnerScope(const std::string& owner);
+        ~MemoryOwnerScope();
+
+        static const std::string& current();
+
+    private:
+        std::string previousOwner;
+    };
+
+    // Usage and budget of all device local heaps, from VK_EXT_memory_budget
+    // returns false if the extension is not supported
+    bool getDeviceLocalBudget(LogicalDevice* pLogicalDevice, VkDeviceSize& usage, VkDeviceSize& budget);
+} // namespace vkBasalt
 
 #endif // MEMORY_HPP_INCLUDED
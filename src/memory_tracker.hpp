@@ -0,0 +1,75 @@
+#ifndef MEMORY_TRACKER_HPP_INCLUDED
+#define MEMORY_TRACKER_HPP_INCLUDED
+#include <string>
+#include <map>
+#include <unordered_map>
+#include <mutex>
+
+#include "vulkan_include.hpp"
+
+namespace vkBasalt
+{
+    // Book-keeping of every VkDeviceMemory allocated by the layer, grouped by owner
+    // (effect instance name, "Swapchain", "Overlay", ...).
+    // Filled by allocateMemory()/freeMemory() in memory.cpp, read by the overlay.
+    class MemoryTracker
+    {
+    public:
+        void add(VkDeviceMemory memory, const std::string& owner, VkDeviceSize size)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            allocations[memory] = {owner, size};
+            ownerBytes[owner] += size;
+            totalBytes += size;
+        }
+
+        void remove(VkDeviceMemory memory)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = allocations.find(memory);
+            if (it == allocations.end())
+                return;
+
+            auto owner = ownerBytes.find(it->second.owner);
+            owner->second -= it->second.size;
+            if (owner->second == 0)
+                ownerBytes.erase(owner);
+            totalBytes -= it->second.size;
+            allocations.erase(it);
+        }
+
+        VkDeviceSize getTotalBytes() const
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return totalBytes;
+        }
+
+        VkDeviceSize getOwnerBytes(const std::string& owner) const
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = ownerBytes.find(owner);
+            return it != ownerBytes.end() ? it->second : 0;
+        }
+
+        // Snapshot of owner -> bytes (for UI)
+        std::map<std::string, VkDeviceSize> getAllOwnerBytes() const
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return ownerBytes;
+        }
+
+    private:
+        struct Allocation
+        {
+            std::string  owner;
+            VkDeviceSize size;
+        };
+
+        mutable std::mutex                             mutex;
+        std::unordered_map<VkDeviceMemory, Allocation> allocations;
+        std::map<std::string, VkDeviceSize>            ownerBytes;
+        VkDeviceSize                                   totalBytes = 0;
+    };
+} // namespace vkBasalt
+
+#endif // MEMORY_TRACKER_HPP_INCLUDED
@@ -10,35 +10,60 @@ namespace vkBasalt
     static int xiOpcode = 0;
     static float scrollAccumulator = 0.0f;
 
-    MouseState getMouseState()
+    // Initialize X11 and XInput2 once, returns null without an X display
+    static Display* initMouseX11()
     {
-        MouseState state;
+        if (display)
+            return display;
 
-        // Initialize X11 and XInput2 once
-        if (!display)
-        {
-            const char* disVar = getenv("DISPLAY");
-            if (!disVar || !*disVar)
-                return state;
+        const char* disVar = getenv("DISPLAY");
+        if (!disVar || !*disVar)
+            return nullptr;
 
-            display = XOpenDisplay(disVar);
-            if (!display)
-                return state;
+        display = XOpenDisplay(disVar);
+        if (!display)
+            return nullptr;
 
-            int event, error;
-            if (XQueryExtension(display, "XInputExtension", &xiOpcode, &event, &error))
+        int event, error;
+        if (XQueryExtension(display, "XInputExtension", &xiOpcode, &event, &error))
+        {
+            int major = 2, minor = 0;
+            if (XIQueryVersion(display, &major, &minor) == Success)
             {
-                int major = 2, minor = 0;
-                if (XIQueryVersion(display, &major, &minor) == Success)
-                {
-                    unsigned char mask[XIMaskLen(XI_RawButtonPress)] = {0};
-                    XISetMask(mask, XI_RawButtonPress);
+                unsigned char mask[XIMaskLen(XI_RawButtonPress)] = {0};
+                XISetMask(mask, XI_RawButtonPress);
 
-                    XIEventMask eventMask = {XIAllMasterDevices, sizeof(mask), mask};
-                    XISelectEvents(display, DefaultRootWindow(display), &eventMask, 1);
-                }
+                XIEventMask eventMask = {XIAllMasterDevices, sizeof(mask), mask};
+                XISelectEvents(display, DefaultRootWindow(display), &eventMask, 1);
             }
         }
+        return display;
+    }
+
+    // Pointer position relative to the focused window and button state
+    static void queryPointer(MouseState& state)
+    {
+        Window focused, root, child;
+        int revertTo, rootX, rootY;
+        unsigned int mask;
+
+        XGetInputFocus(display, &focused, &revertTo);
+        if (focused == None || focused == PointerRoot)
+            focused = DefaultRootWindow(display);
+
+        if (XQueryPointer(display, focused, &root, &child, &rootX, &rootY, &state.x, &state.y, &mask))
+        {
+            state.leftButton = mask & Button1Mask;
+            state.middleButton = mask & Button2Mask;
+            state.rightButton = mask & Button3Mask;
+        }
+    }
+
+    MouseState getMouseState()
+    {
+        MouseState state;
+        if (!initMouseX11())
+            return state;
 
         // Process scroll events
         while (XPending(display) > 0)
@@ -58,25 +83,19 @@ namespace vkBasalt
             }
         }
 
-        // Get pointer state
-        Window focused, root, child;
-        int revertTo, rootX, rootY;
-        unsigned int mask;
-
-        XGetInputFocus(display, &focused, &revertTo);
-        if (focused == None || focused == PointerRoot)
-            focused = DefaultRootWindow(display);
-
-        if (XQueryPointer(display, focused, &root, &child, &rootX, &rootY, &state.x, &state.y, &mask))
-        {
-            state.leftButton = mask & Button1Mask;
-            state.middleButton = mask & Button2Mask;
-            state.rightButton = mask & Button3Mask;
-        }
+        queryPointer(state);
 
         state.scrollDelta = scrollAccumulator;
         scrollAccumulator = 0.0f;
         return state;
     }
 
+    MouseState getPointerState()
+    {
+        MouseState state;
+        if (initMouseX11())
+            queryPointer(state);
+        return state;
+    }
+
 } // namespace vkBasalt
@@ -17,6 +17,9 @@ namespace vkBasalt
 
     MouseState getMouseState();
 
+    // Position and buttons only, leaves pending scroll events for getMouseState()
+    MouseState getPointerState();
+
 } // namespace vkBasalt
 
 #endif // MOUSE_INPUT_HPP_INCLUDED
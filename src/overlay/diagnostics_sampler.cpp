@@ -0,0 +1,237 @@
+#include "diagnostics_sampler.hpp"
+#include "logger.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+namespace vkBasalt
+{
+    namespace
+    {
+        // How often the background thread reads the GPU counters
+        constexpr std::chrono::milliseconds sampleInterval(200);
+
+        // Find the DRM card path for GPU stats
+        std::string findDrmCard()
+        {
+            try
+            {
+                for (const auto& entry : std::filesystem::directory_iterator("/sys/class/drm"))
+                {
+                    std::string name = entry.path().filename().string();
+                    if (name.find("card") == 0 && name.find("-") == std::string::npos)
+                    {
+                        std::string devicePath = entry.path().string() + "/device";
+                        // Check if this card has GPU busy percentage
+                        if (std::filesystem::exists(devicePath + "/gpu_busy_percent"))
+                            return entry.path().string();
+                    }
+                }
+            }
+            catch (...) {}
+            return "";
+        }
+
+        int openSysfs(const std::string& path)
+        {
+            return open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        }
+
+        // sysfs attributes can be re-read from offset 0 without reopening the file
+        bool readSysfs(int fd, uint64_t& value)
+        {
+            if (fd < 0)
+                return false;
+            char    buffer[32];
+            ssize_t length = pread(fd, buffer, sizeof(buffer) - 1, 0);
+            if (length <= 0)
+                return false;
+            buffer[length] = '\0';
+            char* end;
+            value = std::strtoull(buffer, &end, 10);
+            return end != buffer;
+        }
+
+        bool readUsage(int usedFd, int totalFd, float& usedMB, float& totalMB)
+        {
+            uint64_t used = 0, total = 0;
+            if (!readSysfs(usedFd, used) || !readSysfs(totalFd, total) || total == 0)
+                return false;
+            usedMB  = static_cast<float>(used) / (1024.0f * 1024.0f);
+            totalMB = static_cast<float>(total) / (1024.0f * 1024.0f);
+            return true;
+        }
+    } // namespace
+
+    int FrameTimeHistogram::bucketIndex(float frameTimeMs)
+    {
+        if (frameTimeMs < minMs)
+            return 0;
+        // frameTimeMs / minMs = mantissa * 2^exponent with mantissa in [0.5, 1)
+        int   exponent;
+        float mantissa = std::frexp(frameTimeMs / minMs, &exponent);
+        int   octave   = exponent - 1;
+        if (octave >= octaves)
+            return subBuckets * octaves - 1;
+        int sub = static_cast<int>((mantissa * 2.0f - 1.0f) * subBuckets);
+        return octave * subBuckets + std::min(sub, subBuckets - 1);
+    }
+
+    float FrameTimeHistogram::bucketValue(int index)
+    {
+        int octave = index / subBuckets;
+        int sub    = index % subBuckets;
+        return std::ldexp(minMs, octave) * (1.0f + (sub + 0.5f) / subBuckets);
+    }
+
+    void FrameTimeHistogram::record(float frameTimeMs)
+    {
+        buckets[bucketIndex(frameTimeMs)]++;
+        totalCount++;
+        totalMs += frameTimeMs;
+        maxFrameMs = std::max(maxFrameMs, frameTimeMs);
+
+        if (recentAvg > 0.0f && frameTimeMs > 2.0f * recentAvg)
+            stutters++;
+        recentAvg = recentAvg > 0.0f ? recentAvg * 0.95f + frameTimeMs * 0.05f : frameTimeMs;
+    }
+
+    void FrameTimeHistogram::reset()
+    {
+        *this = FrameTimeHistogram();
+    }
+
+    float FrameTimeHistogram::quantile(double q) const
+    {
+        if (totalCount == 0)
+            return 0.0f;
+
+        uint64_t target     = static_cast<uint64_t>(std::ceil(q * totalCount));
+        uint64_t cumulative = 0;
+        for (int i = 0; i < static_cast<int>(buckets.size()); i++)
+        {
+            cumulative += buckets[i];
+            if (cumulative >= target && cumulative > 0)
+                return std::min(bucketValue(i), maxFrameMs);
+        }
+        return maxFrameMs;
+    }
+
+    void FrameStats::recordPresent()
+    {
+        auto now = std::chrono::steady_clock::now();
+        if (lastPresent != std::chrono::steady_clock::time_point())
+        {
+            float frameTimeMs = std::chrono::duration<float, std::milli>(now - lastPresent).count();
+            // Skip huge gaps (loading screens, paused games) so they don't skew the session
+            if (frameTimeMs > 0.0f && frameTimeMs < 1000.0f)
+            {
+                histogram.record(frameTimeMs);
+                history.push(frameTimeMs);
+            }
+        }
+        lastPresent = now;
+    }
+
+    DiagnosticsSampler::DiagnosticsSampler()
+    {
+        drmCardPath = findDrmCard();
+        if (drmCardPath.empty())
+        {
+            Logger::info("Diagnostics: No GPU sysfs interface found");
+            return;
+        }
+        Logger::info("Diagnostics: Found GPU at " + drmCardPath);
+
+        std::string devicePath = drmCardPath + "/device/";
+        gpuBusyFd   = openSysfs(devicePath + "gpu_busy_percent");
+        vramUsedFd  = openSysfs(devicePath + "mem_info_vram_used");
+        vramTotalFd = openSysfs(devicePath + "mem_info_vram_total");
+        gttUsedFd   = openSysfs(devicePath + "mem_info_gtt_used");
+        gttTotalFd  = openSysfs(devicePath + "mem_info_gtt_total");
+
+        thread = std::thread(&DiagnosticsSampler::run, this);
+    }
+
+    DiagnosticsSampler::~DiagnosticsSampler()
+    {
+        if (thread.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(stopMutex);
+                stopRequested = true;
+            }
+            stopCondition.notify_one();
+            thread.join();
+        }
+
+        for (int fd : {gpuBusyFd, vramUsedFd, vramTotalFd, gttUsedFd, gttTotalFd})
+        {
+            if (fd >= 0)
+                close(fd);
+        }
+    }
+
+    void DiagnosticsSampler::run()
+    {
+        // Only run when the CPU would otherwise be idle, never compete with the game
+        sched_param param = {};
+        pthread_setschedparam(pthread_self(), SCHED_IDLE, &param);
+        pthread_setname_np(pthread_self(), "vkBasalt-diag");
+
+        std::unique_lock<std::mutex> lock(stopMutex);
+        while (!stopRequested)
+        {
+            lock.unlock();
+            sample();
+            lock.lock();
+            stopCondition.wait_for(lock, sampleInterval, [this] { return stopRequested; });
+        }
+    }
+
+    void DiagnosticsSampler::sample()
+    {
+        uint64_t busy = 0;
+        if (readSysfs(gpuBusyFd, busy))
+        {
+            gpuUsage.store(static_cast<float>(busy), std::memory_order_relaxed);
+            gpuUsageHistory.push(static_cast<float>(busy));
+        }
+
+        float used, total;
+        if (readUsage(vramUsedFd, vramTotalFd, used, total))
+        {
+            vramUsedMB.store(used, std::memory_order_relaxed);
+            vramTotalMB.store(total, std::memory_order_relaxed);
+            vramUsageHistory.push(used / total * 100.0f);
+        }
+
+        if (readUsage(gttUsedFd, gttTotalFd, used, total))
+        {
+            gttUsedMB.store(used, std::memory_order_relaxed);
+            gttTotalMB.store(total, std::memory_order_relaxed);
+            gttUsageHistory.push(used / total * 100.0f);
+        }
+    }
+
+    bool DiagnosticsSampler::getVramUsage(float& usedMB, float& totalMB) const
+    {
+        usedMB  = vramUsedMB.load(std::memory_order_relaxed);
+        totalMB = vramTotalMB.load(std::memory_order_relaxed);
+        return totalMB > 0.0f;
+    }
+
+    bool DiagnosticsSampler::getGttUsage(float& usedMB, float& totalMB) const
+    {
+        usedMB  = gttUsedMB.load(std::memory_order_relaxed);
+        totalMB = gttTotalMB.load(std::memory_order_relaxed);
+        return totalMB > 0.0f;
+    }
+
+} // namespace vkBasalt
@@ -0,0 +1,158 @@
+#ifndef DIAGNOSTICS_SAMPLER_HPP_INCLUDED
+#define DIAGNOSTICS_SAMPLER_HPP_INCLUDED
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace vkBasalt
+{
+    // Min/avg/max of a history, gathered in the same pass that copies it for plotting
+    struct HistoryStats
+    {
+        float min = 0.0f;
+        float avg = 0.0f;
+        float max = 0.0f;
+    };
+
+    // Fixed size history with a single writer and any number of readers, no locks.
+    // Readers may see a sample that is overwritten while copying, which is fine for graphs.
+    template<size_t N>
+    class SampleRing
+    {
+    public:
+        void push(float value)
+        {
+            size_t written = writeCount.load(std::memory_order_relaxed);
+            data[written % N].store(value, std::memory_order_relaxed);
+            writeCount.store(written + 1, std::memory_order_release);
+        }
+
+        size_t size() const { return std::min(writeCount.load(std::memory_order_acquire), N); }
+        static constexpr size_t capacity() { return N; }
+
+        // Copies the history oldest first, returns the number of samples copied
+        size_t copyTo(float* out, HistoryStats& stats) const
+        {
+            size_t written = writeCount.load(std::memory_order_acquire);
+            size_t count   = std::min(written, N);
+            stats          = {};
+            float sum      = 0.0f;
+            for (size_t i = 0; i < count; i++)
+            {
+                float v   = data[(written - count + i) % N].load(std::memory_order_relaxed);
+                out[i]    = v;
+                stats.min = i ? std::min(stats.min, v) : v;
+                stats.max = i ? std::max(stats.max, v) : v;
+                sum += v;
+            }
+            if (count)
+                stats.avg = sum / static_cast<float>(count);
+            return count;
+        }
+
+    private:
+        std::array<std::atomic<float>, N> data = {};
+        std::atomic<size_t>               writeCount{0};
+    };
+
+    // Streaming frame time distribution over the whole session.
+    // Log-linear buckets (HDR histogram style): 32 sub-buckets per power of two from 1/16 ms
+    // up to ~4 s, so every quantile is within ~3% and costs a fixed 512 bucket walk.
+    class FrameTimeHistogram
+    {
+    public:
+        void record(float frameTimeMs);
+        void reset();
+
+        // Frame time in ms below which the fraction q of all frames lie
+        float quantile(double q) const;
+
+        uint64_t count() const { return totalCount; }
+        float    mean() const { return totalCount ? static_cast<float>(totalMs / totalCount) : 0.0f; }
+        float    maxMs() const { return maxFrameMs; }
+
+        // Exponential moving average over roughly the last 20 frames
+        float recentAverage() const { return recentAvg; }
+
+        // Frames that took more than twice the recent average
+        uint64_t stutterCount() const { return stutters; }
+
+    private:
+        static constexpr int   subBuckets = 32;
+        static constexpr int   octaves    = 16;
+        static constexpr float minMs      = 1.0f / 16.0f;
+
+        static int   bucketIndex(float frameTimeMs);
+        static float bucketValue(int index);
+
+        std::array<uint64_t, subBuckets * octaves> buckets = {};
+
+        uint64_t totalCount = 0;
+        double   totalMs    = 0.0;
+        float    maxFrameMs = 0.0f;
+        float    recentAvg  = 0.0f;
+        uint64_t stutters   = 0;
+    };
+
+    // Present-thread frame statistics, fed from ImGuiOverlay::recordFrame on every present
+    struct FrameStats
+    {
+        FrameTimeHistogram                    histogram;
+        SampleRing<300>                       history;  // ~5 seconds at 60fps, for the graph
+        std::chrono::steady_clock::time_point lastPresent;
+
+        void recordPresent();
+    };
+
+    // Samples GPU counters from sysfs on a low priority background thread,
+    // so the present thread never blocks on file IO
+    class DiagnosticsSampler
+    {
+    public:
+        DiagnosticsSampler();
+        ~DiagnosticsSampler();
+
+        const std::string& getDrmCardPath() const { return drmCardPath; }
+
+        // Latest values, negative if not available
+        float getGpuUsage() const { return gpuUsage.load(std::memory_order_relaxed); }
+        bool  getVramUsage(float& usedMB, float& totalMB) const;
+        bool  getGttUsage(float& usedMB, float& totalMB) const;
+
+        SampleRing<300> gpuUsageHistory;
+        SampleRing<300> vramUsageHistory;
+        SampleRing<300> gttUsageHistory;  // Shared memory for iGPUs
+
+    private:
+        void run();
+        void sample();
+
+        std::string drmCardPath;
+        int         gpuBusyFd   = -1;
+        int         vramUsedFd  = -1;
+        int         vramTotalFd = -1;
+        int         gttUsedFd   = -1;
+        int         gttTotalFd  = -1;
+
+        std::atomic<float> gpuUsage{-1.0f};
+        std::atomic<float> vramUsedMB{-1.0f};
+        std::atomic<float> vramTotalMB{-1.0f};
+        std::atomic<float> gttUsedMB{-1.0f};
+        std::atomic<float> gttTotalMB{-1.0f};
+
+        std::mutex              stopMutex;
+        std::condition_variable stopCondition;
+        bool                    stopRequested = false;
+        std::thread             thread;
+    };
+
+} // namespace vkBasalt
+
+#endif // DIAGNOSTICS_SAMPLER_HPP_INCLUDED
@@ -6,10 +6,13 @@
 #include "keyboard_input.hpp"
 #include "input_blocker.hpp"
 #include "config_serializer.hpp"
+#include "memory.hpp"
 
 #include <algorithm>
 #include <cmath>
 #include <fstream>
+#include <mutex>
+#include <unordered_map>
 
 #include "imgui/imgui.h"
 #include "imgui/imgui_internal.h"
@@ -20,17 +23,81 @@ namespace vkBasalt
     // Dummy function for Vulkan functions not in vkBasalt's dispatch
     static void dummyVulkanFunc() {}
 
+    // ImGui's own buffers and font image go through the layer's memory hook, tagged as "Overlay".
+    // ImGui's function pointers are shared by all devices, so the hooks find the LogicalDevice from their VkDevice
+    struct OverlayMemoryDevice
+    {
+        LogicalDevice* pLogicalDevice;
+        uint32_t       overlayCount;
+    };
+
+    static std::mutex                                        overlayMemoryLock;
+    static std::unordered_map<VkDevice, OverlayMemoryDevice> overlayMemoryDevices;
+
+    static LogicalDevice* getOverlayMemoryDevice(VkDevice device)
+    {
+        std::lock_guard<std::mutex> lock(overlayMemoryLock);
+        auto it = overlayMemoryDevices.find(device);
+        return it != overlayMemoryDevices.end() ? it->second.pLogicalDevice : nullptr;
+    }
+
+    static void addOverlayMemoryDevice(LogicalDevice* pLogicalDevice)
+    {
+        std::lock_guard<std::mutex> lock(overlayMemoryLock);
+        OverlayMemoryDevice& entry = overlayMemoryDevices[pLogicalDevice->device];
+        entry.pLogicalDevice = pLogicalDevice;
+        entry.overlayCount++;
+    }
+
+    static void removeOverlayMemoryDevice(LogicalDevice* pLogicalDevice)
+    {
+        std::lock_guard<std::mutex> lock(overlayMemoryLock);
+        auto it = overlayMemoryDevices.find(pLogicalDevice->device);
+        if (it != overlayMemoryDevices.end() && --it->second.overlayCount == 0)
+            overlayMemoryDevices.erase(it);
+    }
+
+    static VKAPI_ATTR VkResult VKAPI_CALL overlayAllocateMemory(VkDevice device, const VkMemoryAllocateInfo* pAllocateInfo,
+                                                                const VkAllocationCallbacks*, VkDeviceMemory* pMemory)
+    {
+        LogicalDevice* pLogicalDevice = getOverlayMemoryDevice(device);
+        if (!pLogicalDevice)
+        {
+            Logger::err("overlay memory allocation on an unknown device");
+            return VK_ERROR_INITIALIZATION_FAILED;
+        }
+
+        MemoryOwnerScope owner("Overlay");
+        return allocateMemory(pLogicalDevice, pAllocateInfo, pMemory);
+    }
+
+    static VKAPI_ATTR void VKAPI_CALL overlayFreeMemory(VkDevice device, VkDeviceMemory memory, const VkAllocationCallbacks*)
+    {
+        LogicalDevice* pLogicalDevice = getOverlayMemoryDevice(device);
+        if (!pLogicalDevice)
+        {
+            Logger::err("overlay memory free on an unknown device");
+            return;
+        }
+
+        freeMemory(pLogicalDevice, memory);
+    }
+
     // Function loader using vkBasalt's dispatch tables
     static PFN_vkVoidFunction imguiVulkanLoaderDummy(const char* function_name, void* user_data)
     {
         LogicalDevice* device = static_cast<LogicalDevice*>(user_data);
 
+        if (strcmp(function_name, "vkAllocateMemory") == 0)
+            return (PFN_vkVoidFunction)overlayAllocateMemory;
+        if (strcmp(function_name, "vkFreeMemory") == 0)
+            return (PFN_vkVoidFunction)overlayFreeMemory;
+
         // Device functions from vkBasalt's dispatch table
         #define CHECK_FUNC(name) if (strcmp(function_name, "vk" #name) == 0) return (PFN_vkVoidFunction)device->vkd.name
 
         CHECK_FUNC(AllocateCommandBuffers);
         CHECK_FUNC(AllocateDescriptorSets);
-        CHECK_FUNC(AllocateMemory);
         CHECK_FUNC(BeginCommandBuffer);
         CHECK_FUNC(BindBufferMemory);
         CHECK_FUNC(BindImageMemory);
@@ -80,7 +147,6 @@ namespace vkBasalt
         CHECK_FUNC(FlushMappedMemoryRanges);
         CHECK_FUNC(FreeCommandBuffers);
         CHECK_FUNC(FreeDescriptorSets);
-        CHECK_FUNC(FreeMemory);
         CHECK_FUNC(GetBufferMemoryRequirements);
         CHECK_FUNC(GetDeviceQueue);
         CHECK_FUNC(GetImageMemoryRequirements);
@@ -109,7 +175,24 @@ namespace vkBasalt
     }
 
     ImGuiOverlay::ImGuiOverlay(LogicalDevice* device, VkFormat swapchainFormat, uint32_t imageCount, OverlayPersistentState* persistentState)
-        : pLogicalDevice(device), pPersistentState(persistentState)
+        : pLogicalDevice(device), pPersistentState(persistentState), swapchainFormat(swapchainFormat), imageCount(imageCount)
+    {
+        // Restore UI preferences from persistent state
+        if (pPersistentState)
+            visible = pPersistentState->visible;
+
+        // ImGui and its Vulkan objects wait until the overlay is shown
+        initialized = true;
+    }
+
+    ImGuiOverlay::~ImGuiOverlay()
+    {
+        if (!initialized) return;
+
+        releaseImGui();
+    }
+
+    void ImGuiOverlay::initImGui()
     {
         IMGUI_CHECKVERSION();
         ImGui::CreateContext();
@@ -140,38 +223,53 @@ namespace vkBasalt
 
         initVulkanBackend(swapchainFormat, imageCount);
 
-        // Restore UI preferences from persistent state
-        if (pPersistentState)
-            visible = pPersistentState->visible;
-
-        initialized = true;
+        imguiInitialized = true;
         Logger::info("ImGui overlay initialized");
     }
 
-    ImGuiOverlay::~ImGuiOverlay()
+    void ImGuiOverlay::releaseImGui()
     {
-        if (!initialized) return;
+        if (!imguiInitialized)
+            return;
 
-        pLogicalDevice->vkd.QueueWaitIdle(pLogicalDevice->queue);
+        // Only our own submits use the command buffers, their fences are enough
+        std::vector<VkFence> fences;
+        for (auto fence : commandBufferFences)
+        {
+            if (fence != VK_NULL_HANDLE)
+                fences.push_back(fence);
+        }
+        if (!fences.empty())
+            pLogicalDevice->vkd.WaitForFences(pLogicalDevice->device, fences.size(), fences.data(), VK_TRUE, UINT64_MAX);
 
         std::string iniPath = ConfigSerializer::getBaseConfigDir() + "/imgui.ini";
         ImGui::SaveIniSettingsToDisk(iniPath.c_str());
 
         if (backendInitialized)
+        {
             ImGui_ImplVulkan_Shutdown();
+            removeOverlayMemoryDevice(pLogicalDevice);
+        }
         ImGui::DestroyContext();
+        backendInitialized = false;
+        imguiInitialized   = false;
 
-        for (auto fence : commandBufferFences)
-        {
-            if (fence != VK_NULL_HANDLE)
-                pLogicalDevice->vkd.DestroyFence(pLogicalDevice->device, fence, nullptr);
-        }
+        for (auto fence : fences)
+            pLogicalDevice->vkd.DestroyFence(pLogicalDevice->device, fence, nullptr);
+        commandBufferFences.clear();
         if (commandPool != VK_NULL_HANDLE)
             pLogicalDevice->vkd.DestroyCommandPool(pLogicalDevice->device, commandPool, nullptr);
+        commandPool = VK_NULL_HANDLE;
+        commandBuffers.clear();
         if (renderPass != VK_NULL_HANDLE)
             pLogicalDevice->vkd.DestroyRenderPass(pLogicalDevice->device, renderPass, nullptr);
+        renderPass = VK_NULL_HANDLE;
         if (descriptorPool != VK_NULL_HANDLE)
             pLogicalDevice->vkd.DestroyDescriptorPool(pLogicalDevice->device, descriptorPool, nullptr);
+        descriptorPool = VK_NULL_HANDLE;
+
+        // The GPU counters are only shown in the overlay, the tab starts them again
+        diagnosticsSampler.reset();
 
         Logger::info("ImGui overlay destroyed");
     }
@@ -179,6 +277,8 @@ namespace vkBasalt
     void ImGuiOverlay::toggle()
     {
         visible = !visible;
+        if (!visible)
+            hiddenSince = std::chrono::steady_clock::now();
         setInputBlocked(visible);
         saveToPersistentState();
     }
@@ -194,7 +294,16 @@ namespace vkBasalt
 
     void ImGuiOverlay::updateState(OverlayState newState)
     {
+        bool catalogChanged = newState.catalogVersion != state.catalogVersion;
+        if (!catalogChanged)
+        {
+            newState.currentConfigEffects = std::move(state.currentConfigEffects);
+            newState.defaultConfigEffects = std::move(state.defaultConfigEffects);
+            newState.effectPaths = std::move(state.effectPaths);
+        }
         state = std::move(newState);
+        if (catalogChanged)
+            rebuildEffectBrowserIndex();
 
         if (!pEffectRegistry)
             return;
@@ -210,13 +319,6 @@ namespace vkBasalt
         // No editableParams merging needed - Registry IS the source of truth
     }
 
-    std::vector<std::unique_ptr<EffectParam>> ImGuiOverlay::getModifiedParams()
-    {
-        if (!pEffectRegistry)
-            return {};
-        return pEffectRegistry->getAllParameters();
-    }
-
     std::vector<std::string> ImGuiOverlay::getActiveEffects() const
     {
         std::vector<std::string> activeEffects;
@@ -398,6 +500,7 @@ namespace vkBasalt
         initInfo.ImageCount = 2;
         initInfo.PipelineInfoMain.RenderPass = renderPass;
 
+        addOverlayMemoryDevice(pLogicalDevice);
         ImGui_ImplVulkan_Init(&initInfo);
         backendInitialized = true;
 
@@ -433,7 +536,21 @@ namespace vkBasalt
 
     VkCommandBuffer ImGuiOverlay::recordFrame(uint32_t imageIndex, VkImageView imageView, uint32_t width, uint32_t height)
     {
-        if (!backendInitialized || !visible)
+        // Track frame times for the whole session, not only while the overlay is open
+        frameStats.recordPresent();
+
+        if (!visible)
+        {
+            // Free everything once the overlay was hidden for a while
+            int idleRelease = settingsManager.getOverlayIdleRelease();
+            if (imguiInitialized && idleRelease > 0 && std::chrono::steady_clock::now() - hiddenSince >= std::chrono::seconds(idleRelease))
+                releaseImGui();
+            return VK_NULL_HANDLE;
+        }
+
+        if (!imguiInitialized)
+            initImGui();
+        if (!backendInitialized)
             return VK_NULL_HANDLE;
 
         // Store current resolution for VRAM estimates in settings
@@ -11,6 +11,7 @@
 #include "vulkan_include.hpp"
 #include "logical_device.hpp"
 #include "keyboard_input.hpp"
+#include "diagnostics_sampler.hpp"
 #include "effects/params/effect_param.hpp"
 
 namespace vkBasalt
@@ -25,12 +26,35 @@ namespace vkBasalt
         std::vector<std::string> currentConfigEffects;  // ReShade effects from current config (e.g., tunic.conf)
         std::vector<std::string> defaultConfigEffects;  // ReShade effects from default vkBasalt.conf (no duplicates)
         std::map<std::string, std::string> effectPaths; // Effect name -> file path (for reshade effects)
+        uint64_t catalogVersion = 0;  // The three lists above are only filled when this changed
         std::string configPath;
         std::string configName;  // Just the filename (e.g., "tunic.conf")
         bool effectsEnabled = true;
         // Parameters now read directly from EffectRegistry
     };
 
+    // Search index of the add effects view, entries are rebuilt when the catalog changes,
+    // matches when the search text changes
+    struct EffectBrowserIndex
+    {
+        struct Entry
+        {
+            std::string name;
+            std::string lowerName;
+            std::string path;  // Tooltip, empty for built-in effects
+        };
+        struct Category
+        {
+            std::vector<Entry> entries;     // Sorted by name
+            std::vector<uint32_t> matches;  // Indices of the entries matching the search
+        };
+        Category builtin;
+        Category currentConfig;
+        Category defaultConfig;
+        std::string search;  // Lowercased search the matches were built for
+        bool matchesValid = false;
+    };
+
     // UI preferences that persist across swapchain recreation
     // Effect-related state is managed by EffectRegistry
     // Settings are managed by SettingsManager
@@ -49,9 +73,9 @@ namespace vkBasalt
         bool isVisible() const { return visible; }
 
         void updateState(OverlayState newState);
+        uint64_t getCatalogVersion() const { return state.catalogVersion; }
 
-        // Returns modified parameters when Apply is clicked, empty otherwise
-        std::vector<std::unique_ptr<EffectParam>> getModifiedParams();
+        // True when Apply was clicked or auto-apply fired, changed values are tracked by the EffectRegistry
         bool hasModifiedParams() const { return applyRequested; }
         void clearApplyRequest() { applyRequested = false; }
 
@@ -98,12 +122,17 @@ namespace vkBasalt
         }
 
     private:
+        // ImGui context, font atlas and Vulkan objects, only while the overlay is in use
+        void initImGui();
+        void releaseImGui();
         void initVulkanBackend(VkFormat swapchainFormat, uint32_t imageCount);
         void saveToPersistentState();
         void saveCurrentConfig();
 
         // View rendering methods (implemented in separate files)
         void renderAddEffectsView();
+        void rebuildEffectBrowserIndex();
+        void updateEffectBrowserMatches();
         void renderConfigManagerView();
         void renderSettingsView(const KeyboardState& keyboard);
         void renderShaderManagerView();
@@ -127,6 +156,7 @@ namespace vkBasalt
         bool inSelectionMode = false;
         int insertPosition = -1;  // Position to insert effects (-1 = append to end)
         char addEffectsSearch[64] = "";  // Search filter for add effects view
+        EffectBrowserIndex effectBrowserIndex;
         bool inConfigManageMode = false;
         int currentTab = 0;  // 0=Effects, 1=Shaders, 2=Settings, 3=Diagnostics
         std::vector<std::string> configList;
@@ -151,6 +181,11 @@ namespace vkBasalt
         bool shaderPathsChanged = false;  // True when shader manager saved, cleared by basalt.cpp
         size_t maxEffects = 10;  // Cached from settingsManager for VRAM estimates
 
+        // Diagnostics: frame times are recorded on every present, GPU counters
+        // are sampled on a background thread started when the tab is first opened
+        FrameStats frameStats;
+        std::unique_ptr<DiagnosticsSampler> diagnosticsSampler;
+
         // UI state for debug window
         int debugWindowTab = 0;  // 0=Registry, 1=Log
         bool debugLogFilters[5] = {true, true, true, true, true};  // Trace, Debug, Info, Warn, Error
@@ -164,7 +199,9 @@ namespace vkBasalt
         std::chrono::steady_clock::time_point lastChangeTime;
         bool visible = false;
         bool initialized = false;
+        bool imguiInitialized = false;  // initImGui() ran and releaseImGui() didn't since
         bool backendInitialized = false;
+        std::chrono::steady_clock::time_point hiddenSince;  // For releasing ImGui after overlayIdleRelease seconds
         bool dockLayoutInitialized = false;  // True after default dock layout is set up
         uint32_t currentWidth = 1920;   // Current swapchain resolution for VRAM estimates
         uint32_t currentHeight = 1080;
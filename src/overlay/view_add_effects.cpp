@@ -10,16 +10,58 @@
 
 namespace vkBasalt
 {
-    // Case-insensitive substring match
-    static bool matchesSearch(const std::string& text, const char* search)
+    static std::string toLower(std::string text)
     {
-        if (!search || !search[0])
-            return true;
-        std::string lowerText = text;
-        std::string lowerSearch = search;
-        std::transform(lowerText.begin(), lowerText.end(), lowerText.begin(), ::tolower);
-        std::transform(lowerSearch.begin(), lowerSearch.end(), lowerSearch.begin(), ::tolower);
-        return lowerText.find(lowerSearch) != std::string::npos;
+        std::transform(text.begin(), text.end(), text.begin(), ::tolower);
+        return text;
+    }
+
+    static void fillCategory(EffectBrowserIndex::Category& category,
+                             const std::vector<std::string>& names,
+                             const std::map<std::string, std::string>& paths)
+    {
+        category.entries.clear();
+        category.entries.reserve(names.size());
+        for (const auto& name : names)
+        {
+            auto it = paths.find(name);
+            category.entries.push_back({name, toLower(name), it != paths.end() ? it->second : ""});
+        }
+        std::sort(category.entries.begin(), category.entries.end(),
+                  [](const auto& a, const auto& b) { return a.name < b.name; });
+    }
+
+    void ImGuiOverlay::rebuildEffectBrowserIndex()
+    {
+        // Built-in effects keep their fixed order
+        static const std::vector<std::string> builtinEffects = {"cas", "dls", "fxaa", "smaa", "deband", "lut"};
+        effectBrowserIndex.builtin.entries.clear();
+        for (const auto& name : builtinEffects)
+            effectBrowserIndex.builtin.entries.push_back({name, name, ""});
+
+        fillCategory(effectBrowserIndex.currentConfig, state.currentConfigEffects, state.effectPaths);
+        fillCategory(effectBrowserIndex.defaultConfig, state.defaultConfigEffects, state.effectPaths);
+        effectBrowserIndex.matchesValid = false;
+    }
+
+    // Case-insensitive substring match, only redone when the search text or the catalog changed
+    void ImGuiOverlay::updateEffectBrowserMatches()
+    {
+        std::string search = toLower(addEffectsSearch);
+        if (effectBrowserIndex.matchesValid && search == effectBrowserIndex.search)
+            return;
+
+        for (auto* category : {&effectBrowserIndex.builtin, &effectBrowserIndex.currentConfig, &effectBrowserIndex.defaultConfig})
+        {
+            category->matches.clear();
+            for (uint32_t i = 0; i < category->entries.size(); i++)
+            {
+                if (search.empty() || category->entries[i].lowerName.find(search) != std::string::npos)
+                    category->matches.push_back(i);
+            }
+        }
+        effectBrowserIndex.search = std::move(search);
+        effectBrowserIndex.matchesValid = true;
     }
 
     void ImGuiOverlay::renderAddEffectsView()
@@ -27,8 +69,8 @@ namespace vkBasalt
         if (!pEffectRegistry)
             return;
 
-        // Get a mutable copy of selected effects
-        std::vector<std::string> selectedEffects = pEffectRegistry->getSelectedEffects();
+        // Only copied when Done modifies the list
+        const std::vector<std::string>& selectedEffects = pEffectRegistry->getSelectedEffects();
 
         // Handle ESC to clear search
         if (ImGui::IsKeyPressed(ImGuiKey_Escape) && addEffectsSearch[0] != '\0')
@@ -74,9 +116,6 @@ namespace vkBasalt
         size_t pendingCount = pendingAddEffects.size();
         size_t totalCount = currentCount + pendingCount;
 
-        // Built-in effects
-        std::vector<std::string> builtinEffects = {"cas", "dls", "fxaa", "smaa", "deband", "lut"};
-
         // Helper to check if instance name is used
         auto isNameUsed = [&](const std::string& name) {
             if (std::find(selectedEffects.begin(), selectedEffects.end(), name) != selectedEffects.end())
@@ -147,83 +186,51 @@ namespace vkBasalt
             ImGui::Separator();
         }
 
-        // Sort effects for each category
-        std::vector<std::string> sortedCurrentConfig = state.currentConfigEffects;
-        std::vector<std::string> sortedDefaultConfig = state.defaultConfigEffects;
-        std::sort(sortedCurrentConfig.begin(), sortedCurrentConfig.end());
-        std::sort(sortedDefaultConfig.begin(), sortedDefaultConfig.end());
+        updateEffectBrowserMatches();
 
-        // Built-in effects (filtered)
-        bool hasBuiltinMatches = false;
-        for (const auto& effectType : builtinEffects)
-        {
-            if (matchesSearch(effectType, addEffectsSearch))
+        // Only the visible rows of each category are drawn, all buttons have the same height
+        auto renderCategory = [&](const EffectBrowserIndex::Category& category) {
+            ImGuiListClipper clipper;
+            clipper.Begin(static_cast<int>(category.matches.size()), ImGui::GetFrameHeightWithSpacing());
+            while (clipper.Step())
             {
-                hasBuiltinMatches = true;
-                break;
+                for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++)
+                {
+                    const auto& entry = category.entries[category.matches[row]];
+                    renderAddButton(entry.name, entry.path);
+                }
             }
-        }
+        };
+
+        // Built-in effects (filtered)
+        bool hasBuiltinMatches = !effectBrowserIndex.builtin.matches.empty();
         if (hasBuiltinMatches)
         {
             if (!hasSearch)
                 ImGui::Text("Built-in:");
-            for (const auto& effectType : builtinEffects)
-            {
-                if (matchesSearch(effectType, addEffectsSearch))
-                    renderAddButton(effectType);
-            }
+            renderCategory(effectBrowserIndex.builtin);
         }
 
         // ReShade effects from current config (filtered)
-        bool hasCurrentMatches = false;
-        for (const auto& effectType : sortedCurrentConfig)
-        {
-            if (matchesSearch(effectType, addEffectsSearch))
-            {
-                hasCurrentMatches = true;
-                break;
-            }
-        }
+        bool hasCurrentMatches = !effectBrowserIndex.currentConfig.matches.empty();
         if (hasCurrentMatches)
         {
             if (hasBuiltinMatches || !hasSearch)
                 ImGui::Separator();
             if (!hasSearch)
                 ImGui::Text("ReShade (%s):", state.configName.c_str());
-            for (const auto& effectType : sortedCurrentConfig)
-            {
-                if (!matchesSearch(effectType, addEffectsSearch))
-                    continue;
-                auto it = state.effectPaths.find(effectType);
-                std::string path = (it != state.effectPaths.end()) ? it->second : "";
-                renderAddButton(effectType, path);
-            }
+            renderCategory(effectBrowserIndex.currentConfig);
         }
 
         // ReShade effects from default config (filtered)
-        bool hasDefaultMatches = false;
-        for (const auto& effectType : sortedDefaultConfig)
-        {
-            if (matchesSearch(effectType, addEffectsSearch))
-            {
-                hasDefaultMatches = true;
-                break;
-            }
-        }
+        bool hasDefaultMatches = !effectBrowserIndex.defaultConfig.matches.empty();
         if (hasDefaultMatches)
         {
             if (hasCurrentMatches || hasBuiltinMatches || !hasSearch)
                 ImGui::Separator();
             if (!hasSearch)
                 ImGui::Text("ReShade (all):");
-            for (const auto& effectType : sortedDefaultConfig)
-            {
-                if (!matchesSearch(effectType, addEffectsSearch))
-                    continue;
-                auto it = state.effectPaths.find(effectType);
-                std::string path = (it != state.effectPaths.end()) ? it->second : "";
-                renderAddButton(effectType, path);
-            }
+            renderCategory(effectBrowserIndex.defaultConfig);
         }
 
         // Show "no results" if searching and nothing matches
@@ -268,18 +275,19 @@ namespace vkBasalt
         if (ImGui::Button("Done"))
         {
             // Apply pending effects - insert at position or append
-            int pos = (insertPosition >= 0 && insertPosition <= static_cast<int>(selectedEffects.size()))
-                      ? insertPosition : static_cast<int>(selectedEffects.size());
+            std::vector<std::string> newEffects = selectedEffects;
+            int pos = (insertPosition >= 0 && insertPosition <= static_cast<int>(newEffects.size()))
+                      ? insertPosition : static_cast<int>(newEffects.size());
             for (const auto& [instanceName, effectType] : pendingAddEffects)
             {
-                selectedEffects.insert(selectedEffects.begin() + pos, instanceName);
+                newEffects.insert(newEffects.begin() + pos, instanceName);
                 pos++;  // Insert subsequent effects after the previous one
                 pEffectRegistry->ensureEffect(instanceName, effectType);
                 pEffectRegistry->setEffectEnabled(instanceName, true);
             }
             if (!pendingAddEffects.empty())
             {
-                pEffectRegistry->setSelectedEffects(selectedEffects);
+                pEffectRegistry->setSelectedEffects(newEffects);
                 applyRequested = true;
             }
             pendingAddEffects.clear();
@@ -199,7 +199,10 @@ namespace vkBasalt
                     {
                         FieldEditor* editor = FieldEditorFactory::instance().getEditor(param->getType());
                         if (editor)
+                        {
                             editor->resetToDefault(*param);
+                            pEffectRegistry->markParameterChanged(*param);
+                        }
                     }
                     paramsDirty = true;
                     lastChangeTime = std::chrono::steady_clock::now();
@@ -282,11 +285,19 @@ namespace vkBasalt
 
             // Show parameters for this effect
             auto effectParams = pEffectRegistry->getParametersForEffect(effectName);
+            const std::string* lastCategory = nullptr;
             for (size_t paramIdx = 0; paramIdx < effectParams.size(); paramIdx++)
             {
+                // ui_category header whenever it changes
+                const std::string& category = effectParams[paramIdx]->category;
+                if (!category.empty() && (!lastCategory || *lastCategory != category))
+                    ImGui::SeparatorText(category.c_str());
+                lastCategory = &category;
+
                 ImGui::PushID(static_cast<int>(paramIdx));
                 if (renderFieldEditor(*effectParams[paramIdx]))
                 {
+                    pEffectRegistry->markParameterChanged(*effectParams[paramIdx]);
                     paramsDirty = true;
                     lastChangeTime = std::chrono::steady_clock::now();
                 }
@@ -85,6 +85,17 @@ namespace vkBasalt
             ImGui::EndTooltip();
         }
 
+        ImGui::Text("Free Overlay When Hidden:");
+        if (ImGui::IsItemHovered())
+            ImGui::SetTooltip("Release the overlay's memory after it was hidden this long.\nOpening it again takes a moment to rebuild the fonts. 0 keeps it loaded.");
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(120);
+        int idleReleaseVal = settingsManager.getOverlayIdleRelease();
+        if (ImGui::SliderInt("##overlayIdleRelease", &idleReleaseVal, 0, 600, "%d s"))
+            settingsManager.setOverlayIdleRelease(idleReleaseVal);
+        if (ImGui::IsItemDeactivatedAfterEdit())
+            saveSettings();
+
         ImGui::Text("Max Effects (requires restart):");
         if (ImGui::IsItemHovered())
         {
@@ -114,6 +125,32 @@ namespace vkBasalt
         else
             ImGui::TextDisabled("~%d MB @ %ux%u", estimatedVramMB, currentWidth, currentHeight);
 
+        ImGui::Text("VRAM Limit (MB):");
+        if (ImGui::IsItemHovered())
+        {
+            ImGui::BeginTooltip();
+            ImGui::Text("Effects that would push vkBasalt's own allocations above this are refused.");
+            ImGui::Text("0 disables the limit. See the Diagnostics tab for per-effect usage.");
+            ImGui::EndTooltip();
+        }
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(100);
+        int vramLimitVal = settingsManager.getVramLimitMB();
+        if (ImGui::InputInt("##vramLimit", &vramLimitVal, 64, 512))
+        {
+            settingsManager.setVramLimitMB(std::max(vramLimitVal, 0));
+            saveSettings();
+        }
+
+        bool respectBudget = settingsManager.getRespectMemoryBudget();
+        if (ImGui::Checkbox("Respect Driver Memory Budget", &respectBudget))
+        {
+            settingsManager.setRespectMemoryBudget(respectBudget);
+            saveSettings();
+        }
+        if (ImGui::IsItemHovered())
+            ImGui::SetTooltip("Refuse new effects while the driver reports VRAM usage above its budget\n(requires VK_EXT_memory_budget). Avoids pushing the game into paging.");
+
         bool autoApply = settingsManager.getAutoApply();
         if (ImGui::Checkbox("Auto-apply Changes", &autoApply))
         {
@@ -152,6 +189,15 @@ namespace vkBasalt
         if (ImGui::IsItemHovered())
             ImGui::SetTooltip("If enabled, effects are active when the game starts.\nIf disabled, effects start off and must be toggled on.");
 
+        bool bypassWhenDisabled = settingsManager.getBypassWhenDisabled();
+        if (ImGui::Checkbox("Bypass While Effects Are Off", &bypassWhenDisabled))
+        {
+            settingsManager.setBypassWhenDisabled(bypassWhenDisabled);
+            saveSettings();
+        }
+        if (ImGui::IsItemHovered())
+            ImGui::SetTooltip("While effects are off, let the game render straight into the swapchain\ninstead of copying every frame. Toggling asks the game to recreate\nits swapchain, games that ignore that keep the previous mode.");
+
         bool depthCapture = settingsManager.getDepthCapture();
         if (ImGui::Checkbox("Depth Capture (requires restart)", &depthCapture))
         {
@@ -161,6 +207,33 @@ namespace vkBasalt
         if (ImGui::IsItemHovered())
             ImGui::SetTooltip("Enable depth buffer capture for effects that use depth.\nMay impact performance. Most effects don't need this.\nChanges require restarting the application.");
 
+        bool linearDepthPrepass = settingsManager.getLinearDepthPrepass();
+        if (ImGui::Checkbox("Shared Linear Depth", &linearDepthPrepass))
+        {
+            settingsManager.setLinearDepthPrepass(linearDepthPrepass);
+            saveSettings();
+        }
+        if (ImGui::IsItemHovered())
+            ImGui::SetTooltip("Linearize the depth buffer once per frame for all ReShade effects\ninstead of in every effect. The RESHADE_DEPTH_* options come from\ndepthLinearizationFarPlane, depthInputIsReversed, depthInputIsLogarithmic\nand depthMultiplier in the config. Applies on the next effect reload.");
+
+        bool halfPrecisionShaders = settingsManager.getHalfPrecisionShaders();
+        if (ImGui::Checkbox("Half Precision Built-in Shaders", &halfPrecisionShaders))
+        {
+            settingsManager.setHalfPrecisionShaders(halfPrecisionShaders);
+            saveSettings();
+        }
+        if (ImGui::IsItemHovered())
+            ImGui::SetTooltip("Run CAS and DLS with FP16 math when the GPU supports it.\nFaster on most GPUs, applies on the next effect reload.");
+
+        bool dedicatedEffectQueue = settingsManager.getDedicatedEffectQueue();
+        if (ImGui::Checkbox("Dedicated Effect Queue (requires restart)", &dedicatedEffectQueue))
+        {
+            settingsManager.setDedicatedEffectQueue(dedicatedEffectQueue);
+            saveSettings();
+        }
+        if (ImGui::IsItemHovered())
+            ImGui::SetTooltip("Submit effects and the overlay on a second queue of the game's graphics queue family.\nLets post-processing overlap with the game's next frame on GPUs that expose several graphics queues.\nChanges require restarting the application.");
+
         ImGui::Spacing();
         ImGui::Text("Debug");
         ImGui::Separator();
@@ -175,6 +248,15 @@ namespace vkBasalt
         if (ImGui::IsItemHovered())
             ImGui::SetTooltip("Show debug window with effect registry data and log output.");
 
+        bool presentLatencyStats = settingsManager.getPresentLatencyStats();
+        if (ImGui::Checkbox("Present Latency Stats (requires restart)", &presentLatencyStats))
+        {
+            settingsManager.setPresentLatencyStats(presentLatencyStats);
+            saveSettings();
+        }
+        if (ImGui::IsItemHovered())
+            ImGui::SetTooltip("Measure how long each frame takes from vkBasalt's submits to the screen.\nShown in the Diagnostics tab and written to the log when switching configs.\nDisplay times need VK_KHR_present_wait. Changes require restarting the application.");
+
         ImGui::EndChild();
     }
 
@@ -0,0 +1,324 @@
+#include "present_latency.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include <pthread.h>
+
+#include "command_buffer.hpp"
+#include "logical_device.hpp"
+#include "logger.hpp"
+#include "util.hpp"
+
+namespace vkBasalt
+{
+    namespace
+    {
+        // Wait in short steps so a destroyed swapchain or device never blocks for long
+        constexpr uint64_t waitStepNs = 20 * 1000 * 1000;
+
+        // Presents that take longer than this are most likely dropped, stop waiting for them
+        constexpr std::chrono::milliseconds presentTimeout(1000);
+
+        void appendStat(std::string& out, const char* name, const FrameTimeHistogram& histogram)
+        {
+            if (histogram.count() == 0)
+                return;
+            char buffer[128];
+            snprintf(buffer, sizeof(buffer), " %s avg %.2f p50 %.2f p99 %.2f ms,", name, histogram.mean(), histogram.quantile(0.5),
+                     histogram.quantile(0.99));
+            out += buffer;
+        }
+    } // namespace
+
+    PresentLatencyTracker::PresentLatencyTracker(LogicalDevice* pLogicalDevice, bool supportsPresentWait)
+        : pLogicalDevice(pLogicalDevice), presentWait(supportsPresentWait)
+    {
+        uint32_t familyCount = 0;
+        pLogicalDevice->vki.GetPhysicalDeviceQueueFamilyProperties(pLogicalDevice->physicalDevice, &familyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> queueProperties(familyCount);
+        pLogicalDevice->vki.GetPhysicalDeviceQueueFamilyProperties(pLogicalDevice->physicalDevice, &familyCount, queueProperties.data());
+
+        VkPhysicalDeviceProperties deviceProperties;
+        pLogicalDevice->vki.GetPhysicalDeviceProperties(pLogicalDevice->physicalDevice, &deviceProperties);
+
+        uint32_t validBits = pLogicalDevice->queueFamilyIndex < familyCount ? queueProperties[pLogicalDevice->queueFamilyIndex].timestampValidBits : 0;
+        if (validBits)
+        {
+            timestampMask   = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+            timestampPeriod = deviceProperties.limits.timestampPeriod;
+
+            VkQueryPoolCreateInfo queryPoolCreateInfo = {};
+            queryPoolCreateInfo.sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+            queryPoolCreateInfo.queryType  = VK_QUERY_TYPE_TIMESTAMP;
+            queryPoolCreateInfo.queryCount = slotCount * 2;
+
+            VkResult result = pLogicalDevice->vkd.CreateQueryPool(pLogicalDevice->device, &queryPoolCreateInfo, nullptr, &queryPool);
+            ASSERT_VULKAN(result);
+        }
+        else
+        {
+            Logger::info("queue family has no timestamps, present latency is measured without GPU times");
+        }
+
+        // The command buffers never change, record them once
+        std::vector<VkCommandBuffer> commandBuffers = allocateCommandBuffer(pLogicalDevice, slotCount * 2);
+
+        VkCommandBufferBeginInfo beginInfo = {};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+
+        VkFenceCreateInfo fenceCreateInfo = {};
+        fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+        for (uint32_t i = 0; i < slotCount; i++)
+        {
+            Slot& slot              = slots[i];
+            slot.beginCommandBuffer = commandBuffers[i * 2];
+            slot.endCommandBuffer   = commandBuffers[i * 2 + 1];
+
+            VkResult result = pLogicalDevice->vkd.BeginCommandBuffer(slot.beginCommandBuffer, &beginInfo);
+            ASSERT_VULKAN(result);
+            if (queryPool != VK_NULL_HANDLE)
+            {
+                // a stage the application's semaphores block, so the GPU time starts once its frame is rendered
+                pLogicalDevice->vkd.CmdResetQueryPool(slot.beginCommandBuffer, queryPool, i * 2, 2);
+                pLogicalDevice->vkd.CmdWriteTimestamp(slot.beginCommandBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, queryPool, i * 2);
+            }
+            result = pLogicalDevice->vkd.EndCommandBuffer(slot.beginCommandBuffer);
+            ASSERT_VULKAN(result);
+
+            result = pLogicalDevice->vkd.BeginCommandBuffer(slot.endCommandBuffer, &beginInfo);
+            ASSERT_VULKAN(result);
+            // bottom of pipe waits for everything submitted to the queue before it
+            if (queryPool != VK_NULL_HANDLE)
+                pLogicalDevice->vkd.CmdWriteTimestamp(slot.endCommandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, i * 2 + 1);
+            result = pLogicalDevice->vkd.EndCommandBuffer(slot.endCommandBuffer);
+            ASSERT_VULKAN(result);
+
+            result = pLogicalDevice->vkd.CreateFence(pLogicalDevice->device, &fenceCreateInfo, nullptr, &slot.fence);
+            ASSERT_VULKAN(result);
+        }
+
+        thread = std::thread(&PresentLatencyTracker::run, this);
+
+        Logger::info(std::string("present latency tracking enabled") + (presentWait ? "" : ", without VK_KHR_present_wait"));
+    }
+
+    PresentLatencyTracker::~PresentLatencyTracker()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopRequested = true;
+            cancelWait    = true;
+        }
+        condition.notify_all();
+        thread.join();
+
+        logSummary("session");
+
+        // The application has to wait for the device before destroying it, no fence is pending any more
+        for (Slot& slot : slots)
+        {
+            pLogicalDevice->vkd.DestroyFence(pLogicalDevice->device, slot.fence, nullptr);
+            VkCommandBuffer commandBuffers[2] = {slot.beginCommandBuffer, slot.endCommandBuffer};
+            pLogicalDevice->vkd.FreeCommandBuffers(pLogicalDevice->device, pLogicalDevice->commandPool, 2, commandBuffers);
+        }
+        if (queryPool != VK_NULL_HANDLE)
+            pLogicalDevice->vkd.DestroyQueryPool(pLogicalDevice->device, queryPool, nullptr);
+    }
+
+    int32_t PresentLatencyTracker::beginFrame()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (uint32_t i = 0; i < slotCount; i++)
+        {
+            uint32_t index = (nextSlot + i) % slotCount;
+            Slot&    slot  = slots[index];
+            if (slot.busy)
+                continue;
+
+            slot.busy       = true;
+            slot.gpuWork    = false;
+            slot.submitTime = Clock::now();
+            nextSlot        = (index + 1) % slotCount;
+            return (int32_t) index;
+        }
+        return -1;
+    }
+
+    VkResult PresentLatencyTracker::submitEnd(int32_t slot)
+    {
+        VkSubmitInfo submitInfo       = {};
+        submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers    = &slots[slot].endCommandBuffer;
+
+        VkResult result = pLogicalDevice->vkd.QueueSubmit(pLogicalDevice->queue, 1, &submitInfo, slots[slot].fence);
+        slots[slot].gpuWork = result == VK_SUCCESS;
+        return result;
+    }
+
+    void PresentLatencyTracker::cancelFrame(int32_t slot)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        slots[slot].busy = false;
+    }
+
+    void PresentLatencyTracker::submitPresent(int32_t slot, VkSwapchainKHR swapchain, uint64_t presentId)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending.push_back({slot, swapchain, presentWait ? presentId : 0});
+        }
+        condition.notify_all();
+    }
+
+    void PresentLatencyTracker::forgetSwapchain(VkSwapchainKHR swapchain)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        // the fences still have to be waited on, only the present wait is dropped
+        for (PendingPresent& present : pending)
+        {
+            if (present.swapchain == swapchain)
+                present.presentId = 0;
+        }
+        if (currentSwapchain == swapchain)
+        {
+            cancelWait = true;
+            condition.wait(lock, [&] { return currentSwapchain != swapchain; });
+        }
+    }
+
+    void PresentLatencyTracker::run()
+    {
+        // Not SCHED_IDLE like the diagnostics sampler, a late wakeup would show up as latency
+        pthread_setname_np(pthread_self(), "vkBasalt-latency");
+
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true)
+        {
+            condition.wait(lock, [this] { return stopRequested || !pending.empty(); });
+            if (stopRequested)
+                break;
+
+            PendingPresent present = pending.front();
+            pending.pop_front();
+            currentSwapchain = present.presentId ? present.swapchain : VK_NULL_HANDLE;
+            cancelWait       = false;
+
+            lock.unlock();
+            process(present);
+            lock.lock();
+
+            currentSwapchain         = VK_NULL_HANDLE;
+            slots[present.slot].busy = false;
+            condition.notify_all();
+        }
+    }
+
+    void PresentLatencyTracker::process(const PendingPresent& present)
+    {
+        Slot& slot = slots[present.slot];
+
+        bool              complete = false;
+        Clock::time_point completeTime;
+        float             gpuTimeMs = -1.0f;
+        if (slot.gpuWork)
+        {
+            complete     = waitForFence(slot.fence);
+            completeTime = Clock::now();
+            if (!complete)
+                return;
+
+            if (queryPool != VK_NULL_HANDLE)
+            {
+                uint64_t timestamps[2];
+                VkResult result = pLogicalDevice->vkd.GetQueryPoolResults(pLogicalDevice->device, queryPool, present.slot * 2, 2,
+                                                                          sizeof(timestamps), timestamps, sizeof(uint64_t),
+                                                                          VK_QUERY_RESULT_64_BIT);
+                if (result == VK_SUCCESS)
+                    gpuTimeMs = static_cast<float>(((timestamps[1] - timestamps[0]) & timestampMask) * timestampPeriod / 1e6);
+            }
+            pLogicalDevice->vkd.ResetFences(pLogicalDevice->device, 1, &slot.fence);
+        }
+
+        bool              displayed   = present.presentId && waitForPresent(present.swapchain, present.presentId);
+        Clock::time_point displayTime = Clock::now();
+
+        auto toMs = [](Clock::duration duration) { return std::max(std::chrono::duration<float, std::milli>(duration).count(), 0.0f); };
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (complete)
+        {
+            float submitToComplete = toMs(completeTime - slot.submitTime);
+            submitToCompleteHistogram.record(submitToComplete);
+            submitToCompleteHistory.push(submitToComplete);
+        }
+        if (gpuTimeMs >= 0.0f)
+            gpuTimeHistogram.record(gpuTimeMs);
+        if (displayed)
+        {
+            float submitToDisplay = toMs(displayTime - slot.submitTime);
+            submitToDisplayHistogram.record(submitToDisplay);
+            submitToDisplayHistory.push(submitToDisplay);
+            // the present can be shown before this thread woke up from the fence
+            if (complete)
+                completeToDisplayHistory.push(toMs(displayTime - completeTime));
+        }
+    }
+
+    bool PresentLatencyTracker::waitForFence(VkFence fence)
+    {
+        while (!stopRequested)
+        {
+            VkResult result = pLogicalDevice->vkd.WaitForFences(pLogicalDevice->device, 1, &fence, VK_TRUE, waitStepNs);
+            if (result != VK_TIMEOUT)
+                return result == VK_SUCCESS;
+        }
+        return false;
+    }
+
+    bool PresentLatencyTracker::waitForPresent(VkSwapchainKHR swapchain, uint64_t presentId)
+    {
+        Clock::time_point start = Clock::now();
+        while (!cancelWait && Clock::now() - start < presentTimeout)
+        {
+            VkResult result = pLogicalDevice->vkd.WaitForPresentKHR(pLogicalDevice->device, swapchain, presentId, waitStepNs);
+            if (result != VK_TIMEOUT)
+                return result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR;
+        }
+        return false;
+    }
+
+    void PresentLatencyTracker::logSummary(const std::string& label)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (submitToCompleteHistogram.count() == 0 && submitToDisplayHistogram.count() == 0)
+            return;
+
+        std::string summary = "present latency (" + label + "):";
+        appendStat(summary, "submit->complete", submitToCompleteHistogram);
+        appendStat(summary, "gpu", gpuTimeHistogram);
+        appendStat(summary, "submit->display", submitToDisplayHistogram);
+        summary += " " + std::to_string(std::max(submitToCompleteHistogram.count(), submitToDisplayHistogram.count())) + " frames";
+        Logger::info(summary);
+    }
+
+    void PresentLatencyTracker::reset()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        submitToCompleteHistogram.reset();
+        gpuTimeHistogram.reset();
+        submitToDisplayHistogram.reset();
+    }
+
+    void PresentLatencyTracker::getHistograms(FrameTimeHistogram& submitToComplete, FrameTimeHistogram& gpuTime,
+                                              FrameTimeHistogram& submitToDisplay) const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        submitToComplete = submitToCompleteHistogram;
+        gpuTime          = gpuTimeHistogram;
+        submitToDisplay  = submitToDisplayHistogram;
+    }
+} // namespace vkBasalt
@@ -0,0 +1,118 @@
+#ifndef PRESENT_LATENCY_HPP_INCLUDED
+#define PRESENT_LATENCY_HPP_INCLUDED
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "vulkan_include.hpp"
+
+#include "overlay/diagnostics_sampler.hpp"
+
+namespace vkBasalt
+{
+    struct LogicalDevice;
+
+    // Measures what the layer adds between the application's present and the image reaching the screen.
+    // A tracked frame gets a timestamp query around vkBasalt's submits, a fence after them and a VkPresentIdKHR,
+    // a helper thread then waits for the fence and for vkWaitForPresentKHR and records the intervals
+    //   submit   -> complete: CPU time from our first submit until the effect chain finished on the GPU
+    //   gpu                : GPU time of the effect chain, from the timestamp queries
+    //   complete -> display: until the presentation engine showed the image
+    class PresentLatencyTracker
+    {
+    public:
+        PresentLatencyTracker(LogicalDevice* pLogicalDevice, bool supportsPresentWait);
+        ~PresentLatencyTracker();
+
+        PresentLatencyTracker(const PresentLatencyTracker&)            = delete;
+        PresentLatencyTracker& operator=(const PresentLatencyTracker&) = delete;
+
+        // Starts tracking a frame, returns -1 if every slot is still waited on, the frame then goes untracked.
+        // Every other slot has to be handed to submitPresent()
+        int32_t beginFrame();
+
+        // Writes the start timestamp, submit it before the effect command buffers of the frame
+        VkCommandBuffer getBeginCommandBuffer(int32_t slot) const { return slots[slot].beginCommandBuffer; }
+
+        // Submits the end timestamp and the fence, after the last of vkBasalt's submits of the frame
+        VkResult submitEnd(int32_t slot);
+
+        // Gives the slot back when the frame fails before submitEnd() succeeded, nothing of it is waited on
+        void cancelFrame(int32_t slot);
+
+        // Hands the frame to the helper thread. presentId 0 means the present was not tagged
+        void submitPresent(int32_t slot, VkSwapchainKHR swapchain, uint64_t presentId);
+
+        // Must be called before the swapchain is destroyed, stops waiting on its presents
+        void forgetSwapchain(VkSwapchainKHR swapchain);
+
+        bool supportsPresentWait() const { return presentWait; }
+
+        // Writes the session statistics to the log, label says what they belong to (usually the config)
+        void logSummary(const std::string& label);
+        void reset();
+
+        // Session distributions, copied under the lock since the helper thread writes them
+        void getHistograms(FrameTimeHistogram& submitToComplete, FrameTimeHistogram& gpuTime, FrameTimeHistogram& submitToDisplay) const;
+
+        SampleRing<300> submitToCompleteHistory;
+        SampleRing<300> completeToDisplayHistory;
+        SampleRing<300> submitToDisplayHistory;
+
+    private:
+        static constexpr uint32_t slotCount = 8;
+
+        using Clock = std::chrono::steady_clock;
+
+        struct Slot
+        {
+            VkCommandBuffer   beginCommandBuffer = VK_NULL_HANDLE;
+            VkCommandBuffer   endCommandBuffer   = VK_NULL_HANDLE;
+            VkFence           fence              = VK_NULL_HANDLE;
+            Clock::time_point submitTime;
+            bool              gpuWork = false;  // submitEnd() was called
+            bool              busy    = false;  // between beginFrame() and the helper thread finishing it
+        };
+
+        struct PendingPresent
+        {
+            int32_t        slot;
+            VkSwapchainKHR swapchain;
+            uint64_t       presentId;
+        };
+
+        void run();
+        void process(const PendingPresent& pending);
+        bool waitForFence(VkFence fence);
+        bool waitForPresent(VkSwapchainKHR swapchain, uint64_t presentId);
+
+        LogicalDevice* pLogicalDevice;
+        bool           presentWait;
+        VkQueryPool    queryPool       = VK_NULL_HANDLE;  // 2 timestamps per slot
+        uint64_t       timestampMask   = 0;               // 0 if the queue has no timestamps
+        double         timestampPeriod = 1.0;             // ns per tick
+
+        std::array<Slot, slotCount> slots;
+
+        mutable std::mutex         mutex;  // slot ownership, pending, currentSwapchain and the histograms
+        std::condition_variable    condition;
+        std::deque<PendingPresent> pending;
+        uint32_t                   nextSlot         = 0;
+        VkSwapchainKHR             currentSwapchain = VK_NULL_HANDLE;  // the helper thread waits on it right now
+        std::atomic<bool>          cancelWait{false};                  // stop waiting on currentSwapchain
+        std::atomic<bool>          stopRequested{false};
+        std::thread                thread;
+
+        FrameTimeHistogram submitToCompleteHistogram;
+        FrameTimeHistogram submitToDisplayHistogram;
+        FrameTimeHistogram gpuTimeHistogram;
+    };
+} // namespace vkBasalt
+
+#endif // PRESENT_LATENCY_HPP_INCLUDED
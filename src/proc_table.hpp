@@ -0,0 +1,117 @@
+#ifndef PROC_TABLE_HPP_INCLUDED
+#define PROC_TABLE_HPP_INCLUDED
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string_view>
+
+namespace vkBasalt
+{
+    // FNV-1a with a seed, so makePerfectHashTable() can search for one without collisions
+    constexpr uint32_t hashProcName(std::string_view name, uint32_t seed)
+    {
+        uint32_t hash = 2166136261u ^ seed;
+        for (char c : name)
+        {
+            hash ^= (uint8_t) c;
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    // Maps each of N names to its index with one hash and one string compare.
+    // Built at compile time, TableSize must be a power of two larger than N.
+    template<size_t N, size_t TableSize>
+    struct PerfectHashTable
+    {
+        static_assert(N < TableSize && (TableSize & (TableSize - 1)) == 0);
+        static_assert(N < 255);
+
+        uint32_t                       seed  = 0;
+        bool                           found = false;
+        std::array<uint8_t, TableSize> slots = {}; // index + 1, 0 is empty
+
+        // returns -1 for names that are not in the table
+        constexpr int32_t find(const std::string_view (&names)[N], std::string_view name) const
+        {
+            uint8_t slot = slots[hashProcName(name, seed) & (TableSize - 1)];
+            if (slot == 0 || names[slot - 1] != name)
+                return -1;
+            return slot - 1;
+        }
+    };
+
+    template<size_t TableSize, size_t N>
+    constexpr PerfectHashTable<N, TableSize> makePerfectHashTable(const std::string_view (&names)[N])
+    {
+        PerfectHashTable<N, TableSize> table;
+        for (uint32_t seed = 0; seed < 4096; seed++)
+        {
+            table.seed  = seed;
+            table.found = true;
+            table.slots = {};
+            for (size_t i = 0; i < N && table.found; i++)
+            {
+                uint8_t& slot = table.slots[hashProcName(names[i], seed) & (TableSize - 1)];
+                table.found   = slot == 0;
+                slot          = (uint8_t) (i + 1);
+            }
+            if (table.found)
+                return table;
+        }
+        return table;
+    }
+
+    // Dispatch key -> next layer's GetProcAddr, readable without a lock.
+    // insert() and erase() must be serialized by the caller, find() may run concurrently with them.
+    template<typename PFN, size_t Size = 32>
+    class ProcAddrCache
+    {
+    public:
+        // returns false when full, the caller then has to look the key up elsewhere
+        bool insert(void* key, PFN pfn)
+        {
+            for (Slot& slot : slots)
+            {
+                void* current = slot.key.load(std::memory_order_relaxed);
+                if (current != nullptr && current != key)
+                    continue;
+                slot.pfn.store(pfn, std::memory_order_relaxed);
+                slot.key.store(key, std::memory_order_release);
+                return true;
+            }
+            return false;
+        }
+
+        void erase(void* key)
+        {
+            for (Slot& slot : slots)
+            {
+                if (slot.key.load(std::memory_order_relaxed) == key)
+                    slot.key.store(nullptr, std::memory_order_release);
+            }
+        }
+
+        PFN find(void* key) const
+        {
+            if (key == nullptr)
+                return nullptr;
+            for (const Slot& slot : slots)
+            {
+                if (slot.key.load(std::memory_order_acquire) == key)
+                    return slot.pfn.load(std::memory_order_relaxed);
+            }
+            return nullptr;
+        }
+
+    private:
+        struct Slot
+        {
+            std::atomic<void*> key = nullptr;
+            std::atomic<PFN>   pfn = nullptr;
+        };
+        std::array<Slot, Size> slots;
+    };
+} // namespace vkBasalt
+
+#endif // PROC_TABLE_HPP_INCLUDED
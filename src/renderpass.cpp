@@ -2,7 +2,7 @@
 
 namespace vkBasalt
 {
-    VkRenderPass createRenderPass(LogicalDevice* pLogicalDevice, VkFormat format)
+    VkRenderPass createRenderPass(LogicalDevice* pLogicalDevice, VkFormat format, bool loadContents)
     {
         VkRenderPass renderPass;
 
@@ -10,11 +10,11 @@ namespace vkBasalt
         attachmentDescription.flags          = 0;
         attachmentDescription.format         = format;
         attachmentDescription.samples        = VK_SAMPLE_COUNT_1_BIT;
-        attachmentDescription.loadOp         = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        attachmentDescription.loadOp         = loadContents ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR;
         attachmentDescription.storeOp        = VK_ATTACHMENT_STORE_OP_STORE;
         attachmentDescription.stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
         attachmentDescription.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-        attachmentDescription.initialLayout  = VK_IMAGE_LAYOUT_UNDEFINED;
+        attachmentDescription.initialLayout  = loadContents ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
         attachmentDescription.finalLayout    = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
         VkAttachmentReference attachmentReference;
@@ -58,4 +58,78 @@ namespace vkBasalt
 
         return renderPass;
     }
+
+    VkRenderPass createStencilRenderPass(LogicalDevice* pLogicalDevice, VkFormat format, VkFormat stencilFormat, bool clearStencil)
+    {
+        VkRenderPass renderPass;
+
+        VkAttachmentDescription attachmentDescriptions[2];
+        attachmentDescriptions[0].flags          = 0;
+        attachmentDescriptions[0].format         = format;
+        attachmentDescriptions[0].samples        = VK_SAMPLE_COUNT_1_BIT;
+        attachmentDescriptions[0].loadOp         = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        attachmentDescriptions[0].storeOp        = VK_ATTACHMENT_STORE_OP_STORE;
+        attachmentDescriptions[0].stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        attachmentDescriptions[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        attachmentDescriptions[0].initialLayout  = VK_IMAGE_LAYOUT_UNDEFINED;
+        attachmentDescriptions[0].finalLayout    = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+        attachmentDescriptions[1].flags          = 0;
+        attachmentDescriptions[1].format         = stencilFormat;
+        attachmentDescriptions[1].samples        = VK_SAMPLE_COUNT_1_BIT;
+        attachmentDescriptions[1].loadOp         = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        attachmentDescriptions[1].storeOp        = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        attachmentDescriptions[1].stencilLoadOp  = clearStencil ? VK_ATTACHMENT_LOAD_OP_CLEAR : VK_ATTACHMENT_LOAD_OP_LOAD;
+        attachmentDescriptions[1].stencilStoreOp = clearStencil ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        attachmentDescriptions[1].initialLayout  = clearStencil ? VK_IMAGE_LAYOUT_UNDEFINED : VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        attachmentDescriptions[1].finalLayout    = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+        VkAttachmentReference colorReference;
+        colorReference.attachment = 0;
+        colorReference.layout     = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+        VkAttachmentReference stencilReference;
+        stencilReference.attachment = 1;
+        stencilReference.layout     = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+        VkSubpassDescription subpassDescription;
+        subpassDescription.flags                   = 0;
+        subpassDescription.pipelineBindPoint       = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        subpassDescription.inputAttachmentCount    = 0;
+        subpassDescription.pInputAttachments       = nullptr;
+        subpassDescription.colorAttachmentCount    = 1;
+        subpassDescription.pColorAttachments       = &colorReference;
+        subpassDescription.pResolveAttachments     = nullptr;
+        subpassDescription.pDepthStencilAttachment = &stencilReference;
+        subpassDescription.preserveAttachmentCount = 0;
+        subpassDescription.pPreserveAttachments    = nullptr;
+
+        // the stencil written by the previous render pass has to be visible to the tests of this one
+        VkSubpassDependency subpassDependency;
+        subpassDependency.srcSubpass   = VK_SUBPASS_EXTERNAL;
+        subpassDependency.dstSubpass   = 0;
+        subpassDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        subpassDependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT
+                                         | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        subpassDependency.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        subpassDependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
+                                          | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        subpassDependency.dependencyFlags = 0;
+
+        VkRenderPassCreateInfo renderPassCreateInfo;
+        renderPassCreateInfo.sType           = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+        renderPassCreateInfo.pNext           = nullptr;
+        renderPassCreateInfo.flags           = 0;
+        renderPassCreateInfo.attachmentCount = 2;
+        renderPassCreateInfo.pAttachments    = attachmentDescriptions;
+        renderPassCreateInfo.subpassCount    = 1;
+        renderPassCreateInfo.pSubpasses      = &subpassDescription;
+        renderPassCreateInfo.dependencyCount = 1;
+        renderPassCreateInfo.pDependencies   = &subpassDependency;
+
+        VkResult result = pLogicalDevice->vkd.CreateRenderPass(pLogicalDevice->device, &renderPassCreateInfo, nullptr, &renderPass);
+        ASSERT_VULKAN(result);
+
+        return renderPass;
+    }
 } // namespace vkBasalt
@@ -13,7 +13,12 @@
 
 namespace vkBasalt
 {
-    VkRenderPass createRenderPass(LogicalDevice* pLogicalDevice, VkFormat format);
+    // loadContents keeps what is already in the image, it then has to be in COLOR_ATTACHMENT_OPTIMAL
+    VkRenderPass createRenderPass(LogicalDevice* pLogicalDevice, VkFormat format, bool loadContents = false);
+
+    // Color attachment plus a stencil attachment that masks passes to the pixels an earlier pass wrote.
+    // clearStencil clears it to 0 and leaves it in DEPTH_STENCIL_ATTACHMENT_OPTIMAL, otherwise it gets loaded from there
+    VkRenderPass createStencilRenderPass(LogicalDevice* pLogicalDevice, VkFormat format, VkFormat stencilFormat, bool clearStencil);
 }
 
 #endif // RENDERPASS_HPP_INCLUDED
@@ -0,0 +1,679 @@
+#include "reshade_metadata.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "reshade/effect_lexer.hpp"
+#include "reshade/effect_preprocessor.hpp"
+
+#include "logger.hpp"
+#include "config_serializer.hpp"
+
+namespace vkBasalt
+{
+    namespace
+    {
+        using reshadefx::tokenid;
+
+        // Bump when the scanner or the entry layout changes, old entries are then never looked up again
+        constexpr uint32_t metadataVersion = 1;
+        constexpr char     indexMagic[8]   = {'V', 'K', 'B', 'M', 'E', 'T', 'A', '\0'};
+
+        struct FileStamp
+        {
+            std::string path;
+            int64_t     size  = 0;
+            int64_t     mtime = 0; // ns
+        };
+
+        bool stampFile(const std::string& path, FileStamp& stamp)
+        {
+            struct stat fileStat;
+            if (stat(path.c_str(), &fileStat) != 0)
+                return false;
+            stamp.path  = path;
+            stamp.size  = fileStat.st_size;
+            stamp.mtime = (int64_t) fileStat.st_mtim.tv_sec * 1000000000 + fileStat.st_mtim.tv_nsec;
+            return true;
+        }
+
+        bool stampsValid(const std::vector<FileStamp>& stamps)
+        {
+            for (const auto& stamp : stamps)
+            {
+                FileStamp current;
+                if (!stampFile(stamp.path, current) || current.size != stamp.size || current.mtime != stamp.mtime)
+                    return false;
+            }
+            return true;
+        }
+
+        // FNV-1a
+        uint64_t hashBytes(const char* data, size_t length, uint64_t hash = 14695981039346656037ull)
+        {
+            for (size_t i = 0; i < length; i++)
+            {
+                hash ^= (uint8_t) data[i];
+                hash *= 1099511628211ull;
+            }
+            return hash;
+        }
+
+        std::string getIndexDir()
+        {
+            if (const char* xdgCache = std::getenv("XDG_CACHE_HOME"))
+                return std::string(xdgCache) + "/vkBasalt-overlay/metadata";
+            if (const char* home = std::getenv("HOME"))
+                return std::string(home) + "/.cache/vkBasalt-overlay/metadata";
+            return "";
+        }
+
+        // Walks the global scope of the preprocessed source, only uniform declarations and technique names are looked at
+        class DeclarationScanner
+        {
+        public:
+            explicit DeclarationScanner(std::string source)
+            {
+                reshadefx::lexer lexer(std::move(source));
+                for (reshadefx::token token = lexer.lex(); token.id != tokenid::end_of_file; token = lexer.lex())
+                    tokens.push_back(std::move(token));
+                reshadefx::token end = {};
+                end.id = tokenid::end_of_file;
+                tokens.push_back(std::move(end));
+            }
+
+            void scan(ReshadeEffectMetadata& metadata)
+            {
+                std::vector<bool> braces; // true for namespace braces, which stay in the global scope
+                size_t            depth = 0;
+                while (peek().id != tokenid::end_of_file)
+                {
+                    tokenid id = peek().id;
+                    if (id == tokenid::namespace_ && peek(1).id == tokenid::identifier && peek(2).id == tokenid::brace_open)
+                    {
+                        pos += 3;
+                        braces.push_back(true);
+                    }
+                    else if (id == tokenid::brace_open)
+                    {
+                        pos++;
+                        braces.push_back(false);
+                        depth++;
+                    }
+                    else if (id == tokenid::brace_close)
+                    {
+                        pos++;
+                        if (!braces.empty())
+                        {
+                            depth -= braces.back() ? 0 : 1;
+                            braces.pop_back();
+                        }
+                    }
+                    else if (depth == 0 && id == tokenid::technique && peek(1).id == tokenid::identifier)
+                    {
+                        metadata.techniques.push_back(peek(1).literal_as_string);
+                        pos += 2;
+                    }
+                    else if (depth == 0 && id == tokenid::uniform_)
+                    {
+                        pos++;
+                        parseUniform(metadata);
+                    }
+                    else
+                    {
+                        pos++;
+                    }
+                }
+            }
+
+        private:
+            std::vector<reshadefx::token> tokens;
+            size_t                        pos = 0;
+
+            const reshadefx::token& peek(size_t offset = 0) const
+            {
+                return tokens[std::min(pos + offset, tokens.size() - 1)];
+            }
+
+            bool accept(tokenid id)
+            {
+                if (peek().id != id)
+                    return false;
+                pos++;
+                return true;
+            }
+
+            // Skips to after the next ';' of this statement, stops in front of a closing bracket that isn't ours
+            void skipStatement()
+            {
+                int nesting = 0;
+                while (peek().id != tokenid::end_of_file)
+                {
+                    tokenid id = peek().id;
+                    if (id == tokenid::parenthesis_open || id == tokenid::brace_open || id == tokenid::bracket_open)
+                        nesting++;
+                    else if (id == tokenid::parenthesis_close || id == tokenid::brace_close || id == tokenid::bracket_close)
+                    {
+                        if (nesting == 0)
+                            return;
+                        nesting--;
+                    }
+                    else if (id == tokenid::semicolon && nesting == 0)
+                    {
+                        pos++;
+                        return;
+                    }
+                    pos++;
+                }
+            }
+
+            // Scalar and vector types of bool, int, uint and float, matrices are not exposed
+            static bool getType(tokenid id, char& baseType, uint32_t& rows)
+            {
+                static const std::pair<tokenid, char> scalarTypes[] = {
+                    {tokenid::bool_, 'b'}, {tokenid::int_, 'i'}, {tokenid::uint_, 'u'}, {tokenid::float_, 'f'}};
+                for (const auto& [scalar, base] : scalarTypes)
+                {
+                    int offset = (int) id - (int) scalar;
+                    if (offset >= 0 && offset < 4)
+                    {
+                        baseType = base;
+                        rows     = offset + 1;
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            // uniform <type> <name> [: semantic] [< annotations >] [= initializer];
+            void parseUniform(ReshadeEffectMetadata& metadata)
+            {
+                ReshadeUniformInfo info;
+                accept(tokenid::const_);
+                if (!getType(peek().id, info.baseType, info.rows) || peek(1).id != tokenid::identifier)
+                    return skipStatement();
+                info.name = peek(1).literal_as_string;
+                pos += 2;
+
+                // arrays are not exposed
+                if (peek().id == tokenid::bracket_open)
+                    return skipStatement();
+                if (accept(tokenid::colon))
+                    accept(tokenid::identifier);
+                if (accept(tokenid::less) && !parseAnnotations(info.annotations))
+                    return skipStatement();
+
+                // a non-constant initializer leaves the uniform at zero, like the code generator does
+                if (accept(tokenid::equal))
+                {
+                    info.hasInitializer = parseInitializer(info);
+                    if (!info.hasInitializer)
+                    {
+                        skipStatement();
+                        metadata.uniforms.push_back(std::move(info));
+                        return;
+                    }
+                }
+                if (!accept(tokenid::semicolon))
+                    return skipStatement();
+                metadata.uniforms.push_back(std::move(info));
+            }
+
+            // < [type] name = value; ... >
+            bool parseAnnotations(std::vector<ReshadeAnnotation>& annotations)
+            {
+                while (!accept(tokenid::greater))
+                {
+                    if (peek().id >= tokenid::bool_ && peek().id <= tokenid::string_)
+                        pos++;
+                    if (peek().id != tokenid::identifier || peek(1).id != tokenid::equal)
+                        return false;
+
+                    ReshadeAnnotation annotation;
+                    annotation.name = peek().literal_as_string;
+                    pos += 2;
+
+                    if (peek().id == tokenid::string_literal)
+                    {
+                        annotation.isString = true;
+                        while (peek().id == tokenid::string_literal)
+                            annotation.string += tokens[pos++].literal_as_string;
+                    }
+                    else if (!parseAdditive(annotation.number, annotation.isFloat))
+                    {
+                        return false;
+                    }
+
+                    if (!accept(tokenid::semicolon))
+                        return false;
+                    annotations.push_back(std::move(annotation));
+                }
+                return true;
+            }
+
+            // float3(a, b, c), { a, b, c } or a single value for all components
+            bool parseInitializer(ReshadeUniformInfo& info)
+            {
+                char     baseType;
+                uint32_t rows;
+                tokenid  closing;
+                if (getType(peek().id, baseType, rows) && peek(1).id == tokenid::parenthesis_open)
+                {
+                    pos += 2;
+                    closing = tokenid::parenthesis_close;
+                }
+                else if (accept(tokenid::brace_open))
+                {
+                    closing = tokenid::brace_close;
+                }
+                else
+                {
+                    bool isFloat;
+                    if (!parseAdditive(info.initializer[0], isFloat))
+                        return false;
+                    std::fill(info.initializer + 1, info.initializer + 4, info.initializer[0]);
+                    return true;
+                }
+
+                uint32_t count = 0;
+                do
+                {
+                    bool isFloat;
+                    if (count == 4 || !parseAdditive(info.initializer[count++], isFloat))
+                        return false;
+                } while (accept(tokenid::comma));
+
+                if (!accept(closing) || (count != 1 && count != info.rows))
+                    return false;
+                if (count == 1)
+                    std::fill(info.initializer + 1, info.initializer + 4, info.initializer[0]);
+                return true;
+            }
+
+            // Constant expressions with + - * / and parentheses, enough for annotations and initializers
+            bool parseAdditive(double& value, bool& isFloat)
+            {
+                if (!parseMultiplicative(value, isFloat))
+                    return false;
+                while (peek().id == tokenid::plus || peek().id == tokenid::minus)
+                {
+                    bool   subtract = tokens[pos++].id == tokenid::minus;
+                    double rhs;
+                    bool   rhsFloat;
+                    if (!parseMultiplicative(rhs, rhsFloat))
+                        return false;
+                    value   = subtract ? value - rhs : value + rhs;
+                    isFloat = isFloat || rhsFloat;
+                }
+                return true;
+            }
+
+            bool parseMultiplicative(double& value, bool& isFloat)
+            {
+                if (!parseUnary(value, isFloat))
+                    return false;
+                while (peek().id == tokenid::star || peek().id == tokenid::slash)
+                {
+                    bool   divide = tokens[pos++].id == tokenid::slash;
+                    double rhs;
+                    bool   rhsFloat;
+                    if (!parseUnary(rhs, rhsFloat))
+                        return false;
+                    isFloat = isFloat || rhsFloat;
+                    if (!divide)
+                        value *= rhs;
+                    else if (rhs == 0.0)
+                        return false;
+                    else
+                        value = isFloat ? value / rhs : (double) ((int64_t) value / (int64_t) rhs);
+                }
+                return true;
+            }
+
+            bool parseUnary(double& value, bool& isFloat)
+            {
+                const reshadefx::token& token = peek();
+                char                    baseType;
+                uint32_t                rows;
+                switch (token.id)
+                {
+                    case tokenid::minus:
+                        pos++;
+                        if (!parseUnary(value, isFloat))
+                            return false;
+                        value = -value;
+                        return true;
+                    case tokenid::plus:
+                        pos++;
+                        return parseUnary(value, isFloat);
+                    case tokenid::parenthesis_open:
+                        pos++;
+                        return parseAdditive(value, isFloat) && accept(tokenid::parenthesis_close);
+                    case tokenid::int_literal:
+                        pos++;
+                        value   = token.literal_as_int;
+                        isFloat = false;
+                        return true;
+                    case tokenid::uint_literal:
+                        pos++;
+                        value   = token.literal_as_uint;
+                        isFloat = false;
+                        return true;
+                    case tokenid::float_literal:
+                        pos++;
+                        value   = token.literal_as_float;
+                        isFloat = true;
+                        return true;
+                    case tokenid::double_literal:
+                        pos++;
+                        value   = token.literal_as_double;
+                        isFloat = true;
+                        return true;
+                    case tokenid::true_literal:
+                    case tokenid::false_literal:
+                        pos++;
+                        value   = token.id == tokenid::true_literal ? 1.0 : 0.0;
+                        isFloat = false;
+                        return true;
+                    default:
+                        // scalar casts like float(1)
+                        if (getType(token.id, baseType, rows) && rows == 1 && peek(1).id == tokenid::parenthesis_open)
+                        {
+                            pos += 2;
+                            if (!parseAdditive(value, isFloat) || !accept(tokenid::parenthesis_close))
+                                return false;
+                            isFloat = baseType == 'f';
+                            return true;
+                        }
+                        return false;
+                }
+            }
+        };
+
+        void writeString(std::ostream& out, const std::string& string)
+        {
+            uint32_t length = string.size();
+            out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+            out.write(string.data(), length);
+        }
+
+        bool readString(std::istream& in, std::string& string)
+        {
+            uint32_t length;
+            if (!in.read(reinterpret_cast<char*>(&length), sizeof(length)) || length > (1u << 24))
+                return false;
+            string.resize(length);
+            return (bool) in.read(string.data(), length);
+        }
+
+        template<typename T>
+        void writeValue(std::ostream& out, const T& value)
+        {
+            out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        template<typename T>
+        bool readValue(std::istream& in, T& value)
+        {
+            return (bool) in.read(reinterpret_cast<char*>(&value), sizeof(T));
+        }
+
+        bool readCount(std::istream& in, uint32_t& count)
+        {
+            return readValue(in, count) && count < (1u << 20);
+        }
+
+        bool readIndexEntry(const std::string& indexFile, std::vector<FileStamp>& stamps, ReshadeEffectMetadata& metadata)
+        {
+            std::ifstream in(indexFile, std::ios::binary);
+            if (!in.good())
+                return false;
+
+            char magic[8];
+            if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, indexMagic, sizeof(magic)) != 0)
+                return false;
+
+            uint32_t count;
+            if (!readCount(in, count))
+                return false;
+            stamps.resize(count);
+            for (auto& stamp : stamps)
+            {
+                if (!readString(in, stamp.path) || !readValue(in, stamp.size) || !readValue(in, stamp.mtime))
+                    return false;
+            }
+
+            if (!readString(in, metadata.errors) || !readCount(in, count))
+                return false;
+            metadata.usedMacros.resize(count);
+            for (auto& [name, value] : metadata.usedMacros)
+            {
+                if (!readString(in, name) || !readString(in, value))
+                    return false;
+            }
+
+            if (!readCount(in, count))
+                return false;
+            metadata.techniques.resize(count);
+            for (auto& technique : metadata.techniques)
+            {
+                if (!readString(in, technique))
+                    return false;
+            }
+
+            if (!readCount(in, count))
+                return false;
+            metadata.uniforms.resize(count);
+            for (auto& uniform : metadata.uniforms)
+            {
+                if (!readString(in, uniform.name) || !readValue(in, uniform.baseType) || !readValue(in, uniform.rows)
+                    || !readValue(in, uniform.hasInitializer) || !readValue(in, uniform.initializer) || !readCount(in, count))
+                    return false;
+                uniform.annotations.resize(count);
+                for (auto& annotation : uniform.annotations)
+                {
+                    if (!readString(in, annotation.name) || !readValue(in, annotation.isString) || !readValue(in, annotation.isFloat)
+                        || !readValue(in, annotation.number) || !readString(in, annotation.string))
+                        return false;
+                }
+            }
+
+            metadata.loaded = true;
+            return true;
+        }
+
+        void writeIndexEntry(const std::string& indexFile, const std::vector<FileStamp>& stamps, const ReshadeEffectMetadata& metadata)
+        {
+            std::error_code ec;
+            std::filesystem::create_directories(std::filesystem::path(indexFile).parent_path(), ec);
+
+            // write to a temporary file first so a crash never leaves a truncated entry behind,
+            // its name is unique so other processes and threads indexing the same effect don't interleave
+            std::string tempFile = indexFile + "." + std::to_string(getpid()) + "."
+                                 + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + ".tmp";
+            {
+                std::ofstream out(tempFile, std::ios::binary | std::ios::trunc);
+                out.write(indexMagic, sizeof(indexMagic));
+
+                writeValue<uint32_t>(out, stamps.size());
+                for (const auto& stamp : stamps)
+                {
+                    writeString(out, stamp.path);
+                    writeValue(out, stamp.size);
+                    writeValue(out, stamp.mtime);
+                }
+
+                writeString(out, metadata.errors);
+                writeValue<uint32_t>(out, metadata.usedMacros.size());
+                for (const auto& [name, value] : metadata.usedMacros)
+                {
+                    writeString(out, name);
+                    writeString(out, value);
+                }
+
+                writeValue<uint32_t>(out, metadata.techniques.size());
+                for (const auto& technique : metadata.techniques)
+                    writeString(out, technique);
+
+                writeValue<uint32_t>(out, metadata.uniforms.size());
+                for (const auto& uniform : metadata.uniforms)
+                {
+                    writeString(out, uniform.name);
+                    writeValue(out, uniform.baseType);
+                    writeValue(out, uniform.rows);
+                    writeValue(out, uniform.hasInitializer);
+                    writeValue(out, uniform.initializer);
+                    writeValue<uint32_t>(out, uniform.annotations.size());
+                    for (const auto& annotation : uniform.annotations)
+                    {
+                        writeString(out, annotation.name);
+                        writeValue(out, annotation.isString);
+                        writeValue(out, annotation.isFloat);
+                        writeValue(out, annotation.number);
+                        writeString(out, annotation.string);
+                    }
+                }
+
+                if (!out.good())
+                {
+                    Logger::warn("could not write effect metadata " + tempFile);
+                    std::filesystem::remove(tempFile, ec);
+                    return;
+                }
+            }
+            std::filesystem::rename(tempFile, indexFile, ec);
+            if (ec)
+            {
+                Logger::warn("could not write effect metadata " + indexFile);
+                std::filesystem::remove(tempFile, ec);
+            }
+        }
+
+        void extractMetadata(const std::string& effectPath, std::vector<FileStamp>& stamps, ReshadeEffectMetadata& metadata)
+        {
+            reshadefx::preprocessor preprocessor;
+            setupReshadePreprocessor(preprocessor);
+
+            metadata.loaded = preprocessor.append_file(effectPath);
+            metadata.errors = preprocessor.errors();
+            if (!metadata.loaded)
+                return;
+
+            metadata.usedMacros = preprocessor.used_macro_definitions();
+            DeclarationScanner(std::move(preprocessor.output())).scan(metadata);
+
+            for (const auto& file : preprocessor.included_files())
+            {
+                FileStamp stamp;
+                if (file.string() != effectPath && stampFile(file.string(), stamp))
+                    stamps.push_back(std::move(stamp));
+            }
+        }
+
+        struct MemoryEntry
+        {
+            std::vector<FileStamp>                       stamps;
+            std::shared_ptr<const ReshadeEffectMetadata> metadata;
+        };
+        std::mutex                                   cacheMutex;
+        std::unordered_map<std::string, MemoryEntry> memoryCache;
+    } // anonymous namespace
+
+    const ReshadeAnnotation* ReshadeUniformInfo::findAnnotation(const std::string& annotationName) const
+    {
+        for (const auto& annotation : annotations)
+        {
+            if (annotation.name == annotationName)
+                return &annotation;
+        }
+        return nullptr;
+    }
+
+    void setupReshadePreprocessor(reshadefx::preprocessor& pp)
+    {
+        pp.add_macro_definition("__RESHADE__", std::to_string(INT_MAX));
+        pp.add_macro_definition("__RESHADE_PERFORMANCE_MODE__", "1");
+        pp.add_macro_definition("__RENDERER__", "0x20000");
+        pp.add_macro_definition("BUFFER_WIDTH", "1920");
+        pp.add_macro_definition("BUFFER_HEIGHT", "1080");
+        pp.add_macro_definition("BUFFER_RCP_WIDTH", "(1.0 / BUFFER_WIDTH)");
+        pp.add_macro_definition("BUFFER_RCP_HEIGHT", "(1.0 / BUFFER_HEIGHT)");
+        pp.add_macro_definition("BUFFER_COLOR_DEPTH", "8");
+
+        // Add all discovered shader paths from shader manager
+        ShaderManagerConfig shaderMgrConfig = ConfigSerializer::loadShaderManagerConfig();
+        for (const auto& path : shaderMgrConfig.discoveredShaderPaths)
+            pp.add_include_path(path);
+    }
+
+    std::shared_ptr<const ReshadeEffectMetadata> loadReshadeMetadata(const std::string& effectPath)
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+
+        auto cached = memoryCache.find(effectPath);
+        if (cached != memoryCache.end() && stampsValid(cached->second.stamps))
+            return cached->second.metadata;
+
+        auto                   metadata = std::make_shared<ReshadeEffectMetadata>();
+        std::vector<FileStamp> stamps(1);
+        std::ifstream          file(effectPath, std::ios::binary);
+        if (!file.good() || !stampFile(effectPath, stamps[0]))
+        {
+            Logger::err("reshade_metadata: failed to load shader file: " + effectPath);
+            return metadata;
+        }
+
+        // Key: the file contents, the include paths and the scanner version
+        std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        uint64_t    hash = hashBytes(contents.data(), contents.size());
+        for (const auto& path : ConfigSerializer::loadShaderManagerConfig().discoveredShaderPaths)
+            hash = hashBytes(path.c_str(), path.size() + 1, hash);
+        hash = hashBytes(reinterpret_cast<const char*>(&metadataVersion), sizeof(metadataVersion), hash);
+
+        std::string indexDir = getIndexDir();
+        std::string indexFile;
+        if (!indexDir.empty())
+        {
+            std::stringstream name;
+            name << std::hex << hash << ".bin";
+            indexFile = indexDir + "/" + name.str();
+        }
+
+        std::vector<FileStamp> indexStamps;
+        if (!indexFile.empty() && readIndexEntry(indexFile, indexStamps, *metadata) && stampsValid(indexStamps))
+        {
+            Logger::debug("reshade_metadata: loaded " + effectPath + " from the index");
+            stamps.insert(stamps.end(), indexStamps.begin(), indexStamps.end());
+        }
+        else
+        {
+            *metadata = {};
+            std::vector<FileStamp> includes;
+            extractMetadata(effectPath, includes, *metadata);
+            if (!metadata->loaded)
+            {
+                Logger::err("reshade_metadata: failed to preprocess " + effectPath + ": " + metadata->errors);
+                return metadata;
+            }
+            if (!indexFile.empty())
+                writeIndexEntry(indexFile, includes, *metadata);
+            stamps.insert(stamps.end(), includes.begin(), includes.end());
+        }
+
+        memoryCache[effectPath] = {std::move(stamps), metadata};
+        return metadata;
+    }
+
+} // namespace vkBasalt
@@ -0,0 +1,60 @@
+#ifndef RESHADE_METADATA_HPP_INCLUDED
+#define RESHADE_METADATA_HPP_INCLUDED
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+namespace reshadefx
+{
+    class preprocessor;
+}
+
+namespace vkBasalt
+{
+    // Annotation value as written in the shader, numbers are kept as double
+    struct ReshadeAnnotation
+    {
+        std::string name;
+        bool        isString = false;
+        bool        isFloat  = false;
+        double      number   = 0.0;
+        std::string string;
+    };
+
+    struct ReshadeUniformInfo
+    {
+        std::string                    name;
+        char                           baseType = 'f'; // 'f'loat, 'i'nt, 'u'int or 'b'ool
+        uint32_t                       rows     = 1;
+        bool                           hasInitializer = false;
+        double                         initializer[4] = {};
+        std::vector<ReshadeAnnotation> annotations;
+
+        const ReshadeAnnotation* findAnnotation(const std::string& annotationName) const;
+    };
+
+    // What the overlay needs to know about a ReShade effect.
+    // Extracted from the preprocessed source by scanning the global declarations,
+    // function bodies are never parsed and no code is generated.
+    struct ReshadeEffectMetadata
+    {
+        std::vector<ReshadeUniformInfo>                  uniforms; // In declaration order
+        std::vector<std::string>                         techniques;
+        std::vector<std::pair<std::string, std::string>> usedMacros; // From the preprocessor, {name, value}
+        std::string                                      errors;     // Preprocessor errors
+        bool                                             loaded = false; // False if the file could not be read
+    };
+
+    // Macros and include paths shared by everything that preprocesses effects outside of ReshadeEffect
+    void setupReshadePreprocessor(reshadefx::preprocessor& pp);
+
+    // Returns the metadata of effectPath, kept in memory and in $XDG_CACHE_HOME/vkBasalt-overlay/metadata.
+    // The on-disk index is keyed by a hash of the file and the include paths,
+    // entries are dropped when an included file changed.
+    std::shared_ptr<const ReshadeEffectMetadata> loadReshadeMetadata(const std::string& effectPath);
+
+} // namespace vkBasalt
+
+#endif // RESHADE_METADATA_HPP_INCLUDED
@@ -1,6 +1,6 @@
 #include "reshade_parser.hpp"
 
-#include <climits>
+#include <type_traits>
 #include <algorithm>
 #include <filesystem>
 #include <set>
@@ -11,42 +11,26 @@
 
 #include "logger.hpp"
 #include "config_serializer.hpp"
+#include "reshade_metadata.hpp"
 
 namespace vkBasalt
 {
     namespace
     {
-        // Helper to find annotation by name
-        template<typename T>
-        auto findAnnotation(const T& annotations, const std::string& name)
+        float getAnnotationFloat(const ReshadeAnnotation& annotation)
         {
-            return std::find_if(annotations.begin(), annotations.end(),
-                [&name](const auto& a) { return a.name == name; });
+            return static_cast<float>(annotation.number);
         }
 
-        // Helper to check if annotation exists
-        template<typename T>
-        bool hasAnnotation(const T& annotations, const std::string& name)
+        int getAnnotationInt(const ReshadeAnnotation& annotation)
         {
-            return findAnnotation(annotations, name) != annotations.end();
+            return static_cast<int>(annotation.number);
         }
 
-        // Helper to get float value from annotation (handles int->float conversion)
-        template<typename T>
-        float getAnnotationFloat(const T& annotation)
+        std::string getAnnotationString(const ReshadeUniformInfo& uniform, const std::string& name, const std::string& fallback = "")
         {
-            return annotation.type.is_floating_point()
-                ? annotation.value.as_float[0]
-                : static_cast<float>(annotation.value.as_int[0]);
-        }
-
-        // Helper to get int value from annotation (handles float->int conversion)
-        template<typename T>
-        int getAnnotationInt(const T& annotation)
-        {
-            return annotation.type.is_integral()
-                ? annotation.value.as_int[0]
-                : static_cast<int>(annotation.value.as_float[0]);
+            const ReshadeAnnotation* annotation = uniform.findAnnotation(name);
+            return (annotation && annotation->isString) ? annotation->string : fallback;
         }
 
         // Parse null-separated string into vector
@@ -69,253 +53,125 @@ namespace vkBasalt
             return items;
         }
 
-        void setupPreprocessor(reshadefx::preprocessor& pp)
+        // Fields every parameter type has
+        void applyCommon(EffectParam& p, const ReshadeUniformInfo& uniform, const std::string& effectName)
         {
-            pp.add_macro_definition("__RESHADE__", std::to_string(INT_MAX));
-            pp.add_macro_definition("__RESHADE_PERFORMANCE_MODE__", "1");
-            pp.add_macro_definition("__RENDERER__", "0x20000");
-            pp.add_macro_definition("BUFFER_WIDTH", "1920");
-            pp.add_macro_definition("BUFFER_HEIGHT", "1080");
-            pp.add_macro_definition("BUFFER_RCP_WIDTH", "(1.0 / BUFFER_WIDTH)");
-            pp.add_macro_definition("BUFFER_RCP_HEIGHT", "(1.0 / BUFFER_HEIGHT)");
-            pp.add_macro_definition("BUFFER_COLOR_DEPTH", "8");
-
-            // Add all discovered shader paths from shader manager
-            ShaderManagerConfig shaderMgrConfig = ConfigSerializer::loadShaderManagerConfig();
-            for (const auto& path : shaderMgrConfig.discoveredShaderPaths)
-                pp.add_include_path(path);
+            p.effectName = effectName;
+            p.name = uniform.name;
+            p.label = getAnnotationString(uniform, "ui_label", uniform.name);
+            p.tooltip = getAnnotationString(uniform, "ui_tooltip");
+            p.uiType = getAnnotationString(uniform, "ui_type");
+            p.category = getAnnotationString(uniform, "ui_category");
         }
 
-        void applyFloatRange(FloatParam& p, const auto& annotations)
+        template<typename P, typename T>
+        void applyScalar(P& p, const ReshadeUniformInfo& uniform, const std::string& effectName, Config* pConfig)
         {
-            auto minIt = findAnnotation(annotations, "ui_min");
-            auto maxIt = findAnnotation(annotations, "ui_max");
-
-            if (minIt != annotations.end())
-                p.minValue = getAnnotationFloat(*minIt);
-            if (maxIt != annotations.end())
-                p.maxValue = getAnnotationFloat(*maxIt);
+            applyCommon(p, uniform, effectName);
+            p.defaultValue = static_cast<T>(uniform.initializer[0]);
+            p.value = pConfig->getInstanceOption<T>(effectName, uniform.name, p.defaultValue);
+
+            if (const ReshadeAnnotation* minIt = uniform.findAnnotation("ui_min"))
+                p.minValue = std::is_floating_point_v<T> ? getAnnotationFloat(*minIt) : static_cast<T>(getAnnotationInt(*minIt));
+            if (const ReshadeAnnotation* maxIt = uniform.findAnnotation("ui_max"))
+                p.maxValue = std::is_floating_point_v<T> ? getAnnotationFloat(*maxIt) : static_cast<T>(getAnnotationInt(*maxIt));
+            if (const ReshadeAnnotation* stepIt = uniform.findAnnotation("ui_step"))
+                p.step = getAnnotationFloat(*stepIt);
         }
 
-        void applyIntRange(IntParam& p, const auto& annotations)
+        // float2/3/4, int2/3/4 and uint2/3/4, each component is saved as name[i]
+        template<typename P, typename T>
+        void applyVector(P& p, const ReshadeUniformInfo& uniform, const std::string& effectName, Config* pConfig)
         {
-            auto minIt = findAnnotation(annotations, "ui_min");
-            auto maxIt = findAnnotation(annotations, "ui_max");
+            applyCommon(p, uniform, effectName);
+            p.componentCount = uniform.rows;
 
-            if (minIt != annotations.end())
-                p.minValue = getAnnotationInt(*minIt);
-            if (maxIt != annotations.end())
-                p.maxValue = getAnnotationInt(*maxIt);
+            const ReshadeAnnotation* minIt = uniform.findAnnotation("ui_min");
+            const ReshadeAnnotation* maxIt = uniform.findAnnotation("ui_max");
+            for (uint32_t c = 0; c < uniform.rows; c++)
+            {
+                std::string suffix = "[" + std::to_string(c) + "]";
+                p.defaultValue[c] = static_cast<T>(uniform.initializer[c]);
+                p.value[c] = pConfig->getInstanceOption<T>(effectName, uniform.name + suffix, p.defaultValue[c]);
+                if (minIt)
+                    p.minValue[c] = std::is_floating_point_v<T> ? getAnnotationFloat(*minIt) : static_cast<T>(getAnnotationInt(*minIt));
+                if (maxIt)
+                    p.maxValue[c] = std::is_floating_point_v<T> ? getAnnotationFloat(*maxIt) : static_cast<T>(getAnnotationInt(*maxIt));
+            }
+
+            if (const ReshadeAnnotation* stepIt = uniform.findAnnotation("ui_step"))
+                p.step = getAnnotationFloat(*stepIt);
         }
 
-        std::unique_ptr<EffectParam> convertSpecConstant(
-            const reshadefx::uniform_info& spec,
+        std::unique_ptr<EffectParam> convertUniform(
+            const ReshadeUniformInfo& uniform,
             const std::string& effectName,
             Config* pConfig)
         {
-            // Label (common to all types)
-            auto labelIt = findAnnotation(spec.annotations, "ui_label");
-            std::string label = (labelIt != spec.annotations.end()) ? labelIt->value.string_data : spec.name;
-
-            // Tooltip (common to all types)
-            auto tooltipIt = findAnnotation(spec.annotations, "ui_tooltip");
-            std::string tooltip = (tooltipIt != spec.annotations.end()) ? tooltipIt->value.string_data : "";
-
-            // UI type (common to all types)
-            auto typeIt = findAnnotation(spec.annotations, "ui_type");
-            std::string uiType = (typeIt != spec.annotations.end()) ? typeIt->value.string_data : "";
-
-            // Helper lambda to populate float vector parameters
-            auto populateFloatVector = [&](FloatVecParam& p, uint32_t componentCount) {
-                p.effectName = effectName;
-                p.name = spec.name;
-                p.label = label;
-                p.tooltip = tooltip;
-                p.uiType = uiType;
-                p.componentCount = componentCount;
-
-                auto minIt = findAnnotation(spec.annotations, "ui_min");
-                auto maxIt = findAnnotation(spec.annotations, "ui_max");
-                for (uint32_t c = 0; c < componentCount; c++)
-                {
-                    std::string suffix = "[" + std::to_string(c) + "]";
-                    p.defaultValue[c] = spec.initializer_value.as_float[c];
-                    p.value[c] = pConfig->getInstanceOption<float>(effectName, spec.name + suffix, p.defaultValue[c]);
-                    if (minIt != spec.annotations.end())
-                        p.minValue[c] = getAnnotationFloat(*minIt);
-                    if (maxIt != spec.annotations.end())
-                        p.maxValue[c] = getAnnotationFloat(*maxIt);
-                }
-
-                auto stepIt = findAnnotation(spec.annotations, "ui_step");
-                if (stepIt != spec.annotations.end())
-                    p.step = getAnnotationFloat(*stepIt);
-            };
-
-            // Helper lambda to populate int vector parameters
-            auto populateIntVector = [&](IntVecParam& p, uint32_t componentCount) {
-                p.effectName = effectName;
-                p.name = spec.name;
-                p.label = label;
-                p.tooltip = tooltip;
-                p.uiType = uiType;
-                p.componentCount = componentCount;
-
-                auto minIt = findAnnotation(spec.annotations, "ui_min");
-                auto maxIt = findAnnotation(spec.annotations, "ui_max");
-                for (uint32_t c = 0; c < componentCount; c++)
-                {
-                    std::string suffix = "[" + std::to_string(c) + "]";
-                    p.defaultValue[c] = spec.initializer_value.as_int[c];
-                    p.value[c] = pConfig->getInstanceOption<int32_t>(effectName, spec.name + suffix, p.defaultValue[c]);
-                    if (minIt != spec.annotations.end())
-                        p.minValue[c] = getAnnotationInt(*minIt);
-                    if (maxIt != spec.annotations.end())
-                        p.maxValue[c] = getAnnotationInt(*maxIt);
-                }
-
-                auto stepIt = findAnnotation(spec.annotations, "ui_step");
-                if (stepIt != spec.annotations.end())
-                    p.step = getAnnotationFloat(*stepIt);
-            };
-
-            // Helper lambda to populate uint vector parameters
-            auto populateUintVector = [&](UintVecParam& p, uint32_t componentCount) {
-                p.effectName = effectName;
-                p.name = spec.name;
-                p.label = label;
-                p.tooltip = tooltip;
-                p.uiType = uiType;
-                p.componentCount = componentCount;
-
-                auto minIt = findAnnotation(spec.annotations, "ui_min");
-                auto maxIt = findAnnotation(spec.annotations, "ui_max");
-                for (uint32_t c = 0; c < componentCount; c++)
-                {
-                    std::string suffix = "[" + std::to_string(c) + "]";
-                    p.defaultValue[c] = spec.initializer_value.as_uint[c];
-                    p.value[c] = pConfig->getInstanceOption<uint32_t>(effectName, spec.name + suffix, p.defaultValue[c]);
-                    if (minIt != spec.annotations.end())
-                        p.minValue[c] = static_cast<uint32_t>(getAnnotationInt(*minIt));
-                    if (maxIt != spec.annotations.end())
-                        p.maxValue[c] = static_cast<uint32_t>(getAnnotationInt(*maxIt));
-                }
-
-                auto stepIt = findAnnotation(spec.annotations, "ui_step");
-                if (stepIt != spec.annotations.end())
-                    p.step = getAnnotationFloat(*stepIt);
-            };
-
-            // Create appropriate subclass based on spec type
-            if (spec.type.is_floating_point() && spec.type.rows >= 2 && spec.type.rows <= 4)
-            {
-                // float2/float3/float4 vector types
-                auto p = std::make_unique<FloatVecParam>();
-                populateFloatVector(*p, spec.type.rows);
-                return p;
-            }
-            else if (spec.type.is_floating_point() && spec.type.rows == 1)
-            {
-                // scalar float
-                auto p = std::make_unique<FloatParam>();
-                p->effectName = effectName;
-                p->name = spec.name;
-                p->label = label;
-                p->tooltip = tooltip;
-                p->uiType = uiType;
-                p->defaultValue = spec.initializer_value.as_float[0];
-                p->value = pConfig->getInstanceOption<float>(effectName, spec.name, p->defaultValue);
-                applyFloatRange(*p, spec.annotations);
-
-                auto stepIt = findAnnotation(spec.annotations, "ui_step");
-                if (stepIt != spec.annotations.end())
-                    p->step = getAnnotationFloat(*stepIt);
-
-                return p;
-            }
-            else if (spec.type.is_boolean())
-            {
-                auto p = std::make_unique<BoolParam>();
-                p->effectName = effectName;
-                p->name = spec.name;
-                p->label = label;
-                p->tooltip = tooltip;
-                p->uiType = uiType;
-                p->defaultValue = (spec.initializer_value.as_uint[0] != 0);
-                p->value = pConfig->getInstanceOption<bool>(effectName, spec.name, p->defaultValue);
-                return p;
-            }
-            else if (spec.type.is_integral() && spec.type.is_signed() && spec.type.rows >= 2 && spec.type.rows <= 4)
-            {
-                // int2/int3/int4 vector types
-                auto p = std::make_unique<IntVecParam>();
-                populateIntVector(*p, spec.type.rows);
-                return p;
-            }
-            else if (spec.type.is_integral() && spec.type.is_signed() && spec.type.rows == 1)
-            {
-                // Scalar signed int
-                auto p = std::make_unique<IntParam>();
-                p->effectName = effectName;
-                p->name = spec.name;
-                p->label = label;
-                p->tooltip = tooltip;
-                p->uiType = uiType;
-                p->defaultValue = spec.initializer_value.as_int[0];
-                p->value = pConfig->getInstanceOption<int32_t>(effectName, spec.name, p->defaultValue);
-                applyIntRange(*p, spec.annotations);
-
-                auto stepIt = findAnnotation(spec.annotations, "ui_step");
-                if (stepIt != spec.annotations.end())
-                    p->step = getAnnotationFloat(*stepIt);
-
-                auto itemsIt = findAnnotation(spec.annotations, "ui_items");
-                if (itemsIt != spec.annotations.end())
-                    p->items = parseNullSeparatedString(itemsIt->value.string_data);
-
-                return p;
-            }
-            else if (spec.type.is_integral() && !spec.type.is_signed() && spec.type.rows >= 2 && spec.type.rows <= 4)
+            bool isVector = uniform.rows >= 2 && uniform.rows <= 4;
+            switch (uniform.baseType)
             {
-                // uint2/uint3/uint4 vector types
-                auto p = std::make_unique<UintVecParam>();
-                populateUintVector(*p, spec.type.rows);
-                return p;
-            }
-            else if (spec.type.is_integral() && !spec.type.is_signed() && spec.type.rows == 1)
-            {
-                // Scalar unsigned int
-                auto p = std::make_unique<UintParam>();
-                p->effectName = effectName;
-                p->name = spec.name;
-                p->label = label;
-                p->tooltip = tooltip;
-                p->uiType = uiType;
-                p->defaultValue = spec.initializer_value.as_uint[0];
-                p->value = pConfig->getInstanceOption<uint32_t>(effectName, spec.name, p->defaultValue);
-
-                auto minIt = findAnnotation(spec.annotations, "ui_min");
-                auto maxIt = findAnnotation(spec.annotations, "ui_max");
-                if (minIt != spec.annotations.end())
-                    p->minValue = static_cast<uint32_t>(getAnnotationInt(*minIt));
-                if (maxIt != spec.annotations.end())
-                    p->maxValue = static_cast<uint32_t>(getAnnotationInt(*maxIt));
-
-                auto stepIt = findAnnotation(spec.annotations, "ui_step");
-                if (stepIt != spec.annotations.end())
-                    p->step = getAnnotationFloat(*stepIt);
-
-                return p;
+                case 'f':
+                    if (isVector)
+                    {
+                        auto p = std::make_unique<FloatVecParam>();
+                        applyVector<FloatVecParam, float>(*p, uniform, effectName, pConfig);
+                        return p;
+                    }
+                    else
+                    {
+                        auto p = std::make_unique<FloatParam>();
+                        applyScalar<FloatParam, float>(*p, uniform, effectName, pConfig);
+                        return p;
+                    }
+                case 'i':
+                    if (isVector)
+                    {
+                        auto p = std::make_unique<IntVecParam>();
+                        applyVector<IntVecParam, int32_t>(*p, uniform, effectName, pConfig);
+                        return p;
+                    }
+                    else
+                    {
+                        auto p = std::make_unique<IntParam>();
+                        applyScalar<IntParam, int32_t>(*p, uniform, effectName, pConfig);
+                        if (const ReshadeAnnotation* itemsIt = uniform.findAnnotation("ui_items"))
+                            p->items = parseNullSeparatedString(itemsIt->string);
+                        return p;
+                    }
+                case 'u':
+                    if (isVector)
+                    {
+                        auto p = std::make_unique<UintVecParam>();
+                        applyVector<UintVecParam, uint32_t>(*p, uniform, effectName, pConfig);
+                        return p;
+                    }
+                    else
+                    {
+                        auto p = std::make_unique<UintParam>();
+                        applyScalar<UintParam, uint32_t>(*p, uniform, effectName, pConfig);
+                        return p;
+                    }
+                case 'b':
+                    if (!isVector)
+                    {
+                        auto p = std::make_unique<BoolParam>();
+                        applyCommon(*p, uniform, effectName);
+                        p->defaultValue = uniform.initializer[0] != 0.0;
+                        p->value = pConfig->getInstanceOption<bool>(effectName, uniform.name, p->defaultValue);
+                        return p;
+                    }
+                    return nullptr;
+                default:
+                    return nullptr;
             }
-
-            return nullptr;
         }
 
-        bool shouldSkipSpecConstant(const reshadefx::uniform_info& spec)
+        bool shouldSkipUniform(const ReshadeUniformInfo& uniform)
         {
-            if (spec.name.empty())
+            if (uniform.name.empty())
                 return true;
-            if (hasAnnotation(spec.annotations, "source"))
+            if (uniform.findAnnotation("source"))
                 return true;
             return false;
         }
@@ -328,177 +184,27 @@ namespace vkBasalt
     {
         std::vector<std::unique_ptr<EffectParam>> params;
 
-        // Setup preprocessor
-        reshadefx::preprocessor preprocessor;
-        setupPreprocessor(preprocessor);
-
-        if (!preprocessor.append_file(effectPath))
-        {
-            Logger::err("reshade_parser: failed to load shader file: " + effectPath);
+        auto metadata = loadReshadeMetadata(effectPath);
+        if (!metadata->loaded)
             return params;
-        }
-
-        std::string errors = preprocessor.errors();
-        if (!errors.empty())
-            Logger::err("reshade_parser preprocessor errors: " + errors);
-
-        // Parse
-        reshadefx::parser parser;
-        auto codegen = std::unique_ptr<reshadefx::codegen>(
-            reshadefx::create_codegen_spirv(true, true, true, true));
+        if (!metadata->errors.empty())
+            Logger::err("reshade_parser preprocessor errors: " + metadata->errors);
 
-        if (!parser.parse(std::move(preprocessor.output()), codegen.get()))
+        // Same order as the module the effect is compiled to: uniforms with a constant initializer
+        // become spec constants and come first, the others follow
+        for (bool specConstants : {true, false})
         {
-            errors = parser.errors();
-            if (!errors.empty())
-                Logger::err("reshade_parser parse errors: " + errors);
-            return params;
-        }
-
-        errors = parser.errors();
-        if (!errors.empty())
-            Logger::err("reshade_parser parse errors: " + errors);
-
-        // Extract module and convert uniforms to parameters
-        reshadefx::module module;
-        codegen->write_result(module);
-
-        // Process spec_constants
-        // Note: float2/float3/float4 are split into multiple scalar spec_constants with the same name
-        // We need to detect and combine them
-        for (size_t i = 0; i < module.spec_constants.size(); i++)
-        {
-            const auto& spec = module.spec_constants[i];
-
-            if (shouldSkipSpecConstant(spec))
-                continue;
-
-            // Check if this is part of a vector (same name appears multiple times consecutively)
-            size_t componentCount = 1;
-            while (i + componentCount < module.spec_constants.size() &&
-                   module.spec_constants[i + componentCount].name == spec.name)
-            {
-                componentCount++;
-            }
-
-            if (componentCount >= 2 && componentCount <= 4)
+            for (const auto& uniform : metadata->uniforms)
             {
-                // Vector type - combine multiple scalar spec_constants with same name
-                auto labelIt = findAnnotation(spec.annotations, "ui_label");
-                std::string label = (labelIt != spec.annotations.end()) ? labelIt->value.string_data : spec.name;
-
-                auto tooltipIt = findAnnotation(spec.annotations, "ui_tooltip");
-                std::string tooltip = (tooltipIt != spec.annotations.end()) ? tooltipIt->value.string_data : "";
-
-                auto typeIt = findAnnotation(spec.annotations, "ui_type");
-                std::string uiType = (typeIt != spec.annotations.end()) ? typeIt->value.string_data : "";
-
-                auto minIt = findAnnotation(spec.annotations, "ui_min");
-                auto maxIt = findAnnotation(spec.annotations, "ui_max");
-                auto stepIt = findAnnotation(spec.annotations, "ui_step");
-
-                if (spec.type.is_floating_point())
-                {
-                    // float2/float3/float4
-                    auto p = std::make_unique<FloatVecParam>();
-                    p->effectName = effectName;
-                    p->name = spec.name;
-                    p->label = label;
-                    p->tooltip = tooltip;
-                    p->uiType = uiType;
-                    p->componentCount = static_cast<uint32_t>(componentCount);
-
-                    for (size_t c = 0; c < componentCount; c++)
-                    {
-                        std::string suffix = "[" + std::to_string(c) + "]";
-                        p->defaultValue[c] = module.spec_constants[i + c].initializer_value.as_float[0];
-                        p->value[c] = pConfig->getInstanceOption<float>(effectName, spec.name + suffix, p->defaultValue[c]);
-                        if (minIt != spec.annotations.end())
-                            p->minValue[c] = getAnnotationFloat(*minIt);
-                        if (maxIt != spec.annotations.end())
-                            p->maxValue[c] = getAnnotationFloat(*maxIt);
-                    }
-                    if (stepIt != spec.annotations.end())
-                        p->step = getAnnotationFloat(*stepIt);
-
-                    params.push_back(std::move(p));
-                }
-                else if (spec.type.is_integral() && spec.type.is_signed())
-                {
-                    // int2/int3/int4
-                    auto p = std::make_unique<IntVecParam>();
-                    p->effectName = effectName;
-                    p->name = spec.name;
-                    p->label = label;
-                    p->tooltip = tooltip;
-                    p->uiType = uiType;
-                    p->componentCount = static_cast<uint32_t>(componentCount);
-
-                    for (size_t c = 0; c < componentCount; c++)
-                    {
-                        std::string suffix = "[" + std::to_string(c) + "]";
-                        p->defaultValue[c] = module.spec_constants[i + c].initializer_value.as_int[0];
-                        p->value[c] = pConfig->getInstanceOption<int32_t>(effectName, spec.name + suffix, p->defaultValue[c]);
-                        if (minIt != spec.annotations.end())
-                            p->minValue[c] = getAnnotationInt(*minIt);
-                        if (maxIt != spec.annotations.end())
-                            p->maxValue[c] = getAnnotationInt(*maxIt);
-                    }
-                    if (stepIt != spec.annotations.end())
-                        p->step = getAnnotationFloat(*stepIt);
-
-                    params.push_back(std::move(p));
-                }
-                else if (spec.type.is_integral() && !spec.type.is_signed())
-                {
-                    // uint2/uint3/uint4
-                    auto p = std::make_unique<UintVecParam>();
-                    p->effectName = effectName;
-                    p->name = spec.name;
-                    p->label = label;
-                    p->tooltip = tooltip;
-                    p->uiType = uiType;
-                    p->componentCount = static_cast<uint32_t>(componentCount);
-
-                    for (size_t c = 0; c < componentCount; c++)
-                    {
-                        std::string suffix = "[" + std::to_string(c) + "]";
-                        p->defaultValue[c] = module.spec_constants[i + c].initializer_value.as_uint[0];
-                        p->value[c] = pConfig->getInstanceOption<uint32_t>(effectName, spec.name + suffix, p->defaultValue[c]);
-                        if (minIt != spec.annotations.end())
-                            p->minValue[c] = static_cast<uint32_t>(getAnnotationInt(*minIt));
-                        if (maxIt != spec.annotations.end())
-                            p->maxValue[c] = static_cast<uint32_t>(getAnnotationInt(*maxIt));
-                    }
-                    if (stepIt != spec.annotations.end())
-                        p->step = getAnnotationFloat(*stepIt);
-
-                    params.push_back(std::move(p));
-                }
+                if (uniform.hasInitializer != specConstants || shouldSkipUniform(uniform))
+                    continue;
 
-                // Skip the remaining components since we've already processed them
-                i += componentCount - 1;
-            }
-            else
-            {
-                // Regular scalar parameter
-                auto param = convertSpecConstant(spec, effectName, pConfig);
+                auto param = convertUniform(uniform, effectName, pConfig);
                 if (param)
                     params.push_back(std::move(param));
             }
         }
 
-        // Process uniforms (runtime-changeable values)
-        for (const auto& uniform : module.uniforms)
-        {
-            if (shouldSkipSpecConstant(uniform))
-                continue;
-
-            auto param = convertSpecConstant(uniform, effectName, pConfig);
-            if (param)
-                params.push_back(std::move(param));
-        }
-
         return params;
     }
 
@@ -514,7 +220,7 @@ namespace vkBasalt
         {
             // Setup preprocessor with include paths
             reshadefx::preprocessor preprocessor;
-            setupPreprocessor(preprocessor);
+            setupReshadePreprocessor(preprocessor);
 
             // Try to load and preprocess the file
             if (!preprocessor.append_file(effectPath))
@@ -614,20 +320,15 @@ namespace vkBasalt
     {
         std::vector<PreprocessorDefinition> defs;
 
-        // Setup preprocessor
-        reshadefx::preprocessor preprocessor;
-        setupPreprocessor(preprocessor);
-
-        if (!preprocessor.append_file(effectPath))
+        auto metadata = loadReshadeMetadata(effectPath);
+        if (!metadata->loaded)
         {
             Logger::err("extractPreprocessorDefinitions: failed to load shader: " + effectPath);
             return defs;
         }
 
-        // Get all macros that were actually used in the shader
-        auto usedMacros = preprocessor.used_macro_definitions();
-
-        for (const auto& [name, value] : usedMacros)
+        // Macros that were actually used in the shader, recorded when the metadata was extracted
+        for (const auto& [name, value] : metadata->usedMacros)
         {
             // Skip built-in macros
             if (builtInMacros.count(name))
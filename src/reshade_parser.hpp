@@ -20,7 +20,7 @@ namespace vkBasalt
         std::string errorMessage;   // Error message if failed
     };
 
-    // Parse a ReShade .fx file and extract its parameters without creating Vulkan resources.
+    // Extract the parameters of a ReShade .fx file from its cached metadata, the shader is not compiled.
     // effectName: display name for the effect (used in EffectParam.effectName)
     // effectPath: full path to the .fx file
     // pConfig: config for getting includePath and current param values
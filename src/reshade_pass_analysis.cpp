@@ -0,0 +1,265 @@
+#include "reshade_pass_analysis.hpp"
+
+#include <unordered_set>
+
+#include "reshade/spirv.hpp"
+
+#include "logger.hpp"
+
+namespace vkBasalt
+{
+    namespace
+    {
+        struct Block
+        {
+            std::vector<uint32_t> operands; // every operand word, treated as possible ids
+            std::vector<uint32_t> calls;
+            std::vector<uint32_t> successors;
+            uint32_t              condition  = 0; // for OpBranchConditional, successors are {true, false}
+            bool                  isBranchIf = false;
+        };
+
+        struct Function
+        {
+            uint32_t                            firstBlock = 0;
+            std::unordered_map<uint32_t, Block> blocks;
+        };
+
+        // Just enough of a SPIR-V reader to know which global ids an entry point can reach
+        class SpirvReachability
+        {
+        public:
+            SpirvReachability(const std::vector<uint32_t>& spirv, const std::unordered_map<uint32_t, bool>& boolSpecConstants)
+            {
+                std::unordered_map<uint32_t, uint32_t> specIds;
+                std::unordered_map<uint32_t, bool>     specDefaults;
+
+                Function* function = nullptr;
+                Block*    block    = nullptr;
+
+                for (size_t i = 5; i < spirv.size();)
+                {
+                    uint32_t wordCount = spirv[i] >> 16;
+                    uint32_t opcode    = spirv[i] & 0xFFFF;
+                    if (wordCount == 0 || i + wordCount > spirv.size())
+                    {
+                        Logger::warn("pass analysis: malformed SPIR-V");
+                        valid = false;
+                        return;
+                    }
+                    const uint32_t* words = &spirv[i];
+
+                    switch (opcode)
+                    {
+                        case spv::OpEntryPoint:
+                            entryPoints[reinterpret_cast<const char*>(&words[3])] = words[2];
+                            break;
+                        case spv::OpDecorate:
+                            if (words[2] == spv::DecorationSpecId)
+                                specIds[words[1]] = words[3];
+                            break;
+                        case spv::OpConstantTrue: knownBools[words[2]] = true; break;
+                        case spv::OpConstantFalse: knownBools[words[2]] = false; break;
+                        case spv::OpSpecConstantTrue: specDefaults[words[2]] = true; break;
+                        case spv::OpSpecConstantFalse: specDefaults[words[2]] = false; break;
+                        case spv::OpFunction:
+                            function = &functions[words[2]];
+                            break;
+                        case spv::OpFunctionEnd:
+                            function = nullptr;
+                            block    = nullptr;
+                            break;
+                        case spv::OpLabel:
+                            if (function)
+                            {
+                                block = &function->blocks[words[1]];
+                                if (!function->firstBlock)
+                                    function->firstBlock = words[1];
+                            }
+                            break;
+                        default:
+                            if (!block)
+                                break;
+                            block->operands.insert(block->operands.end(), words + 1, words + wordCount);
+                            switch (opcode)
+                            {
+                                case spv::OpFunctionCall: block->calls.push_back(words[3]); break;
+                                case spv::OpLogicalNot: negations[words[2]] = words[3]; break;
+                                case spv::OpBranch: block->successors.push_back(words[1]); break;
+                                case spv::OpBranchConditional:
+                                    block->condition  = words[1];
+                                    block->isBranchIf = true;
+                                    block->successors.push_back(words[2]);
+                                    block->successors.push_back(words[3]);
+                                    break;
+                                case spv::OpSwitch:
+                                    block->successors.push_back(words[2]);
+                                    for (uint32_t j = 4; j < wordCount; j += 2)
+                                        block->successors.push_back(words[j]);
+                                    break;
+                                // merge targets are reachable whenever the header is, unless every path returns
+                                case spv::OpSelectionMerge: block->successors.push_back(words[1]); break;
+                                case spv::OpLoopMerge:
+                                    block->successors.push_back(words[1]);
+                                    block->successors.push_back(words[2]);
+                                    break;
+                                default: break;
+                            }
+                            break;
+                    }
+                    i += wordCount;
+                }
+
+                for (const auto& [id, value] : specDefaults)
+                {
+                    auto specId = specIds.find(id);
+                    auto custom = specId != specIds.end() ? boolSpecConstants.find(specId->second) : boolSpecConstants.end();
+                    knownBools[id] = custom != boolSpecConstants.end() ? custom->second : value;
+                }
+            }
+
+            bool isValid() const { return valid; }
+
+            // Adds every id referenced by code reachable from the entry point, false if it does not exist
+            bool collectIds(const std::string& entryPoint, std::unordered_set<uint32_t>& ids)
+            {
+                auto entry = entryPoints.find(entryPoint);
+                if (entry == entryPoints.end())
+                    return false;
+                std::unordered_set<uint32_t> visitedFunctions;
+                collectFunction(entry->second, ids, visitedFunctions);
+                return true;
+            }
+
+        private:
+            // 1 = true, 0 = false, -1 = not known before specialization
+            int evaluate(uint32_t id) const
+            {
+                for (bool negate = false;; negate = !negate)
+                {
+                    if (auto known = knownBools.find(id); known != knownBools.end())
+                        return known->second != negate;
+                    auto negation = negations.find(id);
+                    if (negation == negations.end())
+                        return -1;
+                    id = negation->second;
+                }
+            }
+
+            void collectFunction(uint32_t functionId, std::unordered_set<uint32_t>& ids, std::unordered_set<uint32_t>& visitedFunctions)
+            {
+                if (!visitedFunctions.insert(functionId).second)
+                    return;
+                auto function = functions.find(functionId);
+                if (function == functions.end())
+                    return;
+
+                std::unordered_set<uint32_t> visitedBlocks;
+                std::vector<uint32_t>        pending = {function->second.firstBlock};
+                while (!pending.empty())
+                {
+                    uint32_t label = pending.back();
+                    pending.pop_back();
+                    if (!visitedBlocks.insert(label).second)
+                        continue;
+                    auto block = function->second.blocks.find(label);
+                    if (block == function->second.blocks.end())
+                        continue;
+
+                    ids.insert(block->second.operands.begin(), block->second.operands.end());
+                    for (uint32_t callee : block->second.calls)
+                        collectFunction(callee, ids, visitedFunctions);
+
+                    int condition = block->second.isBranchIf ? evaluate(block->second.condition) : -1;
+                    for (size_t i = 0; i < block->second.successors.size(); i++)
+                    {
+                        // successors[0] and [1] are the true and false targets of a conditional branch
+                        if ((condition == 1 && i == 1) || (condition == 0 && i == 0))
+                            continue;
+                        pending.push_back(block->second.successors[i]);
+                    }
+                }
+            }
+
+            bool                                   valid = true;
+            std::unordered_map<std::string, uint32_t> entryPoints;
+            std::unordered_map<uint32_t, Function> functions;
+            std::unordered_map<uint32_t, bool>     knownBools;
+            std::unordered_map<uint32_t, uint32_t> negations;
+        };
+
+        bool writesStencil(const reshadefx::pass_info& pass)
+        {
+            return pass.stencil_enable
+                   && (pass.stencil_op_pass != reshadefx::pass_stencil_op::keep || pass.stencil_op_fail != reshadefx::pass_stencil_op::keep
+                       || pass.stencil_op_depth_fail != reshadefx::pass_stencil_op::keep);
+        }
+    } // namespace
+
+    ReshadePassUsage analyzeReshadePasses(const reshadefx::module& module, const std::unordered_map<uint32_t, bool>& boolSpecConstants)
+    {
+        ReshadePassUsage usage;
+        if (module.techniques.empty())
+            return usage;
+
+        const auto& passes = module.techniques[0].passes;
+        usage.livePasses.assign(passes.size(), false);
+
+        SpirvReachability reachability(module.spirv, boolSpecConstants);
+
+        // textures sampled by each pass
+        std::vector<std::set<std::string>> reads(passes.size());
+        for (size_t i = 0; i < passes.size(); i++)
+        {
+            std::unordered_set<uint32_t> ids;
+            bool known = reachability.isValid() && reachability.collectIds(passes[i].vs_entry_point, ids)
+                         && reachability.collectIds(passes[i].ps_entry_point, ids);
+            for (const auto& sampler : module.samplers)
+            {
+                if (!known || ids.count(sampler.id))
+                    reads[i].insert(sampler.texture_name);
+            }
+        }
+
+        for (size_t i = 0; i < passes.size(); i++)
+            usage.livePasses[i] = passes[i].render_target_names[0].empty();
+
+        // a pass is live once something live reads one of its targets or tests the stencil it writes,
+        // textures persist between frames so the order of passes does not matter
+        for (bool changed = true; changed;)
+        {
+            changed = false;
+
+            bool liveStencilTest = false;
+            for (size_t i = 0; i < passes.size(); i++)
+            {
+                if (!usage.livePasses[i])
+                    continue;
+                usage.liveTextures.insert(reads[i].begin(), reads[i].end());
+                liveStencilTest |= passes[i].stencil_enable != 0;
+            }
+
+            for (size_t i = 0; i < passes.size(); i++)
+            {
+                if (usage.livePasses[i])
+                    continue;
+                bool live = liveStencilTest && writesStencil(passes[i]);
+                for (int j = 0; j < 8 && !live && !passes[i].render_target_names[j].empty(); j++)
+                    live = usage.liveTextures.count(passes[i].render_target_names[j]) != 0;
+                if (live)
+                {
+                    usage.livePasses[i] = true;
+                    changed             = true;
+                }
+            }
+        }
+
+        for (size_t i = 0; i < passes.size(); i++)
+        {
+            for (int j = 0; j < 8 && usage.livePasses[i] && !passes[i].render_target_names[j].empty(); j++)
+                usage.liveTextures.insert(passes[i].render_target_names[j]);
+        }
+
+        return usage;
+    }
+} // namespace vkBasalt
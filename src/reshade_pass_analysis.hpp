@@ -0,0 +1,26 @@
+#ifndef RESHADE_PASS_ANALYSIS_HPP_INCLUDED
+#define RESHADE_PASS_ANALYSIS_HPP_INCLUDED
+#include <vector>
+#include <string>
+#include <set>
+#include <unordered_map>
+
+#include "reshade/effect_module.hpp"
+
+namespace vkBasalt
+{
+    struct ReshadePassUsage
+    {
+        std::vector<bool>     livePasses;   // per pass of the first technique
+        std::set<std::string> liveTextures; // unique names of textures a live pass reads or writes
+    };
+
+    // Finds the passes of the first technique whose output reaches the back buffer,
+    // directly or through render targets read by other live passes (also across frames).
+    // Sampler reads are taken from the SPIR-V of each entry point; branches on boolean spec
+    // constants are followed with the given values (spec id -> value), so a texture only
+    // sampled behind a disabled toggle does not keep its producing passes alive.
+    ReshadePassUsage analyzeReshadePasses(const reshadefx::module& module, const std::unordered_map<uint32_t, bool>& boolSpecConstants);
+} // namespace vkBasalt
+
+#endif // RESHADE_PASS_ANALYSIS_HPP_INCLUDED
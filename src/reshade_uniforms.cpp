@@ -4,206 +4,307 @@
 #include <ctime>
 #include <cstdlib>
 #include <cmath>
+#include <cstddef>
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 
 #include "logger.hpp"
+#include "keyboard_input.hpp"
+#include "mouse_input.hpp"
 
 namespace vkBasalt
 {
+    namespace
+    {
+        FrameUniforms frameUniforms;
+
+        // How many loaded effects read each key / the mouse, so that only those get queried
+        std::array<std::atomic<uint32_t>, 256> keyUsers   = {};
+        std::atomic<uint32_t>                  mouseUsers = 0;
+
+        // Distinguishes random/pingpong uniforms that would otherwise see the same frame seed
+        std::atomic<uint32_t> nextSalt = 1;
+
+        std::chrono::steady_clock::time_point startTime     = std::chrono::steady_clock::now();
+        std::chrono::steady_clock::time_point lastFrameTime = startTime;
+        std::time_t                           lastDateTime  = 0;
+        bool                                  hasLastMouse  = false;
+
+        uint32_t hash(uint32_t x)
+        {
+            x ^= x >> 16;
+            x *= 0x7feb352dU;
+            x ^= x >> 15;
+            x *= 0x846ca68bU;
+            x ^= x >> 16;
+            return x;
+        }
+
+        // Windows virtual key code (what ReShade effects use) to X11 keysym, 0 if unknown
+        uint32_t virtualKeyToKeySym(uint32_t vk)
+        {
+            if (vk >= 0x30 && vk <= 0x39) // 0-9
+                return vk;
+            if (vk >= 0x41 && vk <= 0x5A) // A-Z -> XK_a..XK_z
+                return vk + 0x20;
+            if (vk >= 0x60 && vk <= 0x69) // numpad 0-9 -> XK_KP_0..XK_KP_9
+                return 0xFFB0 + (vk - 0x60);
+            if (vk >= 0x70 && vk <= 0x87) // F1-F24 -> XK_F1..XK_F24
+                return 0xFFBE + (vk - 0x70);
+            switch (vk)
+            {
+                case 0x08: return 0xFF08; // backspace
+                case 0x09: return 0xFF09; // tab
+                case 0x0D: return 0xFF0D; // return
+                case 0x10: return 0xFFE1; // shift
+                case 0x11: return 0xFFE3; // control
+                case 0x12: return 0xFFE9; // alt
+                case 0x13: return 0xFF13; // pause
+                case 0x14: return 0xFFE5; // caps lock
+                case 0x1B: return 0xFF1B; // escape
+                case 0x20: return 0x0020; // space
+                case 0x21: return 0xFF55; // page up
+                case 0x22: return 0xFF56; // page down
+                case 0x23: return 0xFF57; // end
+                case 0x24: return 0xFF50; // home
+                case 0x25: return 0xFF51; // left
+                case 0x26: return 0xFF52; // up
+                case 0x27: return 0xFF53; // right
+                case 0x28: return 0xFF54; // down
+                case 0x2C: return 0xFF61; // print
+                case 0x2D: return 0xFF63; // insert
+                case 0x2E: return 0xFFFF; // delete
+                case 0xA0: return 0xFFE1; // left shift
+                case 0xA1: return 0xFFE2; // right shift
+                case 0xA2: return 0xFFE3; // left control
+                case 0xA3: return 0xFFE4; // right control
+                case 0xA4: return 0xFFE9; // left alt
+                case 0xA5: return 0xFFEA; // right alt
+                default: return 0;
+            }
+        }
+
+        const reshadefx::annotation* findAnnotation(const reshadefx::uniform_info& uniformInfo, const std::string& name)
+        {
+            auto it = std::find_if(uniformInfo.annotations.begin(), uniformInfo.annotations.end(), [&](const auto& a) { return a.name == name; });
+            return it != uniformInfo.annotations.end() ? &*it : nullptr;
+        }
+
+        uint32_t getKeycode(const reshadefx::uniform_info& uniformInfo)
+        {
+            const reshadefx::annotation* keycode = findAnnotation(uniformInfo, "keycode");
+            if (!keycode)
+                return 0;
+            return keycode->type.is_floating_point() ? static_cast<uint32_t>(keycode->value.as_float[0]) : keycode->value.as_uint[0];
+        }
+
+        bool isPressOrToggle(const reshadefx::uniform_info& uniformInfo)
+        {
+            const reshadefx::annotation* mode = findAnnotation(uniformInfo, "mode");
+            return mode && (mode->value.string_data == "press" || mode->value.string_data == "toggle");
+        }
+    } // namespace
+
     void enumerateReshadeUniforms(reshadefx::module module)
     {
         for (auto& uniform : module.uniforms)
         {
-            auto source = std::find_if(uniform.annotations.begin(), uniform.annotations.end(), [](const auto& a) {
-                              return a.name == "source";
-                          })->value.string_data;
-            Logger::debug(source);
+            const reshadefx::annotation* source = findAnnotation(uniform, "source");
+            Logger::debug(source ? source->value.string_data : uniform.name);
             Logger::debug("size: " + std::to_string(uniform.size));
             Logger::debug("offset: " + std::to_string(uniform.offset));
         }
     }
 
-    std::vector<std::shared_ptr<ReshadeUniform>> createReshadeUniforms(reshadefx::module module)
+    void updateFrameUniforms(bool hasDepth)
+    {
+        auto now = std::chrono::steady_clock::now();
+
+        frameUniforms.frameTime = std::chrono::duration<float, std::milli>(now - lastFrameTime).count();
+        frameUniforms.timer     = std::chrono::duration<float, std::milli>(now - startTime).count();
+        frameUniforms.frameCount++;
+        lastFrameTime = now;
+
+        frameUniforms.randomSeed = hash(static_cast<uint32_t>(frameUniforms.frameCount) ^ static_cast<uint32_t>(now.time_since_epoch().count()));
+        frameUniforms.hasDepth   = hasDepth ? VK_TRUE : VK_FALSE;
+
+        // localtime is comparatively expensive, the date only changes once per second
+        std::time_t nowC = std::time(nullptr);
+        if (nowC != lastDateTime)
+        {
+            lastDateTime = nowC;
+            struct tm currentTime;
+            localtime_r(&nowC, &currentTime);
+            frameUniforms.date[0] = 1900.0f + static_cast<float>(currentTime.tm_year);
+            frameUniforms.date[1] = 1.0f + static_cast<float>(currentTime.tm_mon);
+            frameUniforms.date[2] = static_cast<float>(currentTime.tm_mday);
+            frameUniforms.date[3] = static_cast<float>((currentTime.tm_hour * 60 + currentTime.tm_min) * 60 + currentTime.tm_sec);
+        }
+
+        if (mouseUsers.load(std::memory_order_relaxed))
+        {
+            MouseState mouse = getPointerState();
+            float      x     = static_cast<float>(mouse.x);
+            float      y     = static_cast<float>(mouse.y);
+
+            frameUniforms.mouseDelta[0]   = hasLastMouse ? x - frameUniforms.mousePoint[0] : 0.0f;
+            frameUniforms.mouseDelta[1]   = hasLastMouse ? y - frameUniforms.mousePoint[1] : 0.0f;
+            frameUniforms.mousePoint[0]   = x;
+            frameUniforms.mousePoint[1]   = y;
+            frameUniforms.mouseButtons[0] = mouse.leftButton;
+            frameUniforms.mouseButtons[1] = mouse.rightButton;
+            frameUniforms.mouseButtons[2] = mouse.middleButton;
+            hasLastMouse                  = true;
+        }
+        else
+        {
+            hasLastMouse = false;
+        }
+
+        for (uint32_t vk = 0; vk < keyUsers.size(); vk++)
+        {
+            if (keyUsers[vk].load(std::memory_order_relaxed))
+                frameUniforms.keys[vk] = isKeyPressed(virtualKeyToKeySym(vk)) ? VK_TRUE : VK_FALSE;
+        }
+    }
+
+    const FrameUniforms& getFrameUniforms()
+    {
+        return frameUniforms;
+    }
+
+    void setFrameUniforms(const FrameUniforms& frame)
+    {
+        frameUniforms = frame;
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////////////////
+    ReshadeUniforms::ReshadeUniforms(const reshadefx::module& module)
     {
-        std::vector<std::shared_ptr<ReshadeUniform>> uniforms;
         for (auto& uniform : module.uniforms)
         {
-            auto source = std::find_if(uniform.annotations.begin(), uniform.annotations.end(), [](const auto& a) {
-                              return a.name == "source";
-                          })->value.string_data;
+            const reshadefx::annotation* sourceAnnotation = findAnnotation(uniform, "source");
+            if (!sourceAnnotation)
+                continue;
+            const std::string& source = sourceAnnotation->value.string_data;
+
+            auto addCopy = [&](size_t srcOffset, size_t srcSize) {
+                copies.push_back({uniform.offset, static_cast<uint32_t>(srcOffset), std::min(uniform.size, static_cast<uint32_t>(srcSize))});
+            };
+
             if (source == "frametime")
             {
-                uniforms.push_back(std::shared_ptr<ReshadeUniform>(new FrameTimeUniform(uniform)));
+                addCopy(offsetof(FrameUniforms, frameTime), sizeof(float));
             }
             else if (source == "framecount")
             {
-                uniforms.push_back(std::shared_ptr<ReshadeUniform>(new FrameCountUniform(uniform)));
+                addCopy(offsetof(FrameUniforms, frameCount), sizeof(int32_t));
             }
             else if (source == "date")
             {
-                uniforms.push_back(std::shared_ptr<ReshadeUniform>(new DateUniform(uniform)));
+                addCopy(offsetof(FrameUniforms, date), sizeof(float) * 4);
             }
             else if (source == "timer")
             {
-                uniforms.push_back(std::shared_ptr<ReshadeUniform>(new TimerUniform(uniform)));
+                addCopy(offsetof(FrameUniforms, timer), sizeof(float));
             }
             else if (source == "pingpong")
             {
-                uniforms.push_back(std::shared_ptr<ReshadeUniform>(new PingPongUniform(uniform)));
+                stateful.push_back(std::make_unique<PingPongUniform>(uniform));
             }
             else if (source == "random")
             {
-                uniforms.push_back(std::shared_ptr<ReshadeUniform>(new RandomUniform(uniform)));
+                stateful.push_back(std::make_unique<RandomUniform>(uniform));
             }
             else if (source == "key")
             {
-                uniforms.push_back(std::shared_ptr<ReshadeUniform>(new KeyUniform(uniform)));
+                uint32_t keycode = getKeycode(uniform);
+                if (keycode >= 256 || !virtualKeyToKeySym(keycode))
+                {
+                    Logger::warn("unsupported keycode " + std::to_string(keycode) + " for uniform " + uniform.name);
+                    continue;
+                }
+                usedKeys.push_back(keycode);
+                keyUsers[keycode]++;
+                uint32_t stateOffset = offsetof(FrameUniforms, keys) + keycode * sizeof(VkBool32);
+                if (isPressOrToggle(uniform))
+                    stateful.push_back(std::make_unique<KeyUniform>(uniform, stateOffset));
+                else
+                    addCopy(stateOffset, sizeof(VkBool32));
             }
             else if (source == "mousebutton")
             {
-                uniforms.push_back(std::shared_ptr<ReshadeUniform>(new MouseButtonUniform(uniform)));
+                // X11 pointer state only has left, right and middle, x1 and x2 would always read as up
+                uint32_t button = getKeycode(uniform);
+                if (button >= 3)
+                {
+                    Logger::warn("unsupported mouse button " + std::to_string(button) + " for uniform " + uniform.name);
+                    continue;
+                }
+                usesMouse            = true;
+                uint32_t stateOffset = offsetof(FrameUniforms, mouseButtons) + button * sizeof(VkBool32);
+                if (isPressOrToggle(uniform))
+                    stateful.push_back(std::make_unique<KeyUniform>(uniform, stateOffset));
+                else
+                    addCopy(stateOffset, sizeof(VkBool32));
             }
             else if (source == "mousepoint")
             {
-                uniforms.push_back(std::shared_ptr<ReshadeUniform>(new MousePointUniform(uniform)));
+                usesMouse = true;
+                addCopy(offsetof(FrameUniforms, mousePoint), sizeof(float) * 2);
             }
             else if (source == "mousedelta")
             {
-                uniforms.push_back(std::shared_ptr<ReshadeUniform>(new MouseDeltaUniform(uniform)));
+                usesMouse = true;
+                addCopy(offsetof(FrameUniforms, mouseDelta), sizeof(float) * 2);
             }
             else if (source == "bufready_depth")
             {
-                uniforms.push_back(std::shared_ptr<ReshadeUniform>(new DepthUniform(uniform)));
+                addCopy(offsetof(FrameUniforms, hasDepth), sizeof(VkBool32));
             }
         }
-        return uniforms;
-    }
 
-    //////////////////////////////////////////////////////////////////////////////////////////////////////////
-    FrameTimeUniform::FrameTimeUniform(reshadefx::uniform_info uniformInfo)
-    {
-        auto source = std::find_if(uniformInfo.annotations.begin(), uniformInfo.annotations.end(), [](const auto& a) { return a.name == "source"; });
-        if (source->value.string_data != "frametime")
-        {
-            Logger::err("Tried to create a FrameTimeUniform from a non frametime uniform_info");
-        }
-        lastFrame = std::chrono::high_resolution_clock::now();
-        offset    = uniformInfo.offset;
-        size      = uniformInfo.size;
-    }
-    void FrameTimeUniform::update(void* mapedBuffer)
-    {
-        auto                                     currentFrame = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<float, std::milli> duration     = currentFrame - lastFrame;
-        lastFrame                                             = currentFrame;
-        float frametime                                       = duration.count();
-        std::memcpy((uint8_t*) mapedBuffer + offset, &(frametime), sizeof(float));
-    }
-    FrameTimeUniform::~FrameTimeUniform()
-    {
+        if (usesMouse)
+            mouseUsers++;
     }
 
-    //////////////////////////////////////////////////////////////////////////////////////////////////////////
-    FrameCountUniform::FrameCountUniform(reshadefx::uniform_info uniformInfo)
-    {
-        auto source = std::find_if(uniformInfo.annotations.begin(), uniformInfo.annotations.end(), [](const auto& a) { return a.name == "source"; });
-        if (source->value.string_data != "framecount")
-        {
-            Logger::err("Tried to create a FrameCountUniform from a non framecount uniform_info");
-        }
-        offset = uniformInfo.offset;
-        size   = uniformInfo.size;
-    }
-    void FrameCountUniform::update(void* mapedBuffer)
-    {
-        std::memcpy((uint8_t*) mapedBuffer + offset, &(count), sizeof(int32_t));
-        count++;
-    }
-    FrameCountUniform::~FrameCountUniform()
+    ReshadeUniforms::~ReshadeUniforms()
     {
+        for (uint32_t keycode : usedKeys)
+            keyUsers[keycode]--;
+        if (usesMouse)
+            mouseUsers--;
     }
 
-    //////////////////////////////////////////////////////////////////////////////////////////////////////////
-    DateUniform::DateUniform(reshadefx::uniform_info uniformInfo)
-    {
-        auto source = std::find_if(uniformInfo.annotations.begin(), uniformInfo.annotations.end(), [](const auto& a) { return a.name == "source"; });
-        if (source->value.string_data != "date")
-        {
-            Logger::err("Tried to create a DateUniform from a non date uniform_info");
-        }
-        offset = uniformInfo.offset;
-        size   = uniformInfo.size;
-    }
-    void DateUniform::update(void* mapedBuffer)
-    {
-        auto        now         = std::chrono::system_clock::now();
-        std::time_t nowC        = std::chrono::system_clock::to_time_t(now);
-        struct tm*  currentTime = std::localtime(&nowC);
-        float       year        = 1900.0f + static_cast<float>(currentTime->tm_year);
-        float       month       = 1.0f + static_cast<float>(currentTime->tm_mon);
-        float       day         = static_cast<float>(currentTime->tm_mday);
-        float       seconds     = static_cast<float>((currentTime->tm_hour * 60 + currentTime->tm_min) * 60 + currentTime->tm_sec);
-        float       date[]      = {year, month, day, seconds};
-        std::memcpy((uint8_t*) mapedBuffer + offset, date, sizeof(float) * 4);
-    }
-    DateUniform::~DateUniform()
-    {
-    }
-
-    //////////////////////////////////////////////////////////////////////////////////////////////////////////
-    TimerUniform::TimerUniform(reshadefx::uniform_info uniformInfo)
-    {
-        auto source = std::find_if(uniformInfo.annotations.begin(), uniformInfo.annotations.end(), [](const auto& a) { return a.name == "source"; });
-        if (source->value.string_data != "timer")
-        {
-            Logger::err("Tried to create a TimerUniform from a non timer uniform_info");
-        }
-        start  = std::chrono::high_resolution_clock::now();
-        offset = uniformInfo.offset;
-        size   = uniformInfo.size;
-    }
-    void TimerUniform::update(void* mapedBuffer)
-    {
-        auto                                     currentFrame = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<float, std::milli> duration     = currentFrame - start;
-        float                                    timer        = duration.count();
-        std::memcpy((uint8_t*) mapedBuffer + offset, &(timer), sizeof(float));
-    }
-    TimerUniform::~TimerUniform()
+    void ReshadeUniforms::update(void* mapedBuffer, const FrameUniforms& frame)
     {
+        const uint8_t* src = reinterpret_cast<const uint8_t*>(&frame);
+        uint8_t*       dst = static_cast<uint8_t*>(mapedBuffer);
+        for (const Copy& copy : copies)
+            std::memcpy(dst + copy.dstOffset, src + copy.srcOffset, copy.size);
+        for (auto& uniform : stateful)
+            uniform->update(mapedBuffer, frame);
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////////////////
     PingPongUniform::PingPongUniform(reshadefx::uniform_info uniformInfo)
     {
-        auto source = std::find_if(uniformInfo.annotations.begin(), uniformInfo.annotations.end(), [](const auto& a) { return a.name == "source"; });
-        if (source->value.string_data != "pingpong")
-        {
-            Logger::err("Tried to create a PingPongUniform from a non pingpong uniform_info");
-        }
-        if (auto minAnnotation =
-                std::find_if(uniformInfo.annotations.begin(), uniformInfo.annotations.end(), [](const auto& a) { return a.name == "min"; });
-            minAnnotation != uniformInfo.annotations.end())
+        if (auto minAnnotation = findAnnotation(uniformInfo, "min"))
         {
             min = minAnnotation->type.is_floating_point() ? minAnnotation->value.as_float[0] : static_cast<float>(minAnnotation->value.as_int[0]);
         }
-        if (auto maxAnnotation =
-                std::find_if(uniformInfo.annotations.begin(), uniformInfo.annotations.end(), [](const auto& a) { return a.name == "max"; });
-            maxAnnotation != uniformInfo.annotations.end())
+        if (auto maxAnnotation = findAnnotation(uniformInfo, "max"))
         {
             max = maxAnnotation->type.is_floating_point() ? maxAnnotation->value.as_float[0] : static_cast<float>(maxAnnotation->value.as_int[0]);
         }
-        if (auto smoothingAnnotation =
-                std::find_if(uniformInfo.annotations.begin(), uniformInfo.annotations.end(), [](const auto& a) { return a.name == "smoothing"; });
-            smoothingAnnotation != uniformInfo.annotations.end())
+        if (auto smoothingAnnotation = findAnnotation(uniformInfo, "smoothing"))
         {
             smoothing = smoothingAnnotation->type.is_floating_point() ? smoothingAnnotation->value.as_float[0]
                                                                       : static_cast<float>(smoothingAnnotation->value.as_int[0]);
         }
-        if (auto stepAnnotation =
-                std::find_if(uniformInfo.annotations.begin(), uniformInfo.annotations.end(), [](const auto& a) { return a.name == "step"; });
-            stepAnnotation != uniformInfo.annotations.end())
+        if (auto stepAnnotation = findAnnotation(uniformInfo, "step"))
         {
             stepMin =
                 stepAnnotation->type.is_floating_point() ? stepAnnotation->value.as_float[0] : static_cast<float>(stepAnnotation->value.as_int[0]);
@@ -211,22 +312,20 @@ namespace vkBasalt
                 stepAnnotation->type.is_floating_point() ? stepAnnotation->value.as_float[1] : static_cast<float>(stepAnnotation->value.as_int[1]);
         }
 
-        lastFrame = std::chrono::high_resolution_clock::now();
-
+        salt   = nextSalt++;
         offset = uniformInfo.offset;
         size   = uniformInfo.size;
     }
-    void PingPongUniform::update(void* mapedBuffer)
+    void PingPongUniform::update(void* mapedBuffer, const FrameUniforms& frame)
     {
-        auto currentFrame = std::chrono::high_resolution_clock::now();
+        float frameTime = frame.frameTime / 1000.0f;
+        float random    = static_cast<float>(hash(frame.randomSeed ^ salt) & 0xFFFFFF);
 
-        std::chrono::duration<float, std::ratio<1>> frameTime = currentFrame - lastFrame;
-
-        float increment = stepMax == 0 ? stepMin : (stepMin + std::fmod(static_cast<float>(std::rand()), stepMax - stepMin + 1.0f));
+        float increment = stepMax == 0 ? stepMin : (stepMin + std::fmod(random, stepMax - stepMin + 1.0f));
         if (currentValue[1] >= 0)
         {
             increment = std::max(increment - std::max(0.0f, smoothing - (max - currentValue[0])), 0.05f);
-            increment *= frameTime.count();
+            increment *= frameTime;
 
             if ((currentValue[0] += increment) >= max)
             {
@@ -236,7 +335,7 @@ namespace vkBasalt
         else
         {
             increment = std::max(increment - std::max(0.0f, smoothing - (currentValue[0] - min)), 0.05f);
-            increment *= frameTime.count();
+            increment *= frameTime;
 
             if ((currentValue[0] -= increment) <= min)
             {
@@ -252,29 +351,22 @@ namespace vkBasalt
     //////////////////////////////////////////////////////////////////////////////////////////////////////////
     RandomUniform::RandomUniform(reshadefx::uniform_info uniformInfo)
     {
-        auto source = std::find_if(uniformInfo.annotations.begin(), uniformInfo.annotations.end(), [](const auto& a) { return a.name == "source"; });
-        if (source->value.string_data != "random")
-        {
-            Logger::err("Tried to create a RandomUniform from a non random uniform_info");
-        }
-        if (auto minAnnotation =
-                std::find_if(uniformInfo.annotations.begin(), uniformInfo.annotations.end(), [](const auto& a) { return a.name == "min"; });
-            minAnnotation != uniformInfo.annotations.end())
+        if (auto minAnnotation = findAnnotation(uniformInfo, "min"))
         {
             min = minAnnotation->type.is_integral() ? minAnnotation->value.as_int[0] : static_cast<int>(minAnnotation->value.as_float[0]);
         }
-        if (auto maxAnnotation =
-                std::find_if(uniformInfo.annotations.begin(), uniformInfo.annotations.end(), [](const auto& a) { return a.name == "max"; });
-            maxAnnotation != uniformInfo.annotations.end())
+        if (auto maxAnnotation = findAnnotation(uniformInfo, "max"))
         {
             max = maxAnnotation->type.is_integral() ? maxAnnotation->value.as_int[0] : static_cast<int>(maxAnnotation->value.as_float[0]);
         }
+        salt   = nextSalt++;
         offset = uniformInfo.offset;
         size   = uniformInfo.size;
     }
-    void RandomUniform::update(void* mapedBuffer)
+    void RandomUniform::update(void* mapedBuffer, const FrameUniforms& frame)
     {
-        int32_t value = min + (std::rand() % (max - min + 1));
+        uint32_t range = static_cast<uint32_t>(max - min) + 1;
+        int32_t  value = min + static_cast<int32_t>(range ? hash(frame.randomSeed ^ salt) % range : hash(frame.randomSeed ^ salt));
         std::memcpy((uint8_t*) mapedBuffer + offset, &(value), sizeof(int32_t));
     }
     RandomUniform::~RandomUniform()
@@ -282,102 +374,26 @@ namespace vkBasalt
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////////////////
-    KeyUniform::KeyUniform(reshadefx::uniform_info uniformInfo)
-    {
-        auto source = std::find_if(uniformInfo.annotations.begin(), uniformInfo.annotations.end(), [](const auto& a) { return a.name == "source"; });
-        if (source->value.string_data != "key")
-        {
-            Logger::err("Tried to create a KeyUniform from a non key uniform_info");
-        }
-        offset = uniformInfo.offset;
-        size   = uniformInfo.size;
-    }
-    void KeyUniform::update(void* mapedBuffer)
-    {
-        VkBool32 keyDown = VK_FALSE; // TODO
-        std::memcpy((uint8_t*) mapedBuffer + offset, &(keyDown), sizeof(VkBool32));
-    }
-    KeyUniform::~KeyUniform()
-    {
-    }
-
-    //////////////////////////////////////////////////////////////////////////////////////////////////////////
-    MouseButtonUniform::MouseButtonUniform(reshadefx::uniform_info uniformInfo)
-    {
-        auto source = std::find_if(uniformInfo.annotations.begin(), uniformInfo.annotations.end(), [](const auto& a) { return a.name == "source"; });
-        if (source->value.string_data != "mousebutton")
-        {
-            Logger::err("Tried to create a MouseButtonUniform from a non mousebutton uniform_info");
-        }
-        offset = uniformInfo.offset;
-        size   = uniformInfo.size;
-    }
-    void MouseButtonUniform::update(void* mapedBuffer)
-    {
-        VkBool32 keyDown = VK_FALSE; // TODO
-        std::memcpy((uint8_t*) mapedBuffer + offset, &(keyDown), sizeof(VkBool32));
-    }
-    MouseButtonUniform::~MouseButtonUniform()
-    {
-    }
-
-    //////////////////////////////////////////////////////////////////////////////////////////////////////////
-    MousePointUniform::MousePointUniform(reshadefx::uniform_info uniformInfo)
-    {
-        auto source = std::find_if(uniformInfo.annotations.begin(), uniformInfo.annotations.end(), [](const auto& a) { return a.name == "source"; });
-        if (source->value.string_data != "mousepoint")
-        {
-            Logger::err("Tried to create a MousePointUniform from a non mousepoint uniform_info");
-        }
-        offset = uniformInfo.offset;
-        size   = uniformInfo.size;
-    }
-    void MousePointUniform::update(void* mapedBuffer)
-    {
-        float point[2] = {0.0f, 0.0f}; // TODO
-        std::memcpy((uint8_t*) mapedBuffer + offset, point, sizeof(float) * 2);
-    }
-    MousePointUniform::~MousePointUniform()
-    {
-    }
-
-    //////////////////////////////////////////////////////////////////////////////////////////////////////////
-    MouseDeltaUniform::MouseDeltaUniform(reshadefx::uniform_info uniformInfo)
+    KeyUniform::KeyUniform(reshadefx::uniform_info uniformInfo, uint32_t stateOffset) : stateOffset(stateOffset)
     {
-        auto source = std::find_if(uniformInfo.annotations.begin(), uniformInfo.annotations.end(), [](const auto& a) { return a.name == "source"; });
-        if (source->value.string_data != "mousedelta")
-        {
-            Logger::err("Tried to create a MouseDeltaUniform from a non mousedelta uniform_info");
-        }
+        const reshadefx::annotation* mode = findAnnotation(uniformInfo, "mode");
+        toggle = mode && mode->value.string_data == "toggle";
         offset = uniformInfo.offset;
         size   = uniformInfo.size;
     }
-    void MouseDeltaUniform::update(void* mapedBuffer)
-    {
-        float delta[2] = {0.0f, 0.0f}; // TODO
-        std::memcpy((uint8_t*) mapedBuffer + offset, delta, sizeof(float) * 2);
-    }
-    MouseDeltaUniform::~MouseDeltaUniform()
+    void KeyUniform::update(void* mapedBuffer, const FrameUniforms& frame)
     {
-    }
+        VkBool32 down;
+        std::memcpy(&down, reinterpret_cast<const uint8_t*>(&frame) + stateOffset, sizeof(VkBool32));
+        VkBool32 pressed = down && !wasDown;
+        wasDown          = down;
+        if (pressed)
+            toggleValue = !toggleValue;
 
-    //////////////////////////////////////////////////////////////////////////////////////////////////////////
-    DepthUniform::DepthUniform(reshadefx::uniform_info uniformInfo)
-    {
-        auto source = std::find_if(uniformInfo.annotations.begin(), uniformInfo.annotations.end(), [](const auto& a) { return a.name == "source"; });
-        if (source->value.string_data != "bufready_depth")
-        {
-            Logger::err("Tried to create a DepthUniform from a non bufready_depth uniform_info");
-        }
-        offset = uniformInfo.offset;
-        size   = uniformInfo.size;
-    }
-    void DepthUniform::update(void* mapedBuffer)
-    {
-        VkBool32 hasDepth = VK_FALSE; // TODO
-        std::memcpy((uint8_t*) mapedBuffer + offset, &(hasDepth), sizeof(VkBool32));
+        VkBool32 value = toggle ? toggleValue : pressed;
+        std::memcpy((uint8_t*) mapedBuffer + offset, &(value), sizeof(VkBool32));
     }
-    DepthUniform::~DepthUniform()
+    KeyUniform::~KeyUniform()
     {
     }
 } // namespace vkBasalt
@@ -16,10 +16,35 @@ namespace vkBasalt
 {
     void enumerateReshadeUniforms(reshadefx::module module);
 
+    // Values behind the "source" annotations that are the same for every effect in a frame.
+    // Filled once per present by updateFrameUniforms(), effects copy from it into their uniform buffer.
+    struct FrameUniforms
+    {
+        float    frameTime       = 0.0f; // ms since the previous present
+        int32_t  frameCount      = 0;
+        float    timer           = 0.0f; // ms since the layer was loaded
+        float    date[4]         = {};   // year, month, day, seconds since midnight
+        float    mousePoint[2]   = {};
+        float    mouseDelta[2]   = {};
+        VkBool32 mouseButtons[3] = {};   // ReShade mouse button keycodes: left, right, middle
+        VkBool32 hasDepth        = VK_FALSE;
+        uint32_t randomSeed      = 0;    // changes every frame
+
+        // Indexed by Windows virtual key code, only keys used by a loaded effect are sampled
+        VkBool32 keys[256] = {};
+    };
+
+    void                 updateFrameUniforms(bool hasDepth);
+    const FrameUniforms& getFrameUniforms();
+
+    // Replaces this frame's values, e.g. with the ones of a saved frame
+    void setFrameUniforms(const FrameUniforms& frame);
+
+    // Uniforms that keep state between frames (or need per uniform randomness)
     class ReshadeUniform
     {
     public:
-        void virtual update(void* mapedBuffer) = 0;
+        void virtual update(void* mapedBuffer, const FrameUniforms& frame) = 0;
         virtual ~ReshadeUniform(){};
 
     protected:
@@ -27,117 +52,76 @@ namespace vkBasalt
         uint32_t size;
     };
 
-    std::vector<std::shared_ptr<ReshadeUniform>> createReshadeUniforms(reshadefx::module module);
-
-    class FrameTimeUniform : public ReshadeUniform
+    // Everything needed to fill the "source" uniforms of one effect:
+    // a list of plain copies out of FrameUniforms plus the few stateful uniforms
+    class ReshadeUniforms
     {
     public:
-        FrameTimeUniform(reshadefx::uniform_info uniformInfo);
-        void virtual update(void* mapedBuffer) override;
-        virtual ~FrameTimeUniform();
+        explicit ReshadeUniforms(const reshadefx::module& module);
+        ~ReshadeUniforms();
 
-    private:
-        std::chrono::time_point<std::chrono::high_resolution_clock> lastFrame;
-    };
+        ReshadeUniforms(const ReshadeUniforms&)            = delete;
+        ReshadeUniforms& operator=(const ReshadeUniforms&) = delete;
 
-    class FrameCountUniform : public ReshadeUniform
-    {
-    public:
-        FrameCountUniform(reshadefx::uniform_info uniformInfo);
-        void virtual update(void* mapedBuffer) override;
-        virtual ~FrameCountUniform();
+        void update(void* mapedBuffer, const FrameUniforms& frame);
 
     private:
-        int32_t count = 0;
-    };
-
-    class DateUniform : public ReshadeUniform
-    {
-    public:
-        DateUniform(reshadefx::uniform_info uniformInfo);
-        void virtual update(void* mapedBuffer) override;
-        virtual ~DateUniform();
-    };
-
-    class TimerUniform : public ReshadeUniform
-    {
-    public:
-        TimerUniform(reshadefx::uniform_info uniformInfo);
-        void virtual update(void* mapedBuffer) override;
-        virtual ~TimerUniform();
-
-    private:
-        std::chrono::time_point<std::chrono::high_resolution_clock> start;
+        struct Copy
+        {
+            uint32_t dstOffset;
+            uint32_t srcOffset;
+            uint32_t size;
+        };
+
+        std::vector<Copy>                            copies;
+        std::vector<std::unique_ptr<ReshadeUniform>> stateful;
+        std::vector<uint32_t>                        usedKeys;
+        bool                                         usesMouse = false;
     };
 
     class PingPongUniform : public ReshadeUniform
     {
     public:
         PingPongUniform(reshadefx::uniform_info uniformInfo);
-        void virtual update(void* mapedBuffer) override;
+        void virtual update(void* mapedBuffer, const FrameUniforms& frame) override;
         virtual ~PingPongUniform();
 
     private:
-        std::chrono::time_point<std::chrono::high_resolution_clock> lastFrame;
-
         float min             = 0.0f;
         float max             = 0.0f;
         float stepMin         = 0.0f;
         float stepMax         = 0.0f;
         float smoothing       = 0.0f;
         float currentValue[2] = {0.0f, 1.0f};
+        uint32_t salt         = 0;
     };
 
     class RandomUniform : public ReshadeUniform
     {
     public:
         RandomUniform(reshadefx::uniform_info uniformInfo);
-        void virtual update(void* mapedBuffer) override;
+        void virtual update(void* mapedBuffer, const FrameUniforms& frame) override;
         virtual ~RandomUniform();
 
     private:
-        int max = 0;
-        int min = 0;
+        int      max  = 0;
+        int      min  = 0;
+        uint32_t salt = 0;
     };
 
+    // "key" and "mousebutton" uniforms with mode = "press" or "toggle", plain held state is a copy
     class KeyUniform : public ReshadeUniform
     {
     public:
-        KeyUniform(reshadefx::uniform_info uniformInfo);
-        void virtual update(void* mapedBuffer) override;
+        KeyUniform(reshadefx::uniform_info uniformInfo, uint32_t stateOffset);
+        void virtual update(void* mapedBuffer, const FrameUniforms& frame) override;
         virtual ~KeyUniform();
-    };
-
-    class MouseButtonUniform : public ReshadeUniform
-    {
-    public:
-        MouseButtonUniform(reshadefx::uniform_info uniformInfo);
-        void virtual update(void* mapedBuffer) override;
-        virtual ~MouseButtonUniform();
-    };
-
-    class MousePointUniform : public ReshadeUniform
-    {
-    public:
-        MousePointUniform(reshadefx::uniform_info uniformInfo);
-        void virtual update(void* mapedBuffer) override;
-        virtual ~MousePointUniform();
-    };
 
-    class MouseDeltaUniform : public ReshadeUniform
-    {
-    public:
-        MouseDeltaUniform(reshadefx::uniform_info uniformInfo);
-        void virtual update(void* mapedBuffer) override;
-        virtual ~MouseDeltaUniform();
-    };
-
-    class DepthUniform : public ReshadeUniform
-    {
-    public:
-        DepthUniform(reshadefx::uniform_info uniformInfo);
-        void virtual update(void* mapedBuffer) override;
-        virtual ~DepthUniform();
+    private:
+        uint32_t stateOffset;  // VkBool32 in FrameUniforms this uniform follows, read from the frame passed to update()
+        bool     toggle      = false;
+        VkBool32 wasDown     = VK_FALSE;
+        VkBool32 toggleValue = VK_FALSE;
     };
 } // namespace vkBasalt
 
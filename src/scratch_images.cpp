@@ -0,0 +1,92 @@
+#include "scratch_images.hpp"
+
+#include "image.hpp"
+#include "image_view.hpp"
+#include "format.hpp"
+#include "memory.hpp"
+#include "logger.hpp"
+
+namespace vkBasalt
+{
+    ScratchImages::ScratchImages(LogicalDevice* pLogicalDevice, VkFormat format, VkExtent2D imageExtent, uint32_t imageCount)
+        : pLogicalDevice(pLogicalDevice), format(format), imageExtent(imageExtent), imageCount(imageCount)
+    {
+        stencilFormat = getStencilFormat(pLogicalDevice);
+    }
+
+    VkImage ScratchImages::getStencilImage()
+    {
+        if (stencilImage == VK_NULL_HANDLE)
+            allocateStencil();
+        return stencilImage;
+    }
+
+    VkImageView ScratchImages::getStencilImageView()
+    {
+        if (stencilImage == VK_NULL_HANDLE)
+            allocateStencil();
+        return stencilImageView;
+    }
+
+    const std::vector<VkImage>& ScratchImages::getBackBufferImages()
+    {
+        if (backBufferImages.empty())
+            allocateBackBuffers();
+        return backBufferImages;
+    }
+
+    const std::vector<VkImageView>& ScratchImages::getBackBufferImageViews(bool srgb)
+    {
+        if (backBufferImages.empty())
+            allocateBackBuffers();
+        return srgb ? backBufferImageViewsSRGB : backBufferImageViewsUNORM;
+    }
+
+    void ScratchImages::allocateStencil()
+    {
+        MemoryOwnerScope memoryOwner("Scratch images");
+        Logger::debug("allocating shared stencil image, format " + std::to_string(stencilFormat));
+
+        stencilImage = createImages(pLogicalDevice,
+                                    1,
+                                    {imageExtent.width, imageExtent.height, 1},
+                                    stencilFormat,
+                                    VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+                                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                    stencilImageMemory)[0];
+        stencilImageView = createImageViews(
+            pLogicalDevice, stencilFormat, {stencilImage}, VK_IMAGE_VIEW_TYPE_2D, VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT)[0];
+    }
+
+    void ScratchImages::allocateBackBuffers()
+    {
+        MemoryOwnerScope memoryOwner("Scratch images");
+        Logger::debug("allocating shared back buffers");
+
+        // TRANSFER_DST because effects limited to regions copy their input into the back buffer
+        backBufferImages = createImages(pLogicalDevice,
+                                        imageCount,
+                                        {imageExtent.width, imageExtent.height, 1},
+                                        format,
+                                        VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+                                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                        backBufferMemory);
+        backBufferImageViewsSRGB  = createImageViews(pLogicalDevice, convertToSRGB(format), backBufferImages);
+        backBufferImageViewsUNORM = createImageViews(pLogicalDevice, convertToUNORM(format), backBufferImages);
+    }
+
+    ScratchImages::~ScratchImages()
+    {
+        for (auto& imageView : backBufferImageViewsSRGB)
+            pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, imageView, nullptr);
+        for (auto& imageView : backBufferImageViewsUNORM)
+            pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, imageView, nullptr);
+        for (auto& image : backBufferImages)
+            pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, image, nullptr);
+        freeMemory(pLogicalDevice, backBufferMemory);
+
+        pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, stencilImageView, nullptr);
+        pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, stencilImage, nullptr);
+        freeMemory(pLogicalDevice, stencilImageMemory);
+    }
+} // namespace vkBasalt
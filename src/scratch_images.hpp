@@ -0,0 +1,53 @@
+#ifndef SCRATCH_IMAGES_HPP_INCLUDED
+#define SCRATCH_IMAGES_HPP_INCLUDED
+#include <vector>
+
+#include "vulkan_include.hpp"
+
+#include "logical_device.hpp"
+
+namespace vkBasalt
+{
+    // Full resolution images an effect only needs while its own passes run.
+    // Effects are applied one after another, so the whole chain of a swapchain shares them.
+    // Each kind is allocated the first time an effect asks for it
+    class ScratchImages
+    {
+    public:
+        ScratchImages(LogicalDevice* pLogicalDevice, VkFormat format, VkExtent2D imageExtent, uint32_t imageCount);
+        ~ScratchImages();
+
+        ScratchImages(const ScratchImages&)            = delete;
+        ScratchImages& operator=(const ScratchImages&) = delete;
+
+        // Depth/stencil attachment, the same for every swapchain image
+        VkFormat    getStencilFormat() const { return stencilFormat; }
+        VkImage     getStencilImage();
+        VkImageView getStencilImageView();
+
+        // ReShade back buffer, one per swapchain image in the swapchain format
+        const std::vector<VkImage>&     getBackBufferImages();
+        const std::vector<VkImageView>& getBackBufferImageViews(bool srgb);
+
+    private:
+        void allocateStencil();
+        void allocateBackBuffers();
+
+        LogicalDevice* pLogicalDevice;
+        VkFormat       format;
+        VkExtent2D     imageExtent;
+        uint32_t       imageCount;
+
+        VkFormat       stencilFormat;
+        VkImage        stencilImage       = VK_NULL_HANDLE;
+        VkImageView    stencilImageView   = VK_NULL_HANDLE;
+        VkDeviceMemory stencilImageMemory = VK_NULL_HANDLE;
+
+        std::vector<VkImage>     backBufferImages;
+        std::vector<VkImageView> backBufferImageViewsUNORM;
+        std::vector<VkImageView> backBufferImageViewsSRGB;
+        VkDeviceMemory           backBufferMemory = VK_NULL_HANDLE;
+    };
+} // namespace vkBasalt
+
+#endif // SCRATCH_IMAGES_HPP_INCLUDED
@@ -29,6 +29,7 @@ namespace vkBasalt
         // Getters
         int getMaxEffects() const { return settings.maxEffects; }
         bool getOverlayBlockInput() const { return settings.overlayBlockInput; }
+        int getOverlayIdleRelease() const { return settings.overlayIdleRelease; }
         const std::string& getToggleKey() const { return settings.toggleKey; }
         const std::string& getReloadKey() const { return settings.reloadKey; }
         const std::string& getOverlayKey() const { return settings.overlayKey; }
@@ -37,10 +38,18 @@ namespace vkBasalt
         bool getAutoApply() const { return settings.autoApply; }
         int getAutoApplyDelay() const { return settings.autoApplyDelay; }
         bool getShowDebugWindow() const { return settings.showDebugWindow; }
+        int getVramLimitMB() const { return settings.vramLimitMB; }
+        bool getRespectMemoryBudget() const { return settings.respectMemoryBudget; }
+        bool getHalfPrecisionShaders() const { return settings.halfPrecisionShaders; }
+        bool getDedicatedEffectQueue() const { return settings.dedicatedEffectQueue; }
+        bool getLinearDepthPrepass() const { return settings.linearDepthPrepass; }
+        bool getBypassWhenDisabled() const { return settings.bypassWhenDisabled; }
+        bool getPresentLatencyStats() const { return settings.presentLatencyStats; }
 
         // Setters (update in-memory state, call save() to persist)
         void setMaxEffects(int value) { settings.maxEffects = value; }
         void setOverlayBlockInput(bool value) { settings.overlayBlockInput = value; }
+        void setOverlayIdleRelease(int value) { settings.overlayIdleRelease = value; }
         void setToggleKey(const std::string& value) { settings.toggleKey = value; }
         void setReloadKey(const std::string& value) { settings.reloadKey = value; }
         void setOverlayKey(const std::string& value) { settings.overlayKey = value; }
@@ -49,6 +58,13 @@ namespace vkBasalt
         void setAutoApply(bool value) { settings.autoApply = value; }
         void setAutoApplyDelay(int value) { settings.autoApplyDelay = value; }
         void setShowDebugWindow(bool value) { settings.showDebugWindow = value; }
+        void setVramLimitMB(int value) { settings.vramLimitMB = value; }
+        void setRespectMemoryBudget(bool value) { settings.respectMemoryBudget = value; }
+        void setHalfPrecisionShaders(bool value) { settings.halfPrecisionShaders = value; }
+        void setDedicatedEffectQueue(bool value) { settings.dedicatedEffectQueue = value; }
+        void setLinearDepthPrepass(bool value) { settings.linearDepthPrepass = value; }
+        void setBypassWhenDisabled(bool value) { settings.bypassWhenDisabled = value; }
+        void setPresentLatencyStats(bool value) { settings.presentLatencyStats = value; }
 
         // Get raw settings struct (for bulk operations)
         const VkBasaltSettings& getSettings() const { return settings; }
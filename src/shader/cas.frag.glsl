@@ -16,6 +16,17 @@
 // ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE
 #version 450
 
+// Compiled a second time with VKBASALT_FP16 defined into cas.frag.fp16.h,
+// used instead when the device supports shaderFloat16 (packed math on most GPUs)
+#ifdef VKBASALT_FP16
+#extension GL_EXT_shader_explicit_arithmetic_types_float16 : require
+#define hfloat float16_t
+#define hvec3 f16vec3
+#else
+#define hfloat float
+#define hvec3 vec3
+#endif
+
 layout(set=0, binding=0) uniform sampler2D img;
 
 layout (constant_id = 0) const float sharpness = 0.4;
@@ -35,15 +46,15 @@ void main()
     vec4 inputColor = textureLod0(img,textureCoord);
     float alpha = inputColor.a;
 
-    vec3 a = textureLod0Offset(img, textureCoord, ivec2(-1,-1)).rgb;
-    vec3 b = textureLod0Offset(img, textureCoord, ivec2( 0,-1)).rgb;
-    vec3 c = textureLod0Offset(img, textureCoord, ivec2( 1,-1)).rgb;
-    vec3 d = textureLod0Offset(img, textureCoord, ivec2(-1, 0)).rgb;
-    vec3 e = inputColor.rgb;
-    vec3 f = textureLod0Offset(img, textureCoord, ivec2( 1, 0)).rgb;
-    vec3 g = textureLod0Offset(img, textureCoord, ivec2(-1, 1)).rgb;
-    vec3 h = textureLod0Offset(img, textureCoord, ivec2( 0, 1)).rgb;
-    vec3 i = textureLod0Offset(img, textureCoord, ivec2( 1, 1)).rgb;
+    hvec3 a = hvec3(textureLod0Offset(img, textureCoord, ivec2(-1,-1)).rgb);
+    hvec3 b = hvec3(textureLod0Offset(img, textureCoord, ivec2( 0,-1)).rgb);
+    hvec3 c = hvec3(textureLod0Offset(img, textureCoord, ivec2( 1,-1)).rgb);
+    hvec3 d = hvec3(textureLod0Offset(img, textureCoord, ivec2(-1, 0)).rgb);
+    hvec3 e = hvec3(inputColor.rgb);
+    hvec3 f = hvec3(textureLod0Offset(img, textureCoord, ivec2( 1, 0)).rgb);
+    hvec3 g = hvec3(textureLod0Offset(img, textureCoord, ivec2(-1, 1)).rgb);
+    hvec3 h = hvec3(textureLod0Offset(img, textureCoord, ivec2( 0, 1)).rgb);
+    hvec3 i = hvec3(textureLod0Offset(img, textureCoord, ivec2( 1, 1)).rgb);
 
     // Soft min and max.
     //  a b c             b
@@ -51,31 +62,31 @@ void main()
     //  g h i             h
     // These are 2.0x bigger (factored out the extra multiply).
 
-    vec3 mnRGB  = min(min(min(d,e),min(f,b)),h);
-    vec3 mnRGB2 = min(min(min(mnRGB,a),min(g,c)),i);
+    hvec3 mnRGB  = min(min(min(d,e),min(f,b)),h);
+    hvec3 mnRGB2 = min(min(min(mnRGB,a),min(g,c)),i);
     mnRGB += mnRGB2;
 
-    vec3 mxRGB  = max(max(max(d,e),max(f,b)),h);
-    vec3 mxRGB2 = max(max(max(mxRGB,a),max(g,c)),i);
+    hvec3 mxRGB  = max(max(max(d,e),max(f,b)),h);
+    hvec3 mxRGB2 = max(max(max(mxRGB,a),max(g,c)),i);
     mxRGB += mxRGB2;
 
     // Smooth minimum distance to signal limit divided by smooth max.
 
-    vec3 rcpMxRGB = vec3(1)/mxRGB;
-    vec3 ampRGB = clamp((min(mnRGB,2.0-mxRGB) * rcpMxRGB),0,1);
+    hvec3 rcpMxRGB = hvec3(1)/mxRGB;
+    hvec3 ampRGB = clamp((min(mnRGB,hfloat(2.0)-mxRGB) * rcpMxRGB),hfloat(0),hfloat(1));
 
     // Shaping amount of sharpening.
     ampRGB = inversesqrt(ampRGB);
-    float peak = 8.0 - 3.0 * sharpness;
-    vec3 wRGB = -vec3(1)/(ampRGB * peak);
-    vec3 rcpWeightRGB = vec3(1)/(1.0 + 4.0 * wRGB);
+    hfloat peak = hfloat(8.0 - 3.0 * sharpness);
+    hvec3 wRGB = -hvec3(1)/(ampRGB * peak);
+    hvec3 rcpWeightRGB = hvec3(1)/(hfloat(1.0) + hfloat(4.0) * wRGB);
 
     //                          0 w 0
     //  Filter shape:           w 1 w
     //                          0 w 0  
 
-    vec3 window = (b + d) + (f + h);
-    vec3 outColor = clamp((window * wRGB + e) * rcpWeightRGB,0,1);
+    hvec3 window = (b + d) + (f + h);
+    hvec3 outColor = clamp((window * wRGB + e) * rcpWeightRGB,hfloat(0),hfloat(1));
 
-    fragColor = vec4(outColor,alpha);
+    fragColor = vec4(vec3(outColor),alpha);
 }
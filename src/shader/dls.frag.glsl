@@ -22,6 +22,17 @@
 
 #version 450
 
+// Compiled a second time with VKBASALT_FP16 defined into dls.frag.fp16.h,
+// used instead when the device supports shaderFloat16
+#ifdef VKBASALT_FP16
+#extension GL_EXT_shader_explicit_arithmetic_types_float16 : require
+#define hfloat float16_t
+#define hvec4 f16vec4
+#else
+#define hfloat float
+#define hvec4 vec4
+#endif
+
 layout(set=0, binding=0) uniform sampler2D img;
 
 layout (constant_id = 0) const float sharpen = 0.5;
@@ -33,26 +44,27 @@ layout(location = 0) out vec4 fragColor;
 #define textureLod0Offset(img, coord, offset) textureLodOffset(img, coord, 0.0f, offset)
 #define textureLod0(img, coord) textureLod(img, coord, 0.0f)
 
-float GetLumaComponents(float r, float g, float b)
+hfloat GetLumaComponents(hfloat r, hfloat g, hfloat b)
 {
     // Y from JPEG spec
-    return 0.299 * r + 0.587 * g + 0.114 * b;
+    return hfloat(0.299) * r + hfloat(0.587) * g + hfloat(0.114) * b;
 }
 
-float GetLuma(vec4 p)
+hfloat GetLuma(vec4 p)
 {
-    return GetLumaComponents(p.x, p.y, p.z);
+    hvec4 h = hvec4(p);
+    return GetLumaComponents(h.x, h.y, h.z);
 }
 
-float Square(float v)
+hfloat Square(hfloat v)
 {
     return v * v;
 }
 
 // highlight fall-off start (prevents halos and noise in bright areas)
-#define kHighBlock 0.65
+#define kHighBlock hfloat(0.65)
 // offset reducing sharpening in the shadows
-#define kLowBlock (1.0 / 256.0)
+#define kLowBlock hfloat(1.0 / 256.0)
 #define kSharpnessMin (-1.0 / 14.0)
 #define kSharpnessMax (-1.0 / 6.5)
 #define kDenoiseMin (0.001)
@@ -76,33 +88,33 @@ void main()
     vec4 g = textureLod0Offset(img, textureCoord, ivec2(-1,  1));
     vec4 h = textureLod0Offset(img, textureCoord, ivec2( 1, -1));
 
-    float lx = GetLuma(x);
+    hfloat lx = GetLuma(x);
 
-    float la = GetLuma(a);
-    float lb = GetLuma(b);
-    float lc = GetLuma(c);
-    float ld = GetLuma(d);
+    hfloat la = GetLuma(a);
+    hfloat lb = GetLuma(b);
+    hfloat lc = GetLuma(c);
+    hfloat ld = GetLuma(d);
 
-    float le = GetLuma(e);
-    float lf = GetLuma(f);
-    float lg = GetLuma(g);
-    float lh = GetLuma(h);
+    hfloat le = GetLuma(e);
+    hfloat lf = GetLuma(f);
+    hfloat lg = GetLuma(g);
+    hfloat lh = GetLuma(h);
 
     // cross min/max
-    const float ncmin = min(min(le, lf), min(lg, lh));
-    const float ncmax = max(max(le, lf), max(lg, lh));
+    const hfloat ncmin = min(min(le, lf), min(lg, lh));
+    const hfloat ncmax = max(max(le, lf), max(lg, lh));
 
     // plus min/max
-    float npmin = min(min(min(la, lb), min(lc, ld)), lx);
-    float npmax = max(max(max(la, lb), max(lc, ld)), lx);
+    hfloat npmin = min(min(min(la, lb), min(lc, ld)), lx);
+    hfloat npmax = max(max(max(la, lb), max(lc, ld)), lx);
 
     // compute "soft" local dynamic range -- average of 3x3 and plus shape
-    float lmin = 0.5 * min(ncmin, npmin) + 0.5 * npmin;
-    float lmax = 0.5 * max(ncmax, npmax) + 0.5 * npmax;
+    hfloat lmin = hfloat(0.5) * min(ncmin, npmin) + hfloat(0.5) * npmin;
+    hfloat lmax = hfloat(0.5) * max(ncmax, npmax) + hfloat(0.5) * npmax;
 
     // compute local contrast enhancement kernel
-    float lw = lmin / (lmax + kLowBlock);
-    float hw = Square(1.0 - Square(max(lmax - kHighBlock, 0.0) / ((1.0 - kHighBlock))));
+    hfloat lw = lmin / (lmax + kLowBlock);
+    hfloat hw = Square(hfloat(1.0) - Square(max(lmax - kHighBlock, hfloat(0.0)) / ((hfloat(1.0) - kHighBlock))));
 
     // noise suppression
     // Note: Ensure that the denoiseFactor is in the range of (10, 1000) on the CPU-side prior to launching this shader.
@@ -113,10 +125,13 @@ void main()
     // where kernelDenoise is the value to be passed in to this shader (the amount of noise suppression is inversely proportional to this value),
     //       denoise is the value chosen by the user, in the range (0, 1)
 	const float kernelDenoise = 1.0 / (kDenoiseMin + (kDenoiseMax - kDenoiseMin) * denoise);
-    const float nw = Square((lmax - lmin) * kernelDenoise);
+    // kernelDenoise goes up to 1000, so this one stays at full precision to not overflow half floats.
+    // lw and hw are at most 1, clamping nw to that does not change the minimum below.
+    const float nwFull = float(lmax - lmin) * kernelDenoise;
+    const hfloat nw = hfloat(min(nwFull * nwFull, 1.0));
 
     // pick conservative boost
-    const float boost = min(min(lw, hw), nw);
+    const hfloat boost = min(min(lw, hw), nw);
 
     // run variable-sigma 3x3 sharpening convolution
     // Note: Ensure that the sharpenFactor is in the range of (-1.0/14.0, -1.0/6.5f) on the CPU-side prior to launching this shader.
@@ -127,23 +142,23 @@ void main()
     // where kernelSharpness is the value to be passed in to this shader,
     //       sharpen is the value chosen by the user, in the range (0, 1)
     const float kernelSharpness = kSharpnessMin + (kSharpnessMax - kSharpnessMin) * sharpen;
-    const float k = boost * kernelSharpness;
+    const hfloat k = boost * hfloat(kernelSharpness);
 
-    float accum = lx;
+    hfloat accum = lx;
     accum += la * k;
     accum += lb * k;
     accum += lc * k;
     accum += ld * k;
-    accum += le * (k * 0.5);
-    accum += lf * (k * 0.5);
-    accum += lg * (k * 0.5);
-    accum += lh * (k * 0.5);
+    accum += le * (k * hfloat(0.5));
+    accum += lf * (k * hfloat(0.5));
+    accum += lg * (k * hfloat(0.5));
+    accum += lh * (k * hfloat(0.5));
 
     // normalize (divide the accumulator by the sum of convolution weights)
-    accum /= 1.0 + 6.0 * k;
+    accum /= hfloat(1.0) + hfloat(6.0) * k;
 
     // accumulator is in linear light space            
-    float delta = accum - lx;
+    float delta = float(accum - lx);
     x.x += delta;
     x.y += delta;
     x.z += delta;
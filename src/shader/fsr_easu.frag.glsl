@@ -0,0 +1,186 @@
+// LICENSE
+// =======
+// Copyright (c) 2021 Advanced Micro Devices, Inc. All rights reserved.
+// -------
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// -------
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+// -------
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE
+#version 450
+
+// Edge adaptive spatial upsampling from FidelityFX Super Resolution 1.0 (FsrEasuF in ffx_fsr1.h).
+// The 12 taps are plain texel fetches instead of gathers, the input size comes from the texture
+// and the output size from the specialization constants.
+
+layout(set=0, binding=0) uniform sampler2D img;
+
+layout (constant_id = 0) const float outputWidth  = 1920.0;
+layout (constant_id = 1) const float outputHeight = 1080.0;
+
+layout(location = 0) in vec2 textureCoord;
+layout(location = 0) out vec4 fragColor;
+
+vec3 fetch(ivec2 coord, ivec2 maxCoord)
+{
+    return texelFetch(img, clamp(coord, ivec2(0), maxCoord), 0).rgb;
+}
+
+// Luma times 2.
+float luma2(vec3 c)
+{
+    return c.b * 0.5 + (c.r * 0.5 + c.g);
+}
+
+// Accumulates direction and length for one of the 4 bilinear corners.
+//    a
+//  b c d
+//    e
+void easuSet(inout vec2 dir, inout float len, float w, float lA, float lB, float lC, float lD, float lE)
+{
+    // Direction is the '+' diff.
+    float dc   = lD - lC;
+    float cb   = lC - lB;
+    float lenX = 1.0 / max(max(abs(dc), abs(cb)), 1.0 / 32768.0);
+    float dirX = lD - lB;
+    dir.x += dirX * w;
+    lenX = clamp(abs(dirX) * lenX, 0.0, 1.0);
+    lenX *= lenX;
+    len += lenX * w;
+
+    float ec   = lE - lC;
+    float ca   = lC - lA;
+    float lenY = 1.0 / max(max(abs(ec), abs(ca)), 1.0 / 32768.0);
+    float dirY = lE - lA;
+    dir.y += dirY * w;
+    lenY = clamp(abs(dirY) * lenY, 0.0, 1.0);
+    lenY *= lenY;
+    len += lenY * w;
+}
+
+// Filtering for a given tap.
+void easuTap(inout vec3 aC, inout float aW, vec2 off, vec2 dir, vec2 len, float lob, float clp, vec3 c)
+{
+    // Rotate offset by direction.
+    vec2 v = vec2(off.x * dir.x + off.y * dir.y, off.x * -dir.y + off.y * dir.x);
+    // Anisotropy.
+    v *= len;
+    // Compute distance^2, limited to the clipping point.
+    float d2 = min(v.x * v.x + v.y * v.y, clp);
+    // Approximation of lanczos2 without sin() or rcp() or sqrt().
+    //  (25/16 * (2/5 * x^2 - 1)^2 - (25/16 - 1)) * (1/4 * x^2 - 1)^2
+    //  |_______________________________________|   |_______________|
+    //                   base                             window
+    float wB = 2.0 / 5.0 * d2 - 1.0;
+    float wA = lob * d2 - 1.0;
+    wB *= wB;
+    wA *= wA;
+    wB = 25.0 / 16.0 * wB - (25.0 / 16.0 - 1.0);
+    float w = wB * wA;
+    aC += c * w;
+    aW += w;
+}
+
+void main()
+{
+    ivec2 inputSize = textureSize(img, 0);
+    ivec2 maxCoord  = inputSize - 1;
+    vec2  scale     = vec2(inputSize) / vec2(outputWidth, outputHeight);
+
+    // Position of the output pixel in the input, relative to the texel 'f'.
+    vec2 pp = floor(gl_FragCoord.xy) * scale + (0.5 * scale - 0.5);
+    vec2 fp = floor(pp);
+    pp -= fp;
+    ivec2 p0 = ivec2(fp);
+
+    // 12-tap kernel.
+    //    b c
+    //  e f g h
+    //  i j k l
+    //    n o
+    vec3 b = fetch(p0 + ivec2( 0, -1), maxCoord);
+    vec3 c = fetch(p0 + ivec2( 1, -1), maxCoord);
+    vec3 e = fetch(p0 + ivec2(-1,  0), maxCoord);
+    vec3 f = fetch(p0 + ivec2( 0,  0), maxCoord);
+    vec3 g = fetch(p0 + ivec2( 1,  0), maxCoord);
+    vec3 h = fetch(p0 + ivec2( 2,  0), maxCoord);
+    vec3 i = fetch(p0 + ivec2(-1,  1), maxCoord);
+    vec3 j = fetch(p0 + ivec2( 0,  1), maxCoord);
+    vec3 k = fetch(p0 + ivec2( 1,  1), maxCoord);
+    vec3 l = fetch(p0 + ivec2( 2,  1), maxCoord);
+    vec3 n = fetch(p0 + ivec2( 0,  2), maxCoord);
+    vec3 o = fetch(p0 + ivec2( 1,  2), maxCoord);
+
+    float bL = luma2(b);
+    float cL = luma2(c);
+    float eL = luma2(e);
+    float fL = luma2(f);
+    float gL = luma2(g);
+    float hL = luma2(h);
+    float iL = luma2(i);
+    float jL = luma2(j);
+    float kL = luma2(k);
+    float lL = luma2(l);
+    float nL = luma2(n);
+    float oL = luma2(o);
+
+    // Direction and length, bilinearly weighted over the 4 corners f g j k.
+    vec2  dir = vec2(0.0);
+    float len = 0.0;
+    easuSet(dir, len, (1.0 - pp.x) * (1.0 - pp.y), bL, eL, fL, gL, jL);
+    easuSet(dir, len, pp.x * (1.0 - pp.y), cL, fL, gL, hL, kL);
+    easuSet(dir, len, (1.0 - pp.x) * pp.y, fL, iL, jL, kL, nL);
+    easuSet(dir, len, pp.x * pp.y, gL, jL, kL, lL, oL);
+
+    // Normalize with approximation, and cleanup close to zero.
+    vec2  dir2 = dir * dir;
+    float dirR = dir2.x + dir2.y;
+    bool  zro  = dirR < 1.0 / 32768.0;
+    dirR  = zro ? 1.0 : inversesqrt(dirR);
+    dir.x = zro ? 1.0 : dir.x;
+    dir *= dirR;
+
+    // Transform from {0 to 2} to {0 to 1} range, and shape with square.
+    len = len * 0.5;
+    len *= len;
+
+    // Stretch kernel {1.0 vert|horz, to sqrt(2.0) on diagonal}.
+    float stretch = (dir.x * dir.x + dir.y * dir.y) / max(abs(dir.x), abs(dir.y));
+    // Anisotropic length after rotation,
+    //  x := 1.0 lerp to 'stretch' on edges
+    //  y := 1.0 lerp to 2x on edges
+    vec2 len2 = vec2(1.0 + (stretch - 1.0) * len, 1.0 - 0.5 * len);
+    // Based on the amount of 'edge', the window shifts from +/-{sqrt(2.0) to slightly beyond 2.0}.
+    float lob = 0.5 + ((1.0 / 4.0 - 0.04) - 0.5) * len;
+    // Set distance^2 clipping point to the end of the adjustable window.
+    float clp = 1.0 / lob;
+
+    // Min and max of the 4 nearest taps for deringing.
+    vec3 min4 = min(min(f, g), min(j, k));
+    vec3 max4 = max(max(f, g), max(j, k));
+
+    vec3  aC = vec3(0.0);
+    float aW = 0.0;
+    easuTap(aC, aW, vec2( 0.0, -1.0) - pp, dir, len2, lob, clp, b);
+    easuTap(aC, aW, vec2( 1.0, -1.0) - pp, dir, len2, lob, clp, c);
+    easuTap(aC, aW, vec2(-1.0,  1.0) - pp, dir, len2, lob, clp, i);
+    easuTap(aC, aW, vec2( 0.0,  1.0) - pp, dir, len2, lob, clp, j);
+    easuTap(aC, aW, vec2( 0.0,  0.0) - pp, dir, len2, lob, clp, f);
+    easuTap(aC, aW, vec2(-1.0,  0.0) - pp, dir, len2, lob, clp, e);
+    easuTap(aC, aW, vec2( 1.0,  1.0) - pp, dir, len2, lob, clp, k);
+    easuTap(aC, aW, vec2( 2.0,  1.0) - pp, dir, len2, lob, clp, l);
+    easuTap(aC, aW, vec2( 2.0,  0.0) - pp, dir, len2, lob, clp, h);
+    easuTap(aC, aW, vec2( 1.0,  0.0) - pp, dir, len2, lob, clp, g);
+    easuTap(aC, aW, vec2( 1.0,  2.0) - pp, dir, len2, lob, clp, o);
+    easuTap(aC, aW, vec2( 0.0,  2.0) - pp, dir, len2, lob, clp, n);
+
+    // Normalize and dering.
+    fragColor = vec4(min(max4, max(min4, aC / aW)), 1.0);
+}
@@ -0,0 +1,67 @@
+// LICENSE
+// =======
+// Copyright (c) 2021 Advanced Micro Devices, Inc. All rights reserved.
+// -------
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// -------
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+// -------
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE
+#version 450
+
+// Robust contrast adaptive sharpening from FidelityFX Super Resolution 1.0 (FsrRcasF in ffx_fsr1.h),
+// run on the output of fsr_easu at the swapchain resolution.
+
+layout(set=0, binding=0) uniform sampler2D img;
+
+// exp2(-stops), 1.0 is the strongest sharpening
+layout (constant_id = 0) const float sharpness = 0.87;
+
+layout(location = 0) in vec2 textureCoord;
+layout(location = 0) out vec4 fragColor;
+
+// Limits how much pixels can be sharpened, 0.25 would be the limit of the 5-tap filter
+#define FSR_RCAS_LIMIT (0.25 - (1.0 / 16.0))
+
+void main()
+{
+    ivec2 sp       = ivec2(gl_FragCoord.xy);
+    ivec2 maxCoord = textureSize(img, 0) - 1;
+
+    // Algorithm uses minimal 3x3 pixel neighborhood.
+    //    b
+    //  d e f
+    //    h
+    vec3 b  = texelFetch(img, clamp(sp + ivec2( 0, -1), ivec2(0), maxCoord), 0).rgb;
+    vec3 d  = texelFetch(img, clamp(sp + ivec2(-1,  0), ivec2(0), maxCoord), 0).rgb;
+    vec4 ee = texelFetch(img, sp, 0);
+    vec3 e  = ee.rgb;
+    vec3 f  = texelFetch(img, clamp(sp + ivec2( 1,  0), ivec2(0), maxCoord), 0).rgb;
+    vec3 h  = texelFetch(img, clamp(sp + ivec2( 0,  1), ivec2(0), maxCoord), 0).rgb;
+
+    // Min and max of ring.
+    vec3 mn4 = min(min(b, d), min(f, h));
+    vec3 mx4 = max(max(b, d), max(f, h));
+
+    // Immediate constants for peak range.
+    vec2 peakC = vec2(1.0, -1.0 * 4.0);
+
+    // Limiters, the denominators are kept away from zero for black and white rings.
+    vec3 hitMin = min(mn4, e) / max(4.0 * mx4, vec3(1.0 / 256.0));
+    vec3 hitMax = (peakC.x - max(mx4, e)) / min(4.0 * mn4 + peakC.y, vec3(-1.0 / 256.0));
+    vec3 lobeRGB = max(-hitMin, hitMax);
+    float lobe = max(-FSR_RCAS_LIMIT, min(max(max(lobeRGB.r, lobeRGB.g), lobeRGB.b), 0.0)) * sharpness;
+
+    // Resolve.
+    float rcpL = 1.0 / (4.0 * lobe + 1.0);
+    vec3  pix  = (lobe * b + lobe * d + lobe * h + lobe * f + e) * rcpL;
+
+    fragColor = vec4(pix, ee.a);
+}
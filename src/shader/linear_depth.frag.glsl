@@ -0,0 +1,29 @@
+#version 450
+
+// Same math as GetLinearizedDepth() in ReShade.fxh, done once per frame for every effect
+layout(constant_id = 0) const float farPlane    = 1000.0;
+layout(constant_id = 1) const float multiplier  = 1.0;
+layout(constant_id = 2) const bool  reversed    = true;
+layout(constant_id = 3) const bool  logarithmic = false;
+
+layout(set = 0, binding = 0) uniform sampler2D depthImage;
+
+layout(location = 0) in vec2 textureCoord;
+layout(location = 0) out float linearDepth;
+
+void main()
+{
+    float depth = texture(depthImage, textureCoord).x * multiplier;
+
+    if (logarithmic)
+    {
+        const float C = 0.01;
+        depth = (exp(depth * log(C + 1.0)) - 1.0) / C;
+    }
+
+    if (reversed)
+        depth = 1.0 - depth;
+
+    const float N = 1.0;
+    linearDepth = depth / (farPlane - depth * (farPlane - N));
+}
@@ -9,6 +9,10 @@ namespace vkBasalt
 #include "cas.frag.h"
     };
 
+    const std::vector<uint32_t> cas_fp16_frag = {
+#include "cas.frag.fp16.h"
+    };
+
     const std::vector<uint32_t> deband_frag = {
 #include "deband.frag.h"
     };
@@ -17,6 +21,18 @@ namespace vkBasalt
 #include "dls.frag.h"
     };
 
+    const std::vector<uint32_t> dls_fp16_frag = {
+#include "dls.frag.fp16.h"
+    };
+
+    const std::vector<uint32_t> fsr_easu_frag = {
+#include "fsr_easu.frag.h"
+    };
+
+    const std::vector<uint32_t> fsr_rcas_frag = {
+#include "fsr_rcas.frag.h"
+    };
+
     const std::vector<uint32_t> full_screen_triangle_vert = {
 #include "full_screen_triangle.vert.h"
     };
@@ -25,6 +41,10 @@ namespace vkBasalt
 #include "fxaa.frag.h"
     };
 
+    const std::vector<uint32_t> linear_depth_frag = {
+#include "linear_depth.frag.h"
+    };
+
     const std::vector<uint32_t> lut_frag = {
 #include "lut.frag.h"
     };
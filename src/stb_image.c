@@ -1,3 +1,5 @@
+// Textures are decoded on several threads, the failure strings include a static buffer that isn't thread safe
+#define STBI_NO_FAILURE_STRINGS
 #define STB_IMAGE_IMPLEMENTATION
 #define STB_IMAGE_DDS_IMPLEMENTATION
 #include "stb_image.h"
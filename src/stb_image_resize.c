@@ -1,4 +0,0 @@
-#define STB_IMAGE_RESIZE_IMPLEMENTATION
-#include "stb_image_resize.h"
-
-#undef STB_IMAGE_RESIZE_IMPLEMENTATION
@@ -3,10 +3,13 @@
     FORVKFUNC(DestroyInstance) \
     FORVKFUNC(EnumerateDeviceExtensionProperties) \
     FORVKFUNC(GetInstanceProcAddr) \
+    FORVKFUNC(GetPhysicalDeviceFeatures2) \
     FORVKFUNC(GetPhysicalDeviceFormatProperties) \
     FORVKFUNC(GetPhysicalDeviceMemoryProperties) \
+    FORVKFUNC(GetPhysicalDeviceMemoryProperties2) \
     FORVKFUNC(GetPhysicalDeviceQueueFamilyProperties) \
-    FORVKFUNC(GetPhysicalDeviceProperties)
+    FORVKFUNC(GetPhysicalDeviceProperties) \
+    FORVKFUNC(GetPhysicalDeviceSurfaceCapabilitiesKHR)
 
 #define VK_DEVICE_FUNCS \
     FORVKFUNC(AllocateCommandBuffers) \
@@ -23,13 +26,17 @@
     FORVKFUNC(CmdBlitImage) \
     FORVKFUNC(CmdCopyBufferToImage) \
     FORVKFUNC(CmdCopyImage) \
+    FORVKFUNC(CmdCopyImageToBuffer) \
     FORVKFUNC(CmdDraw) \
     FORVKFUNC(CmdDrawIndexed) \
     FORVKFUNC(CmdEndRenderPass) \
     FORVKFUNC(CmdPipelineBarrier) \
     FORVKFUNC(CmdPushConstants) \
+    FORVKFUNC(CmdPushDescriptorSetKHR) \
+    FORVKFUNC(CmdResetQueryPool) \
     FORVKFUNC(CmdSetScissor) \
     FORVKFUNC(CmdSetViewport) \
+    FORVKFUNC(CmdWriteTimestamp) \
     FORVKFUNC(CreateBuffer) \
     FORVKFUNC(CreateCommandPool) \
     FORVKFUNC(CreateDescriptorPool) \
@@ -40,6 +47,7 @@
     FORVKFUNC(CreateImage) \
     FORVKFUNC(CreateImageView) \
     FORVKFUNC(CreatePipelineLayout) \
+    FORVKFUNC(CreateQueryPool) \
     FORVKFUNC(CreateRenderPass) \
     FORVKFUNC(CreateSampler) \
     FORVKFUNC(CreateSemaphore) \
@@ -56,6 +64,7 @@
     FORVKFUNC(DestroyImageView) \
     FORVKFUNC(DestroyPipeline) \
     FORVKFUNC(DestroyPipelineLayout) \
+    FORVKFUNC(DestroyQueryPool) \
     FORVKFUNC(DestroyRenderPass) \
     FORVKFUNC(DestroySampler) \
     FORVKFUNC(DestroySemaphore) \
@@ -71,6 +80,8 @@
     FORVKFUNC(GetDeviceQueue) \
     FORVKFUNC(GetDeviceQueue2) \
     FORVKFUNC(GetImageMemoryRequirements) \
+    FORVKFUNC(GetQueryPoolResults) \
+    FORVKFUNC(GetSemaphoreCounterValueKHR) \
     FORVKFUNC(GetSwapchainImagesKHR) \
     FORVKFUNC(MapMemory) \
     FORVKFUNC(QueuePresentKHR) \
@@ -80,4 +91,6 @@
     FORVKFUNC(ResetFences) \
     FORVKFUNC(UnmapMemory) \
     FORVKFUNC(UpdateDescriptorSets) \
-    FORVKFUNC(WaitForFences)
+    FORVKFUNC(WaitForFences) \
+    FORVKFUNC(WaitForPresentKHR) \
+    FORVKFUNC(WaitSemaphoresKHR)